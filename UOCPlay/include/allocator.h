@@ -0,0 +1,38 @@
+#ifndef __ALLOCATOR_H__
+#define __ALLOCATOR_H__
+#include <stddef.h>
+
+// Functions giving memory to the library, called with the allocator context.
+// Realloc and free only get memory returned by the same allocator, and never NULL.
+// The functions must be thread-safe: the library calls them from several threads at the same time
+// (parallel load workers, formatting tasks of the thread pool, the async loading thread)
+typedef struct _tAllocator {
+    void* (*alloc)(void* context, size_t size);
+    void* (*realloc)(void* context, void* ptr, size_t size);
+    void (*free)(void* context, void* ptr);
+    void* context;
+} tAllocator;
+
+//////////////////////////////////
+// Available methods
+//////////////////////////////////
+
+// Get size bytes of memory from the allocator, or from malloc if it is NULL. NULL if there is no memory available
+void* allocator_alloc(const tAllocator* allocator, size_t size);
+
+// Get memory for count elements of the given size, set to zero. NULL if there is no memory available
+void* allocator_calloc(const tAllocator* allocator, size_t count, size_t size);
+
+// Resize memory of the allocator, keeping its content. A NULL ptr gets new memory.
+// NULL if there is no memory available, and then ptr is not changed
+void* allocator_realloc(const tAllocator* allocator, void* ptr, size_t size);
+
+// Copy a string into memory of the allocator. NULL if there is no memory available
+char* allocator_strdup(const tAllocator* allocator, const char* str);
+
+// Give back memory of the allocator. A NULL ptr is ignored
+void allocator_free(const tAllocator* allocator, void* ptr);
+
+////////////////////////////////////////////
+
+#endif // __ALLOCATOR_H__
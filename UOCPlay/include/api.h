@@ -2,6 +2,7 @@
 #define __UOCPLAY_API__H
 #include <stdbool.h>
 #include "error.h"
+#include "allocator.h"
 #include "csv.h"
 #include "person.h"
 #include "subscription.h"
@@ -9,21 +10,116 @@
 
 #define FILE_READ_BUFFER_SIZE 2048
 
+// Minimum number of films formatted by each task of the thread pool
+#define API_FORMAT_GRAIN 256
+
+// Thread pool of threadpool.h, only used through pointers here so the API does not need C11 threads
+typedef struct _tThreadPool tThreadPool;
+
+// Load running in the background, created by api_loadDataAsync
+typedef struct _tApiLoadTask tApiLoadTask;
+
 // 3a - Type that stores all the application data
 typedef struct _ApiData {
     tPeople people;
     tSubscriptions subscriptions;
     tCatalog catalog;
+    // Threads used by the API functions, NULL to run them on the calling thread. Not owned by the data
+    tThreadPool *pool;
+    // Allocator of all the data memory, NULL for the C heap. Not owned by the data
+    const tAllocator *allocator;
 } tApiData;
 
+// Row rejected while loading data
+typedef struct _tApiLoadError {
+    int row;
+    tApiError error;
+} tApiLoadError;
+
+// Rows rejected while loading data, in row order
+typedef struct _tApiLoadReport {
+    tApiLoadError *errors;
+    int count;
+    // Allocator of the errors, NULL for the C heap
+    const tAllocator *allocator;
+} tApiLoadReport;
+
+// Progress of a load running in the background
+typedef struct _tApiLoadProgress {
+    // Bytes of the rows already applied or rejected
+    long long bytesRead;
+    // Size of the file, -1 if it is not known
+    long long totalBytes;
+    int rowsApplied;
+    int rowsRejected;
+    // Estimated seconds left, -1 while unknown
+    double eta;
+} tApiLoadProgress;
+
+// Function called by the loading thread when a load ends, with its result
+typedef void (*tApiLoadCallback)(tApiLoadTask *task, tApiError error, void *context);
+
 // Get the API version information
 const char *api_version();
 
 // Load data from a CSV file. If reset is true, remove previous data
 tApiError api_loadData(tApiData *data, const char *filename, bool reset);
 
-// Initialize the data structure
-tApiError api_initData(tApiData *data);
+// Load data from the CSV lines of a file descriptor, such as a pipe, until its end. A thread reads ahead
+// while the previous block is parsed. The descriptor stays open. If reset is true, remove previous data
+tApiError api_loadStream(tApiData *data, int fd, bool reset);
+
+// Load data from a CSV file with many threads: people first, then subscriptions and films at the same time.
+// The rows are split among threads workers, run by the thread pool of the data or by a pool started for the load.
+// The data and the rejected rows are the same as adding the rows one by one. Report can be NULL
+tApiError api_loadDataParallel(tApiData *data, const char *filename, bool reset, int threads, tApiLoadReport *report);
+
+// Start loading data from a CSV file in the background, into a new data that starts as a copy of base,
+// with its allocator, or empty on the C heap if base is NULL. The task and the tApiData itself also come from that allocator,
+// so the data taken from the task is released with api_freeData and then allocator_free(data->allocator, data).
+// Base is not changed, so it can still be used while the load runs; its allocator is then called from the loading
+// thread and the caller at the same time.
+// The callback, if any, is called from the loading thread when the load ends. It may take the data with
+// apiLoadTask_takeData. On success, task gets the new task, removed with apiLoadTask_free
+tApiError api_loadDataAsync(tApiLoadTask **task, const tApiData *base, const char *filename,
+                            tApiLoadCallback callback, void *context);
+
+// Get the bytes read, rows applied and rejected and estimated time left of a load
+void apiLoadTask_progress(tApiLoadTask *task, tApiLoadProgress *progress);
+
+// Ask a load to stop. It ends with E_LOAD_CANCELLED after the rows being parsed
+void apiLoadTask_cancel(tApiLoadTask *task);
+
+// Check if a load has ended, callback included
+bool apiLoadTask_done(tApiLoadTask *task);
+
+// Wait for a load to end. On success, data gets the loaded data, owned by the caller, unless the callback took it.
+// Otherwise the loaded data is removed. Data can be NULL to discard it. It is called at most once, not from the callback
+tApiError apiLoadTask_wait(tApiLoadTask *task, tApiData **data);
+
+// Take the data loaded by a task, owned by the caller from then on. Called from the callback, it keeps
+// apiLoadTask_wait from returning or removing it
+tApiData *apiLoadTask_takeData(tApiLoadTask *task);
+
+// Remove a task, waiting for its load to end and discarding its data if it was not waited for
+void apiLoadTask_free(tApiLoadTask *task);
+
+// Initialize a load report whose errors are allocated with the allocator, or with malloc if it is NULL
+void apiLoadReport_init(tApiLoadReport *report, const tAllocator *allocator);
+
+// Remove the data from a load report
+void apiLoadReport_free(tApiLoadReport *report);
+
+// Initialize the data structure. All its memory is allocated with the allocator, or with malloc if it is NULL.
+// The allocator must outlive the data, and be thread-safe if the data is used with threads
+// (api_loadDataParallel, api_loadDataAsync or a thread pool), as those call it from many threads at once
+tApiError api_initData(tApiData *data, const tAllocator *allocator);
+
+// Run the API functions on the data with the threads of the pool, or on the calling thread if it is NULL
+void api_setThreadPool(tApiData *data, tThreadPool *pool);
+
+// Copy the data from the source to an uninitialized destination, which uses the same thread pool and allocator
+tApiError api_cpyData(tApiData *destination, tApiData source);
 
 // Add a person into the data if it does not exist
 tApiError api_addPerson(tApiData *data, tCSVEntry entry);
@@ -46,6 +142,9 @@ int api_filmsCount(tApiData data);
 // Get the number of free films registered on the application
 int api_freeFilmsCount(tApiData data);
 
+// Get the number of films of the given genre
+int api_genreFilmsCount(tApiData data, int genre);
+
 // Free all used memory
 tApiError api_freeData(tApiData *data);
 
@@ -58,12 +157,69 @@ tApiError api_getSubscription(tApiData data, int id, tCSVEntry *entry);
 // Get film data
 tApiError api_getFilm(tApiData data, const char *name, tCSVEntry *entry);
 
+// Write the subscription record into a caller buffer of the given size, without allocating memory.
+// Needed is set to the bytes required, including the terminator. E_BUFFER_TOO_SMALL if they do not fit
+tApiError api_getSubscriptionRecord(tApiData data, int id, char *buffer, int size, int *needed);
+
+// Write the film record into a caller buffer of the given size, without allocating memory.
+// Needed is set to the bytes required, including the terminator. E_BUFFER_TOO_SMALL if they do not fit
+tApiError api_getFilmRecord(tApiData data, const char *name, char *buffer, int size, int *needed);
+
+// Fill a caller-owned fixed capacity entry with the subscription data, without allocating memory
+tApiError api_getSubscriptionFixedEntry(tApiData data, int id, tCSVFixedEntry *entry);
+
+// Fill a caller-owned fixed capacity entry with the film data, without allocating memory
+tApiError api_getFilmFixedEntry(tApiData data, const char *name, tCSVFixedEntry *entry);
+
 // Get free films data
 tApiError api_getFreeFilms(tApiData data, tCSVData *freeFilms);
 
 // Get films data by genre
 tApiError api_getFilmsByGenre(tApiData data, tCSVData *films, int genre);
 
+// Get up to max free films as pointers into the catalog, valid until it is modified.
+// Return the number of films stored in films
+int api_getFreeFilmsView(tApiData data, const tFilm **films, int max);
+
+// Get up to max films of a genre as pointers into the catalog, valid until it is modified.
+// Return the number of films stored in films
+int api_getFilmsByGenreView(tApiData data, int genre, const tFilm **films, int max);
+
+// Get the next page of up to pageSize free films, resuming after the cursor and moving it to the last returned film.
+// An empty page means the list is over. E_CURSOR_EXPIRED if films were added or removed since the cursor was returned
+tApiError api_getFreeFilmsPage(tApiData data, tFilmListCursor *cursor, int pageSize, tCSVData *films);
+
+// Get the next page of up to pageSize films of a genre, resuming after the cursor and moving it to the last returned film.
+// An empty page means the list is over. E_CURSOR_EXPIRED if films were added or removed since the cursor was returned
+tApiError api_getFilmsByGenrePage(tApiData data, int genre, tFilmListCursor *cursor, int pageSize, tCSVData *films);
+
+// Get the k best rated films of a genre (or FILM_GENRE_ANY), optionally only the free ones
+tApiError api_getTopRatedFilms(tApiData data, int k, int genre, bool freeOnly, tCSVData *films);
+
+// Get the number of films released between from and to, both included
+int api_releasedFilmsCount(tApiData data, tDate from, tDate to);
+
+// Get the next page of films released between from and to, both included, sorted by release date
+tApiError api_getFilmsByRelease(tApiData data, tDate from, tDate to, tReleaseCursor *cursor, int pageSize, tCSVData *films);
+
+// Get the films whose name contains the fragment, ignoring case, punctuation and extra spaces
+tApiError api_searchFilms(tApiData data, const char *fragment, tCSVData *films);
+
+// Get up to limit films whose name is at most maxDistance typos away from the query, closest and best rated first
+tApiError api_fuzzySearchFilms(tApiData data, const char *query, int maxDistance, int limit, tCSVData *films);
+
+// Get up to limit (at most TRIE_TOP_K) best rated films whose name starts with the prefix
+tApiError api_autocompleteFilms(tApiData data, const char *prefix, int limit, tCSVData *films);
+
+// Get the films whose handles are in the bitmap, ordered by handle
+tApiError api_getBitmapFilms(tApiData data, const tBitmap *bitmap, tCSVData *films);
+
+// Get the next page of films of a query, starting after the cursor and moving it to the last returned film
+tApiError api_queryFilms(tApiData data, const tFilmQuery *query, tFilmQueryCursor *cursor, tCSVData *films);
+
+// Get the number of films, average rating and total duration by genre, by release decade and by isFree
+tApiError api_getFilmStats(tApiData data, tFilmStats *stats);
+
 // Format the date into dd/mm/yyyy and store it in buffer
 void date_format(tDate date, char *buffer);
 
@@ -0,0 +1,76 @@
+#ifndef __BITMAP_H__
+#define __BITMAP_H__
+#include <stdbool.h>
+#include "allocator.h"
+#include "error.h"
+
+// Number of values of each container, all sharing the 16 high bits
+#define BITMAP_CONTAINER_VALUES 65536
+
+// Maximum number of values of a container stored as a sorted array
+#define BITMAP_ARRAY_MAX 4096
+
+// Number of words of a container stored as bits
+#define BITMAP_CONTAINER_WORDS (BITMAP_CONTAINER_VALUES / 32)
+
+// Values of a bitmap sharing the 16 high bits. Sparse containers store the low bits in a sorted array,
+// dense ones (more than BITMAP_ARRAY_MAX values) store BITMAP_CONTAINER_WORDS words of bits
+typedef struct _tBitmapContainer {
+    int key;
+    int count;
+    // Sorted low bits, NULL for dense containers
+    unsigned short *values;
+    int capacity;
+    // Bits of the values, NULL for sparse containers
+    unsigned int *bits;
+} tBitmapContainer;
+
+// Compressed set of non-negative integers, with containers sorted by key
+typedef struct _tBitmap {
+    tBitmapContainer *containers;
+    int count;
+    int capacity;
+    // Allocator of the containers and of their values, NULL for the C heap
+    const tAllocator *allocator;
+} tBitmap;
+
+//////////////////////////////////
+// Available methods
+//////////////////////////////////
+
+// Initialize an empty bitmap whose memory comes from the allocator, or from the C heap if it is NULL
+void bitmap_init(tBitmap* bitmap, const tAllocator* allocator);
+
+// Add a value to the bitmap
+tApiError bitmap_add(tBitmap* bitmap, int value);
+
+// Remove a value from the bitmap, if it is there
+void bitmap_del(tBitmap* bitmap, int value);
+
+// Check if the bitmap contains a value
+bool bitmap_contains(const tBitmap* bitmap, int value);
+
+// Return the number of values of the bitmap
+int bitmap_count(const tBitmap* bitmap);
+
+// Store in result the values in a and in b. Result must be initialized and is overwritten, keeping its allocator
+tApiError bitmap_and(const tBitmap* a, const tBitmap* b, tBitmap* result);
+
+// Store in result the values in a or in b. Result must be initialized and is overwritten
+tApiError bitmap_or(const tBitmap* a, const tBitmap* b, tBitmap* result);
+
+// Store in result the values in a and not in b. Result must be initialized and is overwritten
+tApiError bitmap_andNot(const tBitmap* a, const tBitmap* b, tBitmap* result);
+
+// Copy the bitmap src to dst. Dst must be initialized and is overwritten
+tApiError bitmap_cpy(tBitmap* dst, const tBitmap* src);
+
+// Get up to max values not lower than from, sorted. Return the number of values stored in result
+int bitmap_values(const tBitmap* bitmap, int from, int max, int* result);
+
+// Remove the data from a bitmap
+void bitmap_free(tBitmap* bitmap);
+
+////////////////////////////////////////////
+
+#endif // __BITMAP_H__
@@ -2,6 +2,7 @@
 #define __CSV_H__
 
 #include <stdbool.h>
+#include "allocator.h"
 #define CSV_SEPARATOR_CHAR ;
 
 // Store one entry from a CSV file
@@ -9,13 +10,35 @@ typedef struct _tCSVEntry {
     int numFields;
     char* type;
     char** fields;    
+    // Allocator of the type and the fields, NULL for the C heap
+    const tAllocator* allocator;
 } tCSVEntry;
 
+// Maximum number of fields of a fixed capacity entry
+#define CSV_FIXED_ENTRY_FIELDS 8
+
+// Maximum length of the type of a fixed capacity entry, including the terminator
+#define CSV_FIXED_ENTRY_TYPE 16
+
+// Capacity in bytes of the line of a fixed capacity entry, including the terminator
+#define CSV_FIXED_ENTRY_SIZE 512
+
+// Store one entry in caller-owned memory. The fields of the entry view point into its own line,
+// so it must not be copied by value once parsed
+typedef struct _tCSVFixedEntry {
+    tCSVEntry entry;
+    char type[CSV_FIXED_ENTRY_TYPE];
+    char* fields[CSV_FIXED_ENTRY_FIELDS];
+    char line[CSV_FIXED_ENTRY_SIZE];
+} tCSVFixedEntry;
+
 // Store the content of a CSV file
 typedef struct _tCSVData {
     tCSVEntry *entries;
     int count;
     bool isValid;
+    // Allocator of the entries, NULL for the C heap
+    const tAllocator* allocator;
 } tCSVData;
 
 // Initialize the tCSVData structure
@@ -24,6 +47,12 @@ void csv_init(tCSVData* data);
 // Initialize the tCSVEntry structure
 void csv_initEntry(tCSVEntry* entry);
 
+// Initialize the tCSVData structure, whose entries are allocated with the allocator, or with malloc if it is NULL
+void csv_initWithAllocator(tCSVData* data, const tAllocator* allocator);
+
+// Initialize the tCSVEntry structure, whose fields are allocated with the allocator, or with malloc if it is NULL
+void csv_initEntryWithAllocator(tCSVEntry* entry, const tAllocator* allocator);
+
 // Parse the contents of a CSV file
 void csv_parse(tCSVData* data, const char* input, const char* type);
 
@@ -39,13 +68,20 @@ void csv_printEntry(tCSVEntry entry);
 // Parse the contents of a CSV line   "f1;f2;f3" =>  field_0 = f1, field_1 = f2, field_2 = f3
 void csv_parseEntry(tCSVEntry* entry, const char* input, const char* type);
 
+// Initialize a fixed capacity entry
+void csv_initFixedEntry(tCSVFixedEntry* entry);
+
+// Split in place the line stored in a fixed capacity entry, without allocating memory.
+// Return false if the line has more than CSV_FIXED_ENTRY_FIELDS fields
+bool csv_parseFixedEntry(tCSVFixedEntry* entry, const char* type);
+
 // Get the number of entries
 bool csv_isValid(tCSVData data);
 
-// Remove all data from structure
+// Remove all data from structure. It keeps its allocator
 void csv_free(tCSVData* data);
 
-// Remove all data from structure
+// Remove all data from structure. It keeps its allocator
 void csv_freeEntry(tCSVEntry* entry);
 
 // Get the number of entries
@@ -35,6 +35,12 @@ void date_cpy(tDate *dst, tDate src);
 // Compare two dates
 int date_cmp(tDate date1, tDate date2);
 
+// Return the number of days from 01/01/1970 to the date (negative for older dates)
+int date_toDays(tDate date);
+
+// Store in date the day that is the given number of days from 01/01/1970
+void date_fromDays(tDate *date, int days);
+
 // Parse a tDateTime from string information
 void dateTime_parse(tDateTime* dateTime, const char* date, const char* time);
 
@@ -16,6 +16,10 @@ enum _tApiError
 	E_PERSON_NOT_FOUND = 9, // Person not found
 	E_SUBSCRIPTION_DUPLICATED = 10, // Subscription duplicated
 	E_SUBSCRIPTION_NOT_FOUND = 11, // Subscription not found
+	E_BUFFER_TOO_SMALL = 12, // Provided buffer is too small
+	E_CURSOR_EXPIRED = 13, // Cursor belongs to an older version of the data
+	E_FILE_READ_ERROR = 14, // File could not be read
+	E_LOAD_CANCELLED = 15, // Load cancelled before its end
 };
 
 // Define an error type
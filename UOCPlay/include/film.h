@@ -1,15 +1,41 @@
 #ifndef __FILM_H__
 #define __FILM_H__
 #include <stdbool.h>
+#include "allocator.h"
 #include "csv.h"
 #include "date.h"
 #include "error.h"
+#include "pool.h"
+#include "search.h"
+#include "bitmap.h"
 
 #define RATING_MIN 0.0
 #define RATING_MAX 5.0
 
 #define NUM_FIELDS_FILM 6
 
+// Used in genre filters to select films of any genre
+#define FILM_GENRE_ANY (-1)
+
+// Handle of a position not used by any film
+#define FILM_HANDLE_NONE (-1)
+
+// Minimum number of holes in the catalog store before compacting it
+#define STORE_MIN_HOLES 64
+
+// Number of films in each word of the column bitmaps
+#define FILM_COLUMN_BITS 32
+
+// Used in filters to select both free and paid films
+#define FILM_FREE_ANY (-1)
+
+// Maximum number of entries in each block of the rating and release date indexes
+#define FILM_INDEX_BLOCK_SIZE 256
+
+// Number of rating ranges with their own bitmap, each one of FILM_RATING_BUCKET_SIZE points
+#define FILM_RATING_BUCKETS 10
+#define FILM_RATING_BUCKET_SIZE 0.5f
+
 typedef enum {
 	GENRE_FIRST = 0,
 	
@@ -31,54 +57,266 @@ typedef struct _tFilm {
 	bool isFree;
 } tFilm;
 
+// Stable identifier of a film inside the catalog
+typedef int tFilmHandle;
+
 typedef struct _tFilmListNode {
 	tFilm elem;
 	struct _tFilmListNode *next;
+	struct _tFilmListNode *prev;
+	// Node of the film in the free films list, NULL if the film is not free
+	struct _tFreeFilmListNode *freeNode;
+	// Handle of the film in the catalog store, FILM_HANDLE_NONE for holes
+	tFilmHandle handle;
+	// Links of the genre index
+	tFilmHandle genrePrev;
+	tFilmHandle genreNext;
 } tFilmListNode;
 
 typedef struct _tFilmList {
 	tFilmListNode *first;
 	tFilmListNode *last;
 	int count;
+	// Allocator of the nodes and of the film names, NULL for the C heap
+	const tAllocator *allocator;
 } tFilmList;
 
 typedef struct _tFreeFilmListNode {
 	tFilm *elem;
 	struct _tFreeFilmListNode *next;
+	struct _tFreeFilmListNode *prev;
+	// Handle of the film in the catalog store
+	tFilmHandle handle;
 } tFreeFilmListNode;
 
 typedef struct _tFreeFilmList {
 	tFreeFilmListNode *first;
 	tFreeFilmListNode *last;
 	int count;
+	// Allocator of the nodes, NULL for the C heap
+	const tAllocator *allocator;
 } tFreeFilmList;
 
+// Films of a genre, linked through the genre links of the store nodes
+typedef struct _tGenreFilmList {
+	tFilmHandle first;
+	tFilmHandle last;
+	int count;
+} tGenreFilmList;
+
+typedef struct _tFilmIndexEntry {
+	int key;
+	tFilmHandle handle;
+} tFilmIndexEntry;
+
+// Consecutive entries of a film index, never empty
+typedef struct _tFilmIndexBlock {
+	int count;
+	tFilmIndexEntry elems[FILM_INDEX_BLOCK_SIZE];
+} tFilmIndexBlock;
+
+// Film handles sorted by key, and by handle for the same key. The entries are split in blocks
+// of at most FILM_INDEX_BLOCK_SIZE, so adding or removing a film only moves the entries of one block
+typedef struct _tFilmIndex {
+	tFilmIndexBlock **blocks;
+	int blockCount;
+	int blockCapacity;
+	// Entries of all the blocks
+	int count;
+	const tAllocator *allocator;
+} tFilmIndex;
+
+// Position of an entry in a film index. Past the end when block is the number of blocks
+typedef struct _tFilmIndexPos {
+	int block;
+	int offset;
+} tFilmIndexPos;
+
+// Film handles sorted by descending rating, and by handle for the same rating
+typedef tFilmIndex tRatingIndex;
+
+// Film handles sorted by release date, and by handle for the same date
+typedef tFilmIndex tReleaseIndex;
+
+// Position in a release date range, to get the results one page at a time
+typedef struct _tReleaseCursor {
+	int day;
+	tFilmHandle handle;
+} tReleaseCursor;
+
+typedef struct _tFilmNameIndexEntry {
+	unsigned int hash;
+	tFilmHandle handle;
+} tFilmNameIndexEntry;
+
+// Hash table from film names to handles, with linear probing
+typedef struct _tFilmNameIndex {
+	tFilmNameIndexEntry *elems;
+	int capacity;
+	int count;
+} tFilmNameIndex;
+
+// Contiguous storage of the catalog films
+typedef struct _tFilmStore {
+	// Film nodes, with holes left by removed films
+	tFilmListNode *slots;
+	int capacity;
+	int used;
+	// Positions of the holes, reused by the next films
+	int *holes;
+	int holeCount;
+	// Handle table with the slot of each handle, -1 if the handle is not in use
+	int *slotOf;
+	int handleCount;
+	// Handles released by removed films
+	tFilmHandle *freeHandles;
+	int freeHandleCount;
+	const tAllocator *allocator;
+} tFilmStore;
+
+// Copy of the filtered fields of the films in parallel arrays indexed by handle, kept in sync with the store
+// on add and del so filters sweep them instead of the nodes. Names stay in the catalog arena
+typedef struct _tFilmColumns {
+	unsigned char *genre;
+	float *rating;
+	// Release dates as days since 01/01/1970
+	int *release;
+	// Durations in minutes
+	int *duration;
+	// Bitmaps of the free films and of the handles in use
+	unsigned int *isFree;
+	unsigned int *live;
+	int capacity;
+} tFilmColumns;
+
+// Conditions on the filtered fields of the films. Ranges include both ends
+typedef struct _tFilmFilter {
+	// Bit (1 << genre) set for each accepted genre
+	unsigned int genres;
+	float minRating;
+	float maxRating;
+	// Days since 01/01/1970
+	int minRelease;
+	int maxRelease;
+	// Minutes
+	int minDuration;
+	int maxDuration;
+	// FILM_FREE_ANY, false or true
+	int isFree;
+} tFilmFilter;
+
+// Order of the films returned by a query
+typedef enum {
+	FILM_ORDER_HANDLE,	// Catalog handle order
+	FILM_ORDER_RATING,	// Best rated first
+	FILM_ORDER_RELEASE	// Oldest first
+} tFilmOrder;
+
+// Conditions, order and page size of a film query
+typedef struct _tFilmQuery {
+	tFilmFilter filter;
+	// Start of the name, ignoring case and punctuation. NULL for any name
+	const char *namePrefix;
+	tFilmOrder order;
+	// Maximum number of films of each page
+	int limit;
+} tFilmQuery;
+
+// Last film returned by a query, where the next page starts
+typedef struct _tFilmQueryCursor {
+	float rating;
+	int day;
+	tFilmHandle handle;
+} tFilmQueryCursor;
+
+// Opaque position of a paged film list: the last returned film and the version of the catalog it belongs to
+typedef struct _tFilmListCursor {
+	tFilmHandle handle;
+	unsigned long long version;
+} tFilmListCursor;
+
+// Aggregated values of a group of films
+typedef struct _tFilmGroup {
+	// Genre, first year of the decade or isFree, depending on the grouping
+	int key;
+	int count;
+	float averageRating;
+	// Minutes
+	int totalDuration;
+} tFilmGroup;
+
+// Films grouped by genre, by release decade and by isFree
+typedef struct _tFilmStats {
+	tFilmGroup genre[GENRE_END];
+	tFilmGroup isFree[2];
+	// One group for each decade from the oldest release to the newest one, empty decades included
+	tFilmGroup *decade;
+	int decadeCount;
+	// Allocator of the decades, the one of the catalog
+	const tAllocator *allocator;
+} tFilmStats;
+
 typedef struct _tFilmCatalog {
 	tFilmList filmList;
 	tFreeFilmList freeFilmList;
+	// Films of each genre, in catalog order
+	tGenreFilmList genreFilmList[GENRE_END];
+	// Films sorted by rating, split by genre and isFree
+	tRatingIndex ratingIndex[GENRE_END][2];
+	// Films sorted by release date
+	tReleaseIndex releaseIndex;
+	// Handles of the films by name
+	tFilmNameIndex nameIndex;
+	// Handles of the films by trigrams of their normalized name
+	tTrigramIndex trigramIndex;
+	// Handles of the films by prefixes of their normalized name, best rated first
+	tTrie completions;
+	// Memory of the film nodes, free-film nodes and film names, owned by the catalog
+	tFilmStore store;
+	tFilmColumns columns;
+	// Bitmaps of the film handles: all of them, by genre, the free ones and by rating range
+	tBitmap filmsBitmap;
+	tBitmap genreBitmap[GENRE_END];
+	tBitmap freeBitmap;
+	tBitmap ratingBitmap[FILM_RATING_BUCKETS];
+	tPool freeFilmNodePool;
+	tStringArena names;
+	// Memory of the rating and release indexes, posting lists, trie and bitmaps. Only changed by catalog updates,
+	// and released at once with the catalog
+	tBlockArena indexes;
+	// Changes on every film added or removed, so handles in older cursors can not be trusted. Taken from a
+	// counter shared by all the catalogs, so no other catalog, copy or reload ever has the same version
+	unsigned long long version;
+	// Allocator of all the catalog memory, NULL for the C heap. Not owned by the catalog
+	const tAllocator *allocator;
 } tCatalog;
 
 //////////////////////////////////
 // Available methods
 //////////////////////////////////
 
-// Parse input from CSVEntry
-void film_parse(tFilm* data, tCSVEntry entry);
+// Parse input from CSVEntry. The name is copied with the allocator, or with malloc if it is NULL
+void film_parse(tFilm* data, tCSVEntry entry, const tAllocator* allocator);
 
-// Initialize a film
-void film_init(tFilm* data, const char* name, tTime duration, tFilmGenre genre, tDate release, float rating, bool isFree);
+// Initialize a film. The name is copied with the allocator, or with malloc if it is NULL
+void film_init(tFilm* data, const char* name, tTime duration, tFilmGenre genre, tDate release, float rating, bool isFree,
+               const tAllocator* allocator);
 
-// Copy a film from src to dst
-void film_cpy(tFilm* dst, tFilm src);
+// Copy a film from src to dst, copying the name with the allocator
+void film_cpy(tFilm* dst, tFilm src, const tAllocator* allocator);
 
 // Get film data using a string
 void film_get(tFilm data, char* buffer);
 
-// Remove the data from a film
-void film_free(tFilm* data);
+// Write the film record into a buffer of the given size, truncating it if it does not fit.
+// Return the number of bytes needed, including the terminator
+int film_format(tFilm data, char* buffer, int size);
+
+// Remove the data from a film, initialized with the same allocator
+void film_free(tFilm* data, const tAllocator* allocator);
 
-// Initialize the films list
-tApiError filmList_init(tFilmList* list);
+// Initialize the films list, whose memory comes from the allocator or from the C heap if it is NULL
+tApiError filmList_init(tFilmList* list, const tAllocator* allocator);
 
 // Add a new film to the list
 tApiError filmList_add(tFilmList* list, tFilm film);
@@ -92,8 +330,8 @@ tFilm* filmList_find(tFilmList list, const char* name);
 // Remove the films from the list
 tApiError filmList_free(tFilmList* list);
 
-// Initialize the free films list
-tApiError freeFilmList_init(tFreeFilmList* list);
+// Initialize the free films list, whose nodes come from the allocator or from the C heap if it is NULL
+tApiError freeFilmList_init(tFreeFilmList* list, const tAllocator* allocator);
 
 // Add a new free film to the list
 tApiError freeFilmList_add(tFreeFilmList* list, tFilm* film);
@@ -107,8 +345,45 @@ tFilm* freeFilmList_find(tFreeFilmList list, const char* name);
 // Remove the free films from the list
 tApiError freeFilmsList_free(tFreeFilmList* list);
 
-// Initialize the films catalog
-tApiError catalog_init(tCatalog* catalog);
+// Initialize a genre films list
+tApiError genreFilmList_init(tGenreFilmList* list);
+
+// Initialize a rating index whose memory comes from the allocator, or from the C heap if it is NULL
+tApiError ratingIndex_init(tRatingIndex* index, const tAllocator* allocator);
+
+// Add a film to the rating index
+tApiError ratingIndex_add(tRatingIndex* index, float rating, tFilmHandle handle);
+
+// Remove a film from the rating index
+tApiError ratingIndex_del(tRatingIndex* index, float rating, tFilmHandle handle);
+
+// Remove all the references from the rating index
+tApiError ratingIndex_free(tRatingIndex* index);
+
+// Initialize a release date index whose memory comes from the allocator, or from the C heap if it is NULL
+tApiError releaseIndex_init(tReleaseIndex* index, const tAllocator* allocator);
+
+// Add a film to the release date index
+tApiError releaseIndex_add(tReleaseIndex* index, tDate release, tFilmHandle handle);
+
+// Remove a film from the release date index
+tApiError releaseIndex_del(tReleaseIndex* index, tDate release, tFilmHandle handle);
+
+// Remove all the references from the release date index
+tApiError releaseIndex_free(tReleaseIndex* index);
+
+// Initialize a cursor to the start of a release date range
+void releaseCursor_init(tReleaseCursor* cursor);
+
+// Initialize the film store whose memory comes from the allocator, or from the C heap if it is NULL
+tApiError filmStore_init(tFilmStore* store, const tAllocator* allocator);
+
+// Remove all the films of the store
+tApiError filmStore_free(tFilmStore* store);
+
+// Initialize the films catalog. All its memory comes from the allocator, which must outlive the catalog.
+// If it is NULL, the C heap is used and big blocks are mapped from the system
+tApiError catalog_init(tCatalog* catalog, const tAllocator* allocator);
 
 // Add a new film to the catalog
 tApiError catalog_add(tCatalog* catalog, tFilm film);
@@ -122,6 +397,105 @@ int catalog_len(tCatalog catalog);
 // Return the number of free films
 int catalog_freeLen(tCatalog catalog);
 
+// Return the number of films of the given genre
+int catalog_genreLen(tCatalog catalog, tFilmGenre genre);
+
+// Return the handle of the film with the given name. FILM_HANDLE_NONE if it does not exist
+tFilmHandle catalog_find(const tCatalog* catalog, const char* name);
+
+// Return a pointer to the film with the given handle, valid until the catalog is modified. NULL if it does not exist
+tFilm* catalog_film(const tCatalog* catalog, tFilmHandle handle);
+
+// Get up to max free films in catalog order, as pointers valid until the catalog is modified.
+// Return the number of films stored in result
+int catalog_freeFilmsView(const tCatalog* catalog, int max, const tFilm** result);
+
+// Get up to max films of a genre in catalog order, as pointers valid until the catalog is modified.
+// Return the number of films stored in result
+int catalog_genreFilmsView(const tCatalog* catalog, tFilmGenre genre, int max, const tFilm** result);
+
+// Initialize a cursor to the start of a film list
+void filmListCursor_init(tFilmListCursor* cursor);
+
+// Get up to max free films after the cursor, moving it to the last returned film. Pointers are valid until the catalog
+// is modified. Return the number of films stored in result, or -1 if the cursor is from an older catalog version
+int catalog_freeFilmsPage(const tCatalog* catalog, tFilmListCursor* cursor, int max, const tFilm** result);
+
+// Get up to max films of a genre after the cursor, moving it to the last returned film. Pointers are valid until the catalog
+// is modified. Return the number of films stored in result, or -1 if the cursor is from an older catalog version
+int catalog_genreFilmsPage(const tCatalog* catalog, tFilmGenre genre, tFilmListCursor* cursor, int max, const tFilm** result);
+
+// Return the first film of the given genre. FILM_HANDLE_NONE if there is none
+tFilmHandle catalog_genreFirst(const tCatalog* catalog, tFilmGenre genre);
+
+// Return the next film with the same genre. FILM_HANDLE_NONE if it is the last one
+tFilmHandle catalog_genreNext(const tCatalog* catalog, tFilmHandle handle);
+
+// Get the k best rated films of a genre (or FILM_GENRE_ANY), optionally only the free ones.
+// Result must have room for k handles. Return the number of films stored in result
+int catalog_topRated(const tCatalog* catalog, int k, int genre, bool freeOnly, tFilmHandle* result);
+
+// Return the number of films released between from and to, both included
+int catalog_releaseCount(const tCatalog* catalog, tDate from, tDate to);
+
+// Get up to max films released between from and to, both included, sorted by release date.
+// Starts after the cursor and moves it to the last returned film. Return the number of films stored in result
+int catalog_releaseRange(const tCatalog* catalog, tDate from, tDate to, tReleaseCursor* cursor, int max, tFilmHandle* result);
+
+// Get up to max films whose normalized name contains the normalized fragment, ordered by handle.
+// Return the number of films stored in result, or -1 if there is no memory available
+int catalog_search(const tCatalog* catalog, const char* fragment, int max, tFilmHandle* result);
+
+// Get up to max films whose normalized name is at most maxDistance edits away from the normalized query,
+// sorted by distance and then by rating. Return the number of films stored in result, or -1 if there is no memory available
+int catalog_fuzzySearch(const tCatalog* catalog, const char* query, int maxDistance, int max, tFilmHandle* result);
+
+// Get up to max (at most TRIE_TOP_K) best rated films whose normalized name starts with the normalized prefix.
+// Return the number of films stored in result, or -1 if there is no memory available
+int catalog_complete(const tCatalog* catalog, const char* prefix, int max, tFilmHandle* result);
+
+// Initialize a filter that accepts every film
+void filmFilter_init(tFilmFilter* filter);
+
+// Return the number of films that pass the filter
+int catalog_filterCount(const tCatalog* catalog, const tFilmFilter* filter);
+
+// Get up to max films that pass the filter, starting at handle from, ordered by handle.
+// Return the number of films stored in result
+int catalog_filter(const tCatalog* catalog, const tFilmFilter* filter, tFilmHandle from, int max, tFilmHandle* result);
+
+// Return the bitmap with the handles of all the films
+const tBitmap* catalog_filmsBitmap(const tCatalog* catalog);
+
+// Return the bitmap with the handles of the films of a genre
+const tBitmap* catalog_genreBitmap(const tCatalog* catalog, tFilmGenre genre);
+
+// Return the bitmap with the handles of the free films
+const tBitmap* catalog_freeBitmap(const tCatalog* catalog);
+
+// Store in result the handles of the films rated between minRating and maxRating, both included.
+// Result must be initialized and is overwritten
+tApiError catalog_ratingBitmap(const tCatalog* catalog, float minRating, float maxRating, tBitmap* result);
+
+// Initialize a query that returns every film in handle order, in a single page
+void filmQuery_init(tFilmQuery* query);
+
+// Initialize a cursor at the start of a query
+void filmQueryCursor_init(tFilmQueryCursor* cursor);
+
+// Get the next page of films of a query, starting after the cursor and moving it to the last returned film.
+// Result must have room for the query limit. Return the number of films stored in result, or -1 if there is no memory available
+int catalog_query(const tCatalog* catalog, const tFilmQuery* query, tFilmQueryCursor* cursor, tFilmHandle* result);
+
+// Group the films by genre, by release decade and by isFree in a single pass over the columns
+tApiError catalog_stats(const tCatalog* catalog, tFilmStats* stats);
+
+// Remove the data from the film statistics
+void filmStats_free(tFilmStats* stats);
+
+// Move the films to fill the holes of the store. Handles do not change
+tApiError catalog_compact(tCatalog* catalog);
+
 // Remove the films from the catalog
 tApiError catalog_free(tCatalog* catalog);
 
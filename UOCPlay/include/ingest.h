@@ -0,0 +1,92 @@
+#ifndef __INGEST_H__
+#define __INGEST_H__
+#include <threads.h>
+#include "api.h"
+#include "error.h"
+
+// Number of shards of the ingested data. Keys are spread among them by hash
+#define INGEST_SHARDS 16
+
+// Kinds of rows, by the type of their record
+typedef enum {
+    INGEST_PERSON,
+    INGEST_SUBSCRIPTION,
+    INGEST_FILM,
+    INGEST_INVALID
+} tIngestKind;
+
+// Position of a key in a shard: a record of the shard, or a record of the data being extended (INGEST_EXISTING)
+typedef struct _tIngestSlot {
+    unsigned int hash;
+    int index;
+} tIngestSlot;
+
+// Index of the slots marking an existing record of the data being extended
+#define INGEST_EXISTING(index) (-2 - (index))
+
+// Hash table of keys of one kind of record, with linear probing. Empty slots have index -1
+typedef struct _tIngestTable {
+    tIngestSlot *slots;
+    int count;
+    int capacity;
+} tIngestTable;
+
+// Records of a shard, each with the row it came from
+typedef struct _tIngestShard {
+    mtx_t lock;
+    tIngestTable peopleKeys;
+    tIngestTable subscriptionKeys;
+    tIngestTable filmKeys;
+    tPerson *people;
+    int *peopleRows;
+    int peopleCount;
+    int peopleCapacity;
+    tSubscription *subscriptions;
+    int *subscriptionRows;
+    int subscriptionCount;
+    int subscriptionCapacity;
+    tFilm *films;
+    int *filmRows;
+    int filmCount;
+    int filmCapacity;
+} tIngestShard;
+
+// Rows being added to the data by many threads at once. Each shard owns the keys hashed to it,
+// so duplicates are found exactly under the lock of a single shard
+typedef struct _tIngest {
+    tIngestShard shards[INGEST_SHARDS];
+    // Data being extended. It must not change until the ingestion ends
+    tApiData *data;
+} tIngest;
+
+//////////////////////////////////
+// Available methods
+//////////////////////////////////
+
+// Start adding rows to the data, which keeps its current records
+tApiError ingest_init(tIngest* ingest, tApiData* data);
+
+// Add a person, taking ownership of it on success. Safe to call from many threads
+tApiError ingest_addPerson(tIngest* ingest, int row, tPerson person);
+
+// Get the kind of a csv line and the shard owning the key of its record, without parsing the whole line
+tIngestKind ingest_classify(const char* line, int* shard);
+
+// Add a subscription of a person added from an earlier row. Safe to call from many threads
+tApiError ingest_addSubscription(tIngest* ingest, int row, tSubscription subscription);
+
+// Add a film, taking ownership of it on success. Safe to call from many threads
+tApiError ingest_addFilm(tIngest* ingest, int row, tFilm film);
+
+// Parse and add an entry of any type. Safe to call from many threads
+tApiError ingest_addEntry(tIngest* ingest, int row, tCSVEntry entry);
+
+// Move the added records to the data in row order and remove the ingestion data
+tApiError ingest_finish(tIngest* ingest);
+
+// Discard the added records and remove the ingestion data
+void ingest_free(tIngest* ingest);
+
+////////////////////////////////////////////
+
+#endif // __INGEST_H__
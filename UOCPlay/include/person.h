@@ -3,6 +3,7 @@
 #include "csv.h"
 #include "date.h"
 #include "error.h"
+#include "pool.h"
 
 #define NUM_FIELDS_PERSON 8
 
@@ -20,30 +21,38 @@ typedef struct _tPerson {
 typedef struct _tPeople {
     tPerson* elems;
     int count;
+    int capacity;
+    // Fields of the people, removed all at once
+    tStringArena strings;
+    // Allocator of the people memory, NULL for the C heap
+    const tAllocator* allocator;
 } tPeople;
 
 //////////////////////////////////
 // Available methods
 //////////////////////////////////
 
-// Parse input from CSVEntry
-void person_parse(tPerson* data, tCSVEntry entry);
+// Parse input from CSVEntry. The fields are copied with the allocator, or with malloc if it is NULL
+void person_parse(tPerson* data, tCSVEntry entry, const tAllocator* allocator);
 
-// Copy the data from the source to destination
-void person_cpy(tPerson* destination, tPerson source);
+// Copy the data from the source to destination, copying the fields with the allocator
+void person_cpy(tPerson* destination, tPerson source, const tAllocator* allocator);
 
-// Remove the data from a person
-void person_free(tPerson* data);
+// Remove the data from a person, initialized with the same allocator
+void person_free(tPerson* data, const tAllocator* allocator);
 
-// Initialize the people data
-tApiError people_init(tPeople* data);
+// Initialize the people data, whose memory comes from the allocator or from the C heap if it is NULL
+tApiError people_init(tPeople* data, const tAllocator* allocator);
 
 // Return the number of people
 int people_count(tPeople data);
 
-// Add a new person
+// Add a new person, copying its fields
 tApiError people_add(tPeople* data, tPerson person);
 
+// Add a person known not to exist, copying its fields
+tApiError people_append(tPeople* data, tPerson person);
+
 // Remove a person
 tApiError people_del(tPeople* data, const char *document);
 
@@ -0,0 +1,158 @@
+#ifndef __POOL_H__
+#define __POOL_H__
+#include <stddef.h>
+#include <stdbool.h>
+#include "allocator.h"
+
+// Number of elements of the first slab of a pool. Each slab doubles the previous one
+#define POOL_SLAB_ELEMS 256
+
+// Size of the first chunk of a string arena. Each chunk doubles the previous one
+#define ARENA_CHUNK_SIZE (64 * 1024)
+
+// Biggest size pools and arenas grow their blocks to, so big data is removed with a few calls
+#define POOL_MAX_BLOCK_SIZE (32 * 1024 * 1024)
+
+// Size of a huge page. Blocks of at least this size use huge pages when the system has them
+#define POOL_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+// Block of memory with room for several pool elements
+typedef struct _tPoolSlab {
+    struct _tPoolSlab *next;
+    // Bytes of the block, header included
+    size_t size;
+} tPoolSlab;
+
+// Released element of a pool, reused by the next allocation
+typedef struct _tPoolFreeElem {
+    struct _tPoolFreeElem *next;
+} tPoolFreeElem;
+
+// Allocator of fixed size elements
+typedef struct _tPool {
+    size_t elemSize;
+    tPoolSlab *slabs;
+    tPoolFreeElem *freeElems;
+    // Elements of the last slab not used yet
+    char *next;
+    char *end;
+    // Elements of the next slab
+    size_t slabElems;
+    int count;
+    // Allocator of the slabs, NULL to map them from the system
+    const tAllocator *allocator;
+} tPool;
+
+// Block of memory used to store strings
+typedef struct _tArenaChunk {
+    struct _tArenaChunk *next;
+    // Bytes of the block, header included
+    size_t size;
+} tArenaChunk;
+
+// Number of size classes of a block arena, from 16 bytes to BLOCK_ARENA_MAX_SIZE
+#define BLOCK_ARENA_CLASSES 44
+
+// Biggest block a block arena carves from its chunks. Bigger ones are requested one by one
+#define BLOCK_ARENA_MAX_SIZE (64 * 1024)
+
+// Block of a block arena bigger than BLOCK_ARENA_MAX_SIZE, linked so the arena can remove it
+typedef struct _tBlockArenaBig {
+    struct _tBlockArenaBig *prev;
+    struct _tBlockArenaBig *next;
+    // Bytes of the block, headers excluded
+    size_t size;
+} tBlockArenaBig;
+
+// Allocator of blocks of any size, carved from big chunks and released all at once.
+// Released blocks are reused by later ones of the same size class
+typedef struct _tBlockArena {
+    tArenaChunk *chunks;
+    char *next;
+    char *end;
+    // Bytes of the blocks of the next chunk
+    size_t chunkSize;
+    // Released blocks of each size class
+    tPoolFreeElem *freeBlocks[BLOCK_ARENA_CLASSES];
+    tBlockArenaBig *bigBlocks;
+    // Allocator of the chunks and big blocks, NULL to get them from the system
+    const tAllocator *allocator;
+    // Allocator giving the blocks of this arena, so it can be used by any structure
+    tAllocator blocks;
+} tBlockArena;
+
+// Allocator of strings that are released all at once
+typedef struct _tStringArena {
+    tArenaChunk *chunks;
+    char *next;
+    char *end;
+    // Bytes of the strings of the next chunk
+    size_t chunkSize;
+    // Bytes of the strings in use and of the released ones
+    size_t used;
+    size_t wasted;
+    // Allocator of the chunks, NULL to map them from the system
+    const tAllocator *allocator;
+} tStringArena;
+
+//////////////////////////////////
+// Available methods
+//////////////////////////////////
+
+// Initialize a pool of elements of the given size, whose slabs come from the allocator.
+// If it is NULL, big slabs are mapped from the system with huge pages when available
+void pool_init(tPool* pool, size_t elemSize, const tAllocator* allocator);
+
+// Get memory for one element. NULL if there is no memory available
+void* pool_alloc(tPool* pool);
+
+// Give back one element to the pool
+void pool_release(tPool* pool, void* elem);
+
+// Return the number of elements in use
+int pool_count(tPool pool);
+
+// Remove all the memory of the pool
+void pool_free(tPool* pool);
+
+// Initialize a string arena whose chunks come from the allocator, or from the system if it is NULL
+void stringArena_init(tStringArena* arena, const tAllocator* allocator);
+
+// Make room for size bytes of strings, so the next copies up to that size can not fail
+bool stringArena_reserve(tStringArena* arena, size_t size);
+
+// Copy a string into the arena. NULL if there is no memory available
+char* stringArena_dup(tStringArena* arena, const char* str);
+
+// Mark a string of the arena as not used. Its memory is recovered when the arena is removed
+void stringArena_release(tStringArena* arena, const char* str);
+
+// Check if most of the arena memory is used by released strings
+bool stringArena_isFragmented(tStringArena arena);
+
+// Remove all the strings of the arena
+void stringArena_free(tStringArena* arena);
+
+// Initialize a block arena whose chunks come from the allocator, or from the system if it is NULL.
+// The arena can not be moved once initialized, since its allocator points to it
+void blockArena_init(tBlockArena* arena, const tAllocator* allocator);
+
+// Get a block of size bytes. NULL if there is no memory available
+void* blockArena_alloc(tBlockArena* arena, size_t size);
+
+// Resize a block of the arena, keeping its content. NULL if there is no memory available, and then the block is not changed
+void* blockArena_realloc(tBlockArena* arena, void* block, size_t size);
+
+// Give back a block to the arena
+void blockArena_release(tBlockArena* arena, void* block);
+
+// Get an allocator giving the blocks of the arena. It is not thread-safe: use it only for memory changed by one
+// thread at a time, and not where the library needs a thread-safe allocator
+const tAllocator* blockArena_allocator(tBlockArena* arena);
+
+// Remove all the blocks of the arena
+void blockArena_free(tBlockArena* arena);
+
+////////////////////////////////////////////
+
+#endif // __POOL_H__
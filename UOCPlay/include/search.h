@@ -0,0 +1,147 @@
+#ifndef __SEARCH_H__
+#define __SEARCH_H__
+#include <stdbool.h>
+#include "allocator.h"
+#include "error.h"
+
+// Number of characters of each n-gram of the text indexes
+#define TRIGRAM_LENGTH 3
+
+// Sorted list of the identifiers of the texts that contain a trigram
+typedef struct _tPostingList {
+    int *elems;
+    int count;
+    int capacity;
+    // Allocator of the identifiers, NULL for the C heap
+    const tAllocator *allocator;
+} tPostingList;
+
+typedef struct _tTrigramIndexEntry {
+    unsigned int trigram;
+    tPostingList list;
+} tTrigramIndexEntry;
+
+// Inverted index from trigrams of normalized texts to text identifiers, with linear probing
+typedef struct _tTrigramIndex {
+    tTrigramIndexEntry *elems;
+    int capacity;
+    int count;
+    // Allocator of the slots, queries and results, NULL for the C heap
+    const tAllocator *allocator;
+    // Allocator of the posting lists of the index, NULL for the C heap
+    const tAllocator *listAllocator;
+} tTrigramIndex;
+
+// Number of best scored completions cached in each node of a trie
+#define TRIE_TOP_K 8
+
+// No node, terminal or identifier
+#define TRIE_NONE (-1)
+
+// Node of a trie. Children are linked through their siblings
+typedef struct _tTrieNode {
+    int firstChild;
+    int nextSibling;
+    // First terminal of the texts ending at this node
+    int terminal;
+    // Number of texts ending at this node or below it
+    int count;
+    // Number of identifiers cached in the top array of the node
+    int topCount;
+    char label;
+} tTrieNode;
+
+// Identifier of a text ending at a node
+typedef struct _tTrieTerminal {
+    int id;
+    int next;
+} tTrieTerminal;
+
+// Prefix tree of normalized texts stored in arrays. Node 0 is the root.
+// Each node caches the TRIE_TOP_K best scored identifiers below it
+typedef struct _tTrie {
+    tTrieNode *nodes;
+    int nodeCount;
+    int nodeCapacity;
+    // Released nodes, linked through nextSibling
+    int freeNodes;
+    // TRIE_TOP_K identifiers for each node, best scored first
+    int *top;
+    tTrieTerminal *terminals;
+    int terminalCount;
+    int terminalCapacity;
+    // Released terminals, linked through next
+    int freeTerminals;
+    // Score of each identifier
+    float *scores;
+    int scoreCapacity;
+    // Allocator of the arrays, NULL for the C heap
+    const tAllocator *allocator;
+} tTrie;
+
+//////////////////////////////////
+// Available methods
+//////////////////////////////////
+
+// Copy src to dst in lower case, without punctuation and with single spaces. dst needs strlen(src) + 1 chars.
+// Return the length of the normalized text
+int text_normalize(const char* src, char* dst);
+
+// Return the edit distance between two texts, or maxDistance + 1 if it is greater than maxDistance.
+// Long texts need temporary memory from the allocator, or from the C heap if it is NULL
+int text_editDistance(const char* a, const char* b, int maxDistance, const tAllocator* allocator);
+
+// Return the minimum number of distinct trigrams of a normalized query that a text within maxDistance edits
+// must share with it. 0 or less if any text could be within that distance.
+// Temporary memory comes from the allocator, or from the C heap if it is NULL
+int text_minSharedTrigrams(const char* normalizedQuery, int maxDistance, const tAllocator* allocator);
+
+// Initialize a posting list whose memory comes from the allocator, or from the C heap if it is NULL
+void postingList_init(tPostingList* list, const tAllocator* allocator);
+
+// Check if the list contains the identifier
+bool postingList_contains(tPostingList list, int id);
+
+// Remove the data from a posting list
+void postingList_free(tPostingList* list);
+
+// Initialize a trigram index whose posting lists come from listAllocator and the rest of its memory from allocator.
+// NULL allocators use the C heap. Only allocator is used by the searches, so only it has to be thread-safe
+void trigramIndex_init(tTrigramIndex* index, const tAllocator* allocator, const tAllocator* listAllocator);
+
+// Add the trigrams of a text with the given identifier
+tApiError trigramIndex_add(tTrigramIndex* index, const char* text, int id);
+
+// Remove the trigrams of a text with the given identifier
+tApiError trigramIndex_del(tTrigramIndex* index, const char* text, int id);
+
+// Get the identifiers of the texts with all the trigrams of a normalized query, sorted.
+// The query must have at least TRIGRAM_LENGTH chars. Result uses the index allocator and must be freed with postingList_free
+tApiError trigramIndex_match(const tTrigramIndex* index, const char* normalizedQuery, tPostingList* result);
+
+// Get the identifiers, lower than idCount, of the texts sharing at least minShared distinct trigrams with a
+// normalized query, sorted. minShared must be positive. Result uses the index allocator and must be freed with postingList_free
+tApiError trigramIndex_similar(const tTrigramIndex* index, const char* normalizedQuery, int minShared, int idCount, tPostingList* result);
+
+// Remove the data from a trigram index
+void trigramIndex_free(tTrigramIndex* index);
+
+// Initialize a trie whose memory comes from the allocator, or from the C heap if it is NULL
+void trie_init(tTrie* trie, const tAllocator* allocator);
+
+// Add a text with the given identifier and score
+tApiError trie_add(tTrie* trie, const char* text, int id, float score);
+
+// Remove a text with the given identifier
+tApiError trie_del(tTrie* trie, const char* text, int id);
+
+// Get up to max (at most TRIE_TOP_K) best scored identifiers of the texts starting with a normalized prefix.
+// Return the number of identifiers stored in result
+int trie_complete(const tTrie* trie, const char* normalizedPrefix, int max, int* result);
+
+// Remove the data from a trie
+void trie_free(tTrie* trie);
+
+////////////////////////////////////////////
+
+#endif // __SEARCH_H__
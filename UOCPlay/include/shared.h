@@ -0,0 +1,110 @@
+#ifndef __SHARED_H__
+#define __SHARED_H__
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <threads.h>
+#include "api.h"
+#include "error.h"
+
+// Size of the cache line each reader keeps to itself
+#define SHARED_CACHE_LINE 64
+
+// Microseconds a writer first sleeps while waiting for readers. Each wait doubles it up to the maximum
+#define SHARED_BACKOFF_MIN_US 50
+#define SHARED_BACKOFF_MAX_US 10000
+
+// Thread reading the shared data. Its epoch is 0 while it is outside a read-side section.
+// Each reader thread owns one, registered before its first read
+typedef struct _tSharedReader {
+    _Alignas(SHARED_CACHE_LINE) atomic_ullong epoch;
+    struct _tSharedReader *next;
+    struct _tSharedReader *prev;
+} tSharedReader;
+
+// Version of the data replaced by a writer, freed once no reader can still see it
+typedef struct _tSharedVersion {
+    tApiData *data;
+    // Epoch started by the writer that replaced it
+    unsigned long long epoch;
+    struct _tSharedVersion *next;
+} tSharedVersion;
+
+// Application data shared by many reader threads and updated by writers publishing new versions.
+// Readers never block: they see the version published when their read-side section started
+typedef struct _tSharedData {
+    _Atomic(tApiData*) current;
+    atomic_ullong epoch;
+    // Registered readers, only changed and walked under readersLock
+    tSharedReader *readers;
+    mtx_t readersLock;
+    // Serializes the writers and protects the retired versions
+    mtx_t writerLock;
+    tSharedVersion *retired;
+    // Allocator and thread pool of the versions built by the shared data itself. The allocator also gives the
+    // tApiData of those versions and the retired version records. Not owned by it
+    const tAllocator *allocator;
+    tThreadPool *pool;
+} tSharedData;
+
+//////////////////////////////////
+// Available methods
+//////////////////////////////////
+
+// Initialize the shared data with an empty version. The first version and the reloaded ones use the allocator,
+// NULL for the C heap, and the thread pool, NULL to run on the calling thread
+tApiError sharedData_init(tSharedData* shared, const tAllocator* allocator, tThreadPool* pool);
+
+// Register a reader thread
+void sharedData_register(tSharedData* shared, tSharedReader* reader);
+
+// Unregister a reader thread, which must be outside a read-side section
+void sharedData_unregister(tSharedData* shared, tSharedReader* reader);
+
+// Start a read-side section and return the current version, which stays valid and unchanged until the section ends
+const tApiData* sharedData_readLock(tSharedData* shared, tSharedReader* reader);
+
+// End a read-side section. The version returned by the lock must not be used anymore
+void sharedData_readUnlock(tSharedReader* reader);
+
+// Start an update, returning in copy a private copy of the current version. Other writers wait until it is committed or aborted.
+// The copy costs as much as loading the whole data, so updates should be grouped: all the changes made before the
+// commit are published as one version, or use sharedData_writeBatch
+tApiError sharedData_beginWrite(tSharedData* shared, tApiData** copy);
+
+// Publish the updated copy returned by sharedData_beginWrite, retiring the previous version
+void sharedData_commit(tSharedData* shared, tApiData* copy);
+
+// Discard the copy returned by sharedData_beginWrite, keeping the current version
+void sharedData_abort(tSharedData* shared, tApiData* copy);
+
+// Add the entries of a batch to one copy of the current version and publish it, so the whole batch costs one copy.
+// If an entry fails, nothing is published
+tApiError sharedData_writeBatch(tSharedData* shared, tCSVData batch);
+
+// Publish a version built by the caller, taking ownership of it and retiring the previous one.
+// The tApiData itself must come from its own allocator, since it is freed with allocator_free(data->allocator, data)
+void sharedData_publish(tSharedData* shared, tApiData* data);
+
+// Load a CSV file into a new version and publish it. Readers keep the previous version until they end their
+// read-side section, so they never see a partial load. The previous version is not waited for: later writes and
+// sharedData_reclaim free it once its readers are done. The rows are added by the threads of the pool of the shared data, if any
+tApiError sharedData_reload(tSharedData* shared, const char* filename);
+
+// Start loading a CSV file in the background into a new version, published by the loading thread when the load
+// ends with success. The previous version is retired as in sharedData_reload.
+// The task is ended with apiLoadTask_wait, with NULL data, and apiLoadTask_free, outside a read-side section
+tApiError sharedData_reloadAsync(tSharedData* shared, tApiLoadTask** task, const char* filename);
+
+// Free the retired versions no reader can still see, without waiting. Return the number of versions still retired
+int sharedData_reclaim(tSharedData* shared);
+
+// Wait until every retired version is freed, sleeping longer each time the readers are not done.
+// It can not be called inside a read-side section
+void sharedData_synchronize(tSharedData* shared);
+
+// Remove the shared data. No reader can be inside a read-side section
+void sharedData_free(tSharedData* shared);
+
+////////////////////////////////////////////
+
+#endif // __SHARED_H__
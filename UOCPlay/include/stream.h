@@ -0,0 +1,96 @@
+#ifndef __STREAM_H__
+#define __STREAM_H__
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <threads.h>
+#include "allocator.h"
+#include "error.h"
+
+// Size in bytes of each block read ahead
+#ifndef STREAM_BLOCK_SIZE
+#define STREAM_BLOCK_SIZE (1 << 20)
+#endif
+
+// Number of blocks: one is parsed while the other one is filled
+#define STREAM_BLOCKS 2
+
+// Number of slots of the rings, a power of two not lower than STREAM_BLOCKS
+#define STREAM_RING_SIZE 2
+
+// Milliseconds the read-ahead thread waits for input before checking if the stream was closed
+#define STREAM_POLL_MS 100
+
+// Complete lines stored at the start of a block
+typedef struct _tStreamBatch {
+    int block;
+    int length;
+    // No more batches follow this one
+    bool last;
+} tStreamBatch;
+
+// Lock-free ring of batches with a single producer thread and a single consumer thread
+typedef struct _tStreamRing {
+    tStreamBatch slots[STREAM_RING_SIZE];
+    // Next slot to pop, only changed by the consumer
+    _Alignas(64) atomic_uint head;
+    // Next slot to push, only changed by the producer
+    _Alignas(64) atomic_uint tail;
+} tStreamRing;
+
+// Lines of a file descriptor, read ahead by a thread while the caller parses the previous block
+typedef struct _tLineStream {
+    int fd;
+    char *blocks[STREAM_BLOCKS];
+    // Part of a line left at the end of the last block filled
+    char *carry;
+    int carryLength;
+    // Batches of lines ready to be parsed, and blocks ready to be filled
+    tStreamRing full;
+    tStreamRing free;
+    thrd_t reader;
+    atomic_bool stop;
+    // Threads waiting for an empty ring to get a batch, or for a full one to get room, sleep on it.
+    // The rings stay lock-free; the lock is only taken to sleep and to wake the other thread
+    mtx_t lock;
+    cnd_t changed;
+    // Error of the read-ahead thread, E_SUCCESS if it did not fail
+    tApiError error;
+    // Bytes read so far
+    atomic_llong bytes;
+    // Allocator of the blocks and the carry, NULL for the C heap
+    const tAllocator *allocator;
+} tLineStream;
+
+//////////////////////////////////
+// Available methods
+//////////////////////////////////
+
+// Initialize an empty ring
+void streamRing_init(tStreamRing* ring);
+
+// Add a batch at the end of the ring. Return false if it is full
+bool streamRing_push(tStreamRing* ring, tStreamBatch batch);
+
+// Take the first batch of the ring. Return false if it is empty
+bool streamRing_pop(tStreamRing* ring, tStreamBatch* batch);
+
+// Get the bytes left to read from a file descriptor, -1 if it can not seek, such as a pipe
+long long lineStream_size(int fd);
+
+// Start reading ahead the lines of a file descriptor, which stays open. The blocks come from the allocator,
+// or from the C heap if it is NULL
+tApiError lineStream_open(tLineStream* stream, int fd, const tAllocator* allocator);
+
+// Wait for the next batch of complete lines. Its text is valid until the batch is released
+const char* lineStream_next(tLineStream* stream, tStreamBatch* batch);
+
+// Give back the block of a batch to be filled again
+void lineStream_release(tLineStream* stream, tStreamBatch batch);
+
+// Stop reading ahead and remove the stream data. Return the error of the read-ahead thread, if any.
+// On Windows it waits for a read in progress, so it blocks until a pipe writer sends more data or closes it
+tApiError lineStream_close(tLineStream* stream);
+
+////////////////////////////////////////////
+
+#endif // __STREAM_H__
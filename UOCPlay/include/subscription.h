@@ -23,6 +23,9 @@ typedef struct _tSubscription {
 typedef struct _tSubscriptions {
     tSubscription *elems;
     int count;
+    int capacity;
+    // Allocator of the elements, NULL for the C heap
+    const tAllocator* allocator;
 } tSubscriptions;
 
 //////////////////////////////////
@@ -38,8 +41,12 @@ void subscription_cpy(tSubscription* destination, tSubscription source);
 // Get subscription data using a string
 void subscription_get(tSubscription data, char* buffer);
 
-// Initialize subscriptions data
-tApiError subscriptions_init(tSubscriptions* data);
+// Write the subscription record into a buffer of the given size, truncating it if it does not fit.
+// Integral prices are written without decimals. Return the number of bytes needed, including the terminator
+int subscription_format(tSubscription data, char* buffer, int size);
+
+// Initialize subscriptions data, whose memory comes from the allocator or from the C heap if it is NULL
+tApiError subscriptions_init(tSubscriptions* data, const tAllocator* allocator);
 
 // Return the number of subscriptions
 int subscriptions_len(tSubscriptions data);
@@ -47,6 +54,9 @@ int subscriptions_len(tSubscriptions data);
 // Add a new subscription
 tApiError subscriptions_add(tSubscriptions* data, tPeople people, tSubscription subscription);
 
+// Add a subscription known not to exist, of a person that exists
+tApiError subscriptions_append(tSubscriptions* data, tSubscription subscription);
+
 // Remove a subscription
 tApiError subscriptions_del(tSubscriptions* data, int id);
 
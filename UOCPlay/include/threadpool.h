@@ -0,0 +1,97 @@
+#ifndef __THREADPOOL_H__
+#define __THREADPOOL_H__
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <threads.h>
+#include "error.h"
+
+// Initial number of tasks of each deque
+#define POOL_DEQUE_CAPACITY 64
+
+// Maximum number of worker threads of a pool
+#define POOL_MAX_WORKERS 64
+
+// Function run by a task over the range [begin, end) of its argument
+typedef void (*tPoolTaskFn)(void *arg, int begin, int end);
+
+struct _tTaskGroup;
+
+// Task waiting to run
+typedef struct _tPoolTask {
+    tPoolTaskFn fn;
+    void *arg;
+    int begin;
+    int end;
+    struct _tTaskGroup *group;
+} tPoolTask;
+
+// Tasks of one worker, as a ring. The owner pushes and pops the newest ones, other threads steal the oldest ones
+typedef struct _tPoolDeque {
+    mtx_t lock;
+    tPoolTask *tasks;
+    int capacity;
+    // Oldest task and number of tasks
+    int top;
+    int count;
+} tPoolDeque;
+
+struct _tThreadPool;
+
+// Worker thread of a pool
+typedef struct _tPoolWorker {
+    struct _tThreadPool *pool;
+    int index;
+    thrd_t thread;
+} tPoolWorker;
+
+// Threads running tasks, each one from its own deque first and stealing from the others when it is empty.
+// Tasks pushed from threads outside the pool go to one more shared deque
+typedef struct _tThreadPool {
+    tPoolWorker workers[POOL_MAX_WORKERS];
+    int count;
+    // One deque per worker, and the shared one last
+    tPoolDeque deques[POOL_MAX_WORKERS + 1];
+    // Tasks in the deques, so idle workers know when to sleep
+    atomic_int queued;
+    atomic_bool stop;
+    mtx_t sleepLock;
+    cnd_t wake;
+} tThreadPool;
+
+// Tasks that are waited for together
+typedef struct _tTaskGroup {
+    tThreadPool *pool;
+    // Tasks not finished yet
+    atomic_int pending;
+} tTaskGroup;
+
+//////////////////////////////////
+// Available methods
+//////////////////////////////////
+
+// Start a pool of the given number of threads, the one waiting for the tasks included.
+// A pool is shared by data with different allocators, so its task deques always come from the C heap
+tApiError threadPool_init(tThreadPool* pool, int threads);
+
+// Return the number of threads running tasks, the one waiting for them included
+int threadPool_threads(tThreadPool* pool);
+
+// Run fn over the range [begin, end), split in parts of at least grain indexes run by the pool threads.
+// A grain of 0 or less picks one. It returns when every part is done. If pool is NULL, it runs on the calling thread
+void threadPool_parallelFor(tThreadPool* pool, int begin, int end, int grain, tPoolTaskFn fn, void* arg);
+
+// Stop the pool threads. Every task group must have been waited for
+void threadPool_free(tThreadPool* pool);
+
+// Initialize a group of tasks of a pool. If pool is NULL, its tasks run as soon as they are added
+void taskGroup_init(tTaskGroup* group, tThreadPool* pool);
+
+// Add a task running fn(arg, begin, end) to the group
+void taskGroup_run(tTaskGroup* group, tPoolTaskFn fn, void* arg, int begin, int end);
+
+// Wait until every task of the group is done, running pool tasks meanwhile
+void taskGroup_wait(tTaskGroup* group);
+
+////////////////////////////////////////////
+
+#endif // __THREADPOOL_H__
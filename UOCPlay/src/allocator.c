@@ -0,0 +1,72 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include "allocator.h"
+
+// Get size bytes of memory from the allocator, or from malloc if it is NULL
+void *allocator_alloc(const tAllocator *allocator, size_t size) {
+    if (allocator == NULL)
+        return malloc(size);
+
+    // Check preconditions
+    assert(allocator->alloc != NULL);
+
+    return allocator->alloc(allocator->context, size);
+}
+
+// Get memory for count elements of the given size, set to zero
+void *allocator_calloc(const tAllocator *allocator, size_t count, size_t size) {
+    if (allocator == NULL)
+        return calloc(count, size);
+
+    if (size > 0 && count > SIZE_MAX / size)
+        return NULL;
+
+    void *ptr = allocator_alloc(allocator, count * size);
+    if (ptr != NULL)
+        memset(ptr, 0, count * size);
+
+    return ptr;
+}
+
+// Resize memory of the allocator, keeping its content
+void *allocator_realloc(const tAllocator *allocator, void *ptr, size_t size) {
+    if (allocator == NULL)
+        return realloc(ptr, size);
+    if (ptr == NULL)
+        return allocator_alloc(allocator, size);
+
+    // Check preconditions
+    assert(allocator->realloc != NULL);
+
+    return allocator->realloc(allocator->context, ptr, size);
+}
+
+// Copy a string into memory of the allocator
+char *allocator_strdup(const tAllocator *allocator, const char *str) {
+    // Check preconditions
+    assert(str != NULL);
+
+    size_t len = strlen(str) + 1;
+    char *copy = (char *) allocator_alloc(allocator, len);
+    if (copy != NULL)
+        memcpy(copy, str, len);
+
+    return copy;
+}
+
+// Give back memory of the allocator
+void allocator_free(const tAllocator *allocator, void *ptr) {
+    if (ptr == NULL)
+        return;
+    if (allocator == NULL) {
+        free(ptr);
+        return;
+    }
+
+    // Check preconditions
+    assert(allocator->free != NULL);
+
+    allocator->free(allocator->context, ptr);
+}
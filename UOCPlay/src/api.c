@@ -1,16 +1,68 @@
+// fileno is POSIX
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
 #include <stdio.h>
 #include <assert.h>
 #include "csv.h"
 #include "api.h"
+#include "ingest.h"
+#include "stream.h"
+#include "threadpool.h"
 
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <string.h>
+#include <threads.h>
+#include <time.h>
+
+#ifdef _WIN32
+#define api_fileno(file) _fileno(file)
+#else
+#define api_fileno(file) fileno(file)
+#endif
+
+// Load running in the background. Its data is only used by the loading thread until the load ends
+struct _tApiLoadTask {
+    tApiData *data;
+    FILE *file;
+    long long totalBytes;
+    atomic_llong bytesRead;
+    atomic_int rowsApplied;
+    atomic_int rowsRejected;
+    atomic_bool cancelled;
+    atomic_bool done;
+    // Result of the load, set before the callback is called
+    tApiError error;
+    struct timespec start;
+    thrd_t thread;
+    // The loading thread was joined
+    bool waited;
+    tApiLoadCallback callback;
+    void *context;
+    // Allocator of the task and its data, the one of the base data
+    const tAllocator *allocator;
+};
 
 // Get the API version information
 const char *api_version() {
     return "UOC PP 20242";
 }
 
+// Remove all the records, keeping the thread pool and the allocator
+static tApiError api_resetData(tApiData *data) {
+    tThreadPool *pool = data->pool;
+    const tAllocator *allocator = data->allocator;
+    tApiError error = api_freeData(data);
+
+    if (error == E_SUCCESS) {
+        error = api_initData(data, allocator);
+        data->pool = pool;
+    }
+
+    return error;
+}
+
 // Load data from a CSV file. If reset is true, remove previous data
 tApiError api_loadData(tApiData *data, const char *filename, bool reset) {
     tApiError error;
@@ -24,14 +76,8 @@ tApiError api_loadData(tApiData *data, const char *filename, bool reset) {
 
     // Reset current data
     if (reset) {
-        // Remove previous information
-        error = api_freeData(data);
-        if (error != E_SUCCESS) {
-            return error;
-        }
-
-        // Initialize the data
-        error = api_initData(data);
+        // Remove previous information, keeping the settings
+        error = api_resetData(data);
         if (error != E_SUCCESS) {
             return error;
         }
@@ -48,7 +94,7 @@ tApiError api_loadData(tApiData *data, const char *filename, bool reset) {
         // Remove new line character
         buffer[strcspn(buffer, "\n\r")] = '\0';
 
-        csv_initEntry(&entry);
+        csv_initEntryWithAllocator(&entry, data->allocator);
         csv_parseEntry(&entry, buffer, NULL);
         // Add this new entry to the api Data
         error = api_addDataEntry(data, entry);
@@ -65,57 +111,580 @@ tApiError api_loadData(tApiData *data, const char *filename, bool reset) {
     return E_SUCCESS;
 }
 
-// 3b - Initialize the data structure
-tApiError api_initData(tApiData *data) {
-    assert(data != NULL);
+// Add an entry of any type, returning why it was rejected
+static tApiError api_addRow(tApiData *data, tCSVEntry entry) {
+    if (strcmp(entry.type, "PERSON") == 0) {
+        return api_addPerson(data, entry);
+    }
+    if (strcmp(entry.type, "SUBSCRIPTION") == 0) {
+        return api_addSubscription(data, entry);
+    }
+    if (strcmp(entry.type, "FILM") == 0) {
+        return api_addFilm(data, entry);
+    }
 
-    people_init(&data->people);
-    subscriptions_init(&data->subscriptions);
-    catalog_init(&data->catalog);
+    return E_INVALID_ENTRY_TYPE;
+}
 
-    return E_SUCCESS;
+// Parse and add the lines of a stream until its end. Rejected rows are skipped. If there is a task,
+// its progress is updated after each line and the load stops when it is cancelled
+static tApiError api_loadLines(tApiData *data, tLineStream *stream, tApiLoadTask *task) {
+    tApiError error = E_SUCCESS;
+    tStreamBatch batch;
+    tCSVEntry entry;
+
+    do {
+        // THE BLOCK IS OURS UNTIL IT IS RELEASED, SO LINES ARE ENDED IN PLACE
+        char *text = (char *) lineStream_next(stream, &batch);
+        text[batch.length] = '\0';
+
+        char *line = text;
+        while (line < text + batch.length && error == E_SUCCESS) {
+            char *next = line + strcspn(line, "\n");
+            if (*next == '\n') {
+                *next++ = '\0';
+            }
+            // Remove carriage return character
+            line[strcspn(line, "\r")] = '\0';
+
+            if (*line != '\0') {
+                csv_initEntryWithAllocator(&entry, data->allocator);
+                csv_parseEntry(&entry, line, NULL);
+                // Add this new entry to the api Data
+                tApiError rowError = api_addRow(data, entry);
+                csv_freeEntry(&entry);
+
+                if (rowError == E_MEMORY_ERROR) {
+                    error = rowError;
+                } else if (task != NULL) {
+                    atomic_fetch_add(rowError == E_SUCCESS ? &task->rowsApplied : &task->rowsRejected, 1);
+                }
+            }
+            if (task != NULL) {
+                atomic_fetch_add(&task->bytesRead, next - line);
+                if (error == E_SUCCESS && atomic_load_explicit(&task->cancelled, memory_order_relaxed)) {
+                    error = E_LOAD_CANCELLED;
+                }
+            }
+            line = next;
+        }
+
+        lineStream_release(stream, batch);
+    } while (!batch.last && error == E_SUCCESS);
+
+    tApiError readError = lineStream_close(stream);
+
+    return error != E_SUCCESS ? error : readError;
 }
 
-// 3c - Add a person into the data if it does not exist
-tApiError api_addPerson(tApiData *data, tCSVEntry entry) {
+// Load data from the CSV lines of a file descriptor
+tApiError api_loadStream(tApiData *data, int fd, bool reset) {
+    tApiError error;
+    tLineStream stream;
+
+    // Check input data
     assert(data != NULL);
-    tPerson newPerson;
 
-    if (strcmp(entry.type, "PERSON") != 0) {
-        return E_INVALID_ENTRY_TYPE;
+    // Reset current data
+    if (reset) {
+        error = api_resetData(data);
+        if (error != E_SUCCESS) {
+            return error;
+        }
     }
-    if (csv_numFields(entry) != NUM_FIELDS_PERSON) {
-        return E_INVALID_ENTRY_FORMAT;
+
+    error = lineStream_open(&stream, fd, data->allocator);
+    if (error != E_SUCCESS) {
+        return error;
     }
 
-    person_parse(&newPerson, entry);
-    if (people_find(data->people, newPerson.document) >= 0) {
-        return E_PERSON_DUPLICATED;
+    return api_loadLines(data, &stream, NULL);
+}
+
+// Seconds elapsed since the start time
+static double api_elapsed(struct timespec start) {
+    struct timespec now;
+
+    timespec_get(&now, TIME_UTC);
+
+    return (double) (now.tv_sec - start.tv_sec) + (double) (now.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+// Run a load in the background
+static int api_loadTaskRun(void *arg) {
+    tApiLoadTask *task = (tApiLoadTask *) arg;
+    tLineStream stream;
+
+    task->error = lineStream_open(&stream, api_fileno(task->file), task->allocator);
+    if (task->error == E_SUCCESS) {
+        task->error = api_loadLines(task->data, &stream, task);
+    }
+
+    if (task->callback != NULL) {
+        task->callback(task, task->error, task->context);
     }
+    atomic_store(&task->done, true);
 
-    if (data->people.count == 0) {
-        // FIRST PERSON
-        data->people.elems = (tPerson *) malloc(sizeof(tPerson));
+    return 0;
+}
 
-        if (data->people.elems == NULL) {
-            return E_MEMORY_ERROR;
+// Start loading data from a CSV file in the background
+tApiError api_loadDataAsync(tApiLoadTask **loadTask, const tApiData *base, const char *filename,
+                            tApiLoadCallback callback, void *context) {
+    tApiError error;
+
+    // Check input data
+    assert(loadTask != NULL);
+    assert(filename != NULL);
+
+    *loadTask = NULL;
+    const tAllocator *allocator = base == NULL ? NULL : base->allocator;
+    tApiLoadTask *task = (tApiLoadTask *) allocator_alloc(allocator, sizeof(tApiLoadTask));
+    if (task == NULL) {
+        return E_MEMORY_ERROR;
+    }
+    task->allocator = allocator;
+    task->data = NULL;
+    task->callback = callback;
+    task->context = context;
+    task->error = E_SUCCESS;
+    task->waited = false;
+    atomic_init(&task->bytesRead, 0);
+    atomic_init(&task->rowsApplied, 0);
+    atomic_init(&task->rowsRejected, 0);
+    atomic_init(&task->cancelled, false);
+    atomic_init(&task->done, false);
+
+    // Open the input file, and get its size to estimate the time left
+    task->file = fopen(filename, "rb");
+    if (task->file == NULL) {
+        allocator_free(allocator, task);
+        return E_FILE_NOT_FOUND;
+    }
+    task->totalBytes = lineStream_size(api_fileno(task->file));
+
+    // The new data starts empty, or as a copy of the base
+    task->data = (tApiData *) allocator_alloc(allocator, sizeof(tApiData));
+    if (task->data == NULL) {
+        error = E_MEMORY_ERROR;
+    } else if (base == NULL) {
+        error = api_initData(task->data, NULL);
+    } else {
+        error = api_cpyData(task->data, *base);
+    }
+
+    if (error == E_SUCCESS) {
+        timespec_get(&task->start, TIME_UTC);
+        if (thrd_create(&task->thread, api_loadTaskRun, task) != thrd_success) {
+            api_freeData(task->data);
+            error = E_MEMORY_ERROR;
         }
+    }
+
+    if (error != E_SUCCESS) {
+        allocator_free(allocator, task->data);
+        task->data = NULL;
+        fclose(task->file);
+        allocator_free(allocator, task);
     } else {
-        tPerson *temp = realloc(data->people.elems, (data->people.count + 1) * sizeof(tPerson));
+        *loadTask = task;
+    }
+
+    return error;
+}
+
+// Get the progress of a load
+void apiLoadTask_progress(tApiLoadTask *task, tApiLoadProgress *progress) {
+    assert(task != NULL);
+    assert(progress != NULL);
+
+    progress->bytesRead = atomic_load(&task->bytesRead);
+    progress->totalBytes = task->totalBytes;
+    progress->rowsApplied = atomic_load(&task->rowsApplied);
+    progress->rowsRejected = atomic_load(&task->rowsRejected);
+
+    if (atomic_load(&task->done)) {
+        progress->eta = 0;
+    } else if (progress->bytesRead == 0 || progress->totalBytes < progress->bytesRead) {
+        // NOTHING READ YET, OR THE SIZE IS NOT KNOWN
+        progress->eta = -1;
+    } else {
+        // THE REST OF THE FILE IS READ AT THE SAME RATE
+        double elapsed = api_elapsed(task->start);
+        progress->eta = elapsed * (double) (progress->totalBytes - progress->bytesRead) / (double) progress->bytesRead;
+    }
+}
+
+// Ask a load to stop
+void apiLoadTask_cancel(tApiLoadTask *task) {
+    assert(task != NULL);
+
+    atomic_store(&task->cancelled, true);
+}
+
+// Check if a load has ended
+bool apiLoadTask_done(tApiLoadTask *task) {
+    assert(task != NULL);
+
+    return atomic_load(&task->done);
+}
 
-        if (temp == NULL) {
+// Wait for a load to end and take the loaded data
+tApiError apiLoadTask_wait(tApiLoadTask *task, tApiData **data) {
+    assert(task != NULL);
+    assert(!task->waited);
+
+    task->waited = true;
+    thrd_join(task->thread, NULL);
+    fclose(task->file);
+    task->file = NULL;
+
+    if (task->error == E_SUCCESS && data != NULL) {
+        // NULL if the callback took it
+        *data = task->data;
+    } else {
+        if (task->data != NULL) {
+            api_freeData(task->data);
+            allocator_free(task->allocator, task->data);
+        }
+        if (data != NULL) {
+            *data = NULL;
+        }
+    }
+    task->data = NULL;
+
+    return task->error;
+}
+
+// Take the data loaded by a task
+tApiData *apiLoadTask_takeData(tApiLoadTask *task) {
+    assert(task != NULL);
+
+    tApiData *data = task->data;
+    task->data = NULL;
+
+    return data;
+}
+
+// Remove a task, waiting for its load to end if it was not waited for
+void apiLoadTask_free(tApiLoadTask *task) {
+    if (task == NULL) {
+        return;
+    }
+    if (!task->waited) {
+        apiLoadTask_wait(task, NULL);
+    }
+    allocator_free(task->allocator, task);
+}
+
+// Rows of a file being loaded in parallel
+typedef struct _tApiLoadRows {
+    char **lines;
+    tIngestKind *kinds;
+    int *shards;
+    tApiError *errors;
+    int count;
+    // Allocator of the rows, the one of the data being loaded
+    const tAllocator *allocator;
+} tApiLoadRows;
+
+// Worker of a parallel load, adding the rows of some kinds whose shard is assigned to it
+typedef struct _tApiLoadWorker {
+    tIngest *ingest;
+    tApiLoadRows *rows;
+    // Rows of these kinds are added
+    bool kinds[INGEST_INVALID];
+    int index;
+    int count;
+} tApiLoadWorker;
+
+// Add the rows of a worker. Rows of a shard are all added by the same worker in row order,
+// so the first of duplicated rows is kept, as in a sequential load
+static void api_loadWorker(tApiLoadWorker *worker) {
+    tApiLoadRows *rows = worker->rows;
+    tCSVEntry entry;
+
+    for (int row = 0; row < rows->count; row++) {
+        if (rows->kinds[row] == INGEST_INVALID || !worker->kinds[rows->kinds[row]]
+            || rows->shards[row] % worker->count != worker->index) {
+            continue;
+        }
+        csv_initEntryWithAllocator(&entry, rows->allocator);
+        csv_parseEntry(&entry, rows->lines[row], NULL);
+        rows->errors[row] = ingest_addEntry(worker->ingest, row, entry);
+        csv_freeEntry(&entry);
+    }
+}
+
+// Run the workers of a parallel load in the range [begin, end)
+static void api_loadTask(void *arg, int begin, int end) {
+    tApiLoadWorker *workers = (tApiLoadWorker *) arg;
+
+    for (int i = begin; i < end; i++) {
+        api_loadWorker(&workers[i]);
+    }
+}
+
+// Add the rows of the given kinds with as many workers as threads, run by the pool
+static void api_loadPhase(tIngest *ingest, tApiLoadRows *rows, tThreadPool *pool, int threads,
+                          const tIngestKind *kinds, int kindCount) {
+    tApiLoadWorker workers[INGEST_SHARDS];
+
+    for (int i = 0; i < threads; i++) {
+        workers[i].ingest = ingest;
+        workers[i].rows = rows;
+        for (int kind = 0; kind < INGEST_INVALID; kind++) {
+            workers[i].kinds[kind] = false;
+        }
+        for (int j = 0; j < kindCount; j++) {
+            workers[i].kinds[kinds[j]] = true;
+        }
+        workers[i].index = i;
+        workers[i].count = threads;
+    }
+
+    threadPool_parallelFor(pool, 0, threads, 1, api_loadTask, workers);
+}
+
+// Remove the rows of a file
+static void api_loadRowsFree(tApiLoadRows *rows) {
+    for (int row = 0; row < rows->count; row++) {
+        allocator_free(rows->allocator, rows->lines[row]);
+    }
+    allocator_free(rows->allocator, rows->lines);
+    allocator_free(rows->allocator, rows->kinds);
+    allocator_free(rows->allocator, rows->shards);
+    allocator_free(rows->allocator, rows->errors);
+    rows->lines = NULL;
+    rows->kinds = NULL;
+    rows->shards = NULL;
+    rows->errors = NULL;
+    rows->count = 0;
+}
+
+// Read the lines of a file and classify them by kind and shard, keeping them with the allocator
+static tApiError api_loadRows(FILE *fin, tApiLoadRows *rows, const tAllocator *allocator) {
+    char buffer[FILE_READ_BUFFER_SIZE];
+    int capacity = 0;
+
+    rows->lines = NULL;
+    rows->kinds = NULL;
+    rows->shards = NULL;
+    rows->errors = NULL;
+    rows->count = 0;
+    rows->allocator = allocator;
+
+    while (fgets(buffer, FILE_READ_BUFFER_SIZE, fin)) {
+        // Remove new line character
+        buffer[strcspn(buffer, "\n\r")] = '\0';
+
+        if (rows->count == capacity) {
+            capacity = capacity == 0 ? 64 : 2 * capacity;
+            char **lines = (char **) allocator_realloc(allocator, rows->lines, capacity * sizeof(char *));
+            if (lines != NULL) {
+                rows->lines = lines;
+            }
+            tIngestKind *kinds = (tIngestKind *) allocator_realloc(allocator, rows->kinds, capacity * sizeof(tIngestKind));
+            if (kinds != NULL) {
+                rows->kinds = kinds;
+            }
+            int *shards = (int *) allocator_realloc(allocator, rows->shards, capacity * sizeof(int));
+            if (shards != NULL) {
+                rows->shards = shards;
+            }
+            tApiError *errors = (tApiError *) allocator_realloc(allocator, rows->errors, capacity * sizeof(tApiError));
+            if (errors != NULL) {
+                rows->errors = errors;
+            }
+            if (lines == NULL || kinds == NULL || shards == NULL || errors == NULL) {
+                api_loadRowsFree(rows);
+                return E_MEMORY_ERROR;
+            }
+        }
+
+        rows->lines[rows->count] = allocator_strdup(allocator, buffer);
+        if (rows->lines[rows->count] == NULL) {
+            api_loadRowsFree(rows);
             return E_MEMORY_ERROR;
         }
+        rows->kinds[rows->count] = ingest_classify(buffer, &rows->shards[rows->count]);
+        rows->errors[rows->count] = rows->kinds[rows->count] == INGEST_INVALID ? E_INVALID_ENTRY_TYPE : E_SUCCESS;
+        rows->count++;
+    }
+
+    return E_SUCCESS;
+}
 
-        data->people.elems = temp;
+// Load data from a CSV file with many threads
+tApiError api_loadDataParallel(tApiData *data, const char *filename, bool reset, int threads, tApiLoadReport *report) {
+    static const tIngestKind peoplePhase[] = {INGEST_PERSON};
+    static const tIngestKind recordsPhase[] = {INGEST_SUBSCRIPTION, INGEST_FILM};
+    tApiLoadRows rows;
+    tIngest ingest;
+    tApiError error;
+    FILE *fin;
+
+    // Check input data
+    assert(data != NULL);
+    assert(filename != NULL);
+
+    if (threads < 1) {
+        threads = 1;
+    } else if (threads > INGEST_SHARDS) {
+        threads = INGEST_SHARDS;
+    }
+
+    // Reset current data
+    if (reset) {
+        error = api_resetData(data);
+        if (error != E_SUCCESS) {
+            return error;
+        }
+    }
+
+    // CLASSIFY THE ROWS
+    fin = fopen(filename, "r");
+    if (fin == NULL) {
+        return E_FILE_NOT_FOUND;
+    }
+    error = api_loadRows(fin, &rows, data->allocator);
+    fclose(fin);
+    if (error != E_SUCCESS) {
+        return error;
     }
 
-    data->people.elems[data->people.count] = newPerson;
-    data->people.count++;
+    // THE POOL OF THE DATA, OR ONE FOR THIS LOAD. WITHOUT THREADS THE ROWS ARE ADDED HERE
+    tThreadPool *pool = data->pool;
+    tThreadPool loadPool;
+    if (pool == NULL && threads > 1 && threadPool_init(&loadPool, threads) == E_SUCCESS) {
+        pool = &loadPool;
+    }
+
+    // SUBSCRIPTIONS NEED THE PEOPLE, FILMS DO NOT DEPEND ON ANYTHING
+    error = ingest_init(&ingest, data);
+    if (error == E_SUCCESS) {
+        api_loadPhase(&ingest, &rows, pool, threads, peoplePhase, 1);
+        api_loadPhase(&ingest, &rows, pool, threads, recordsPhase, 2);
+        error = ingest_finish(&ingest);
+    }
+
+    if (pool == &loadPool) {
+        threadPool_free(&loadPool);
+    }
+
+    // REJECTED ROWS IN ROW ORDER
+    if (error == E_SUCCESS && report != NULL) {
+        int count = 0;
+        for (int row = 0; row < rows.count; row++) {
+            if (rows.errors[row] != E_SUCCESS) {
+                count++;
+            }
+        }
+        if (count > 0) {
+            tApiLoadError *errors = (tApiLoadError *) allocator_realloc(report->allocator, report->errors, (report->count + count) * sizeof(tApiLoadError));
+            if (errors == NULL) {
+                error = E_MEMORY_ERROR;
+            } else {
+                report->errors = errors;
+                for (int row = 0; row < rows.count; row++) {
+                    if (rows.errors[row] != E_SUCCESS) {
+                        report->errors[report->count].row = row;
+                        report->errors[report->count].error = rows.errors[row];
+                        report->count++;
+                    }
+                }
+            }
+        }
+    }
+    api_loadRowsFree(&rows);
+
+    return error;
+}
+
+// Initialize a load report
+void apiLoadReport_init(tApiLoadReport *report, const tAllocator *allocator) {
+    assert(report != NULL);
+
+    report->errors = NULL;
+    report->count = 0;
+    report->allocator = allocator;
+}
+
+// Remove the data from a load report
+void apiLoadReport_free(tApiLoadReport *report) {
+    assert(report != NULL);
+
+    allocator_free(report->allocator, report->errors);
+    report->errors = NULL;
+    report->count = 0;
+}
+
+// 3b - Initialize the data structure
+tApiError api_initData(tApiData *data, const tAllocator *allocator) {
+    assert(data != NULL);
+
+    people_init(&data->people, allocator);
+    subscriptions_init(&data->subscriptions, allocator);
+    catalog_init(&data->catalog, allocator);
+    data->pool = NULL;
+    data->allocator = allocator;
 
     return E_SUCCESS;
 }
 
+// Run the API functions on the data with the threads of the pool
+void api_setThreadPool(tApiData *data, tThreadPool *pool) {
+    assert(data != NULL);
+
+    data->pool = pool;
+}
+
+// Copy the data from the source to an uninitialized destination
+tApiError api_cpyData(tApiData *destination, tApiData source) {
+    assert(destination != NULL);
+    tApiError error = api_initData(destination, source.allocator);
+    destination->pool = source.pool;
+
+    // PEOPLE BEFORE THE SUBSCRIPTIONS THAT REFER TO THEM
+    for (int i = 0; i < source.people.count && error == E_SUCCESS; i++) {
+        error = people_add(&destination->people, source.people.elems[i]);
+    }
+    for (int i = 0; i < source.subscriptions.count && error == E_SUCCESS; i++) {
+        error = subscriptions_add(&destination->subscriptions, destination->people, source.subscriptions.elems[i]);
+    }
+    // FILMS IN CATALOG ORDER, THE INDEXES ARE REBUILT
+    for (tFilmListNode *node = source.catalog.filmList.first; node != NULL && error == E_SUCCESS; node = node->next) {
+        error = catalog_add(&destination->catalog, node->elem);
+    }
+
+    if (error != E_SUCCESS) {
+        api_freeData(destination);
+    }
+
+    return error;
+}
+
+// 3c - Add a person into the data if it does not exist
+tApiError api_addPerson(tApiData *data, tCSVEntry entry) {
+    assert(data != NULL);
+    tPerson newPerson;
+
+    if (strcmp(entry.type, "PERSON") != 0) {
+        return E_INVALID_ENTRY_TYPE;
+    }
+    if (csv_numFields(entry) != NUM_FIELDS_PERSON) {
+        return E_INVALID_ENTRY_FORMAT;
+    }
+
+    person_parse(&newPerson, entry, data->allocator);
+
+    // The people keep their own copy of the fields
+    tApiError error = people_add(&data->people, newPerson);
+    person_free(&newPerson, data->allocator);
+
+    return error;
+}
+
 // 3d - Add a subscription if it does not exist
 tApiError api_addSubscription(tApiData *data, tCSVEntry entry) {
     assert(data != NULL);
@@ -136,28 +705,7 @@ tApiError api_addSubscription(tApiData *data, tCSVEntry entry) {
         return E_PERSON_NOT_FOUND;
     }
 
-    if (data->subscriptions.count == 0) {
-        // FIRST SUBSCRIPTION
-        data->subscriptions.elems = (tSubscription *) malloc(sizeof(tSubscription));
-
-        if (data->subscriptions.elems == NULL) {
-            return E_MEMORY_ERROR;
-        }
-    } else {
-        tSubscription *temp = realloc(data->subscriptions.elems,
-                                      (data->subscriptions.count + 1) * sizeof(tSubscription));
-
-        if (temp == NULL) {
-            return E_MEMORY_ERROR;
-        }
-
-        data->subscriptions.elems = temp;
-    }
-
-    data->subscriptions.elems[data->subscriptions.count] = newSubs;
-    data->subscriptions.count++;
-
-    return E_SUCCESS;
+    return subscriptions_append(&data->subscriptions, newSubs);
 }
 
 // 3e - Add a film if it does not exist
@@ -172,24 +720,18 @@ tApiError api_addFilm(tApiData *data, tCSVEntry entry) {
         return E_INVALID_ENTRY_FORMAT;
     }
 
-    film_parse(&newFilm, entry);
+    film_parse(&newFilm, entry, data->allocator);
 
-    if (filmList_find(data->catalog.filmList, newFilm.name) != NULL) {
+    if (catalog_find(&data->catalog, newFilm.name) != FILM_HANDLE_NONE) {
+        film_free(&newFilm, data->allocator);
         return E_FILM_DUPLICATED;
     }
 
-    tFilm *filmNode = (tFilm *) malloc(sizeof(tFilm));
-    if (filmNode == NULL) {
-        return E_MEMORY_ERROR;
-    }
-    *filmNode = newFilm;
-
-    filmList_add(&data->catalog.filmList, *filmNode);
-    if (newFilm.isFree) {
-        freeFilmList_add(&data->catalog.freeFilmList, filmNode);
-    }
+    // The catalog keeps its own copy and updates the indexes
+    tApiError error = catalog_add(&data->catalog, newFilm);
+    film_free(&newFilm, data->allocator);
 
-    return E_SUCCESS;
+    return error;
 }
 
 // 3f.1 - Get the number of people registered on the application
@@ -212,6 +754,14 @@ int api_freeFilmsCount(tApiData data) {
     return data.catalog.freeFilmList.count;
 }
 
+// Get the number of films of the given genre
+int api_genreFilmsCount(tApiData data, int genre) {
+    if (genre < GENRE_FIRST || genre >= GENRE_END) {
+        return 0;
+    }
+    return catalog_genreLen(data.catalog, (tFilmGenre) genre);
+}
+
 // 3g - Free all used memory
 tApiError api_freeData(tApiData *data) {
     assert(data != NULL);
@@ -237,14 +787,16 @@ tApiError api_addDataEntry(tApiData *data, tCSVEntry entry) {
     if (strcmp(entry.type, "PERSON") == 0) {
         tPerson newPerson;
 
-        person_parse(&newPerson, entry);
+        person_parse(&newPerson, entry, data->allocator);
         people_add(&data->people, newPerson);
+        person_free(&newPerson, data->allocator);
     }
     if (strcmp(entry.type, "FILM") == 0) {
         tFilm newFilm;
 
-        film_parse(&newFilm, entry);
+        film_parse(&newFilm, entry, data->allocator);
         catalog_add(&data->catalog, newFilm);
+        film_free(&newFilm, data->allocator);
     }
     if (strcmp(entry.type, "SUBSCRIPTION") == 0) {
         tSubscription newSubs;
@@ -260,7 +812,7 @@ tApiError api_addDataEntry(tApiData *data, tCSVEntry entry) {
 tApiError api_getSubscription(tApiData data, const int id, tCSVEntry *entry) {
     assert(data.subscriptions.elems != NULL);
     assert(entry != NULL);
-    csv_initEntry(entry); // EMPTY ENTRY
+    csv_initEntryWithAllocator(entry, data.allocator); // EMPTY ENTRY
     char buffer[FILE_READ_BUFFER_SIZE];
 
     const int found = subscriptions_find(data.subscriptions, id);
@@ -270,33 +822,33 @@ tApiError api_getSubscription(tApiData data, const int id, tCSVEntry *entry) {
     tSubscription subsFound = data.subscriptions.elems[found];
 
     // FORMAT ENTRY
-    entry->type = (char *) malloc(strlen("SUBSCRIPTION") + 1);
+    entry->type = (char *) allocator_alloc(data.allocator, strlen("SUBSCRIPTION") + 1);
     strcpy(entry->type, "SUBSCRIPTION");
     entry->numFields = NUM_FIELDS_SUBSCRIPTION;
-    entry->fields = (char **) malloc(sizeof(char *) * entry->numFields);
+    entry->fields = (char **) allocator_alloc(data.allocator, sizeof(char *) * entry->numFields);
     // ID
     snprintf(buffer, sizeof(buffer), "%d", subsFound.id);
-    entry->fields[0] = strdup(buffer);
+    entry->fields[0] = allocator_strdup(data.allocator, buffer);
     // DOCUMENT
-    entry->fields[1] = strdup(subsFound.document);
+    entry->fields[1] = allocator_strdup(data.allocator, subsFound.document);
     // START DATE
     date_format(subsFound.start_date, buffer);
-    entry->fields[2] = strdup(buffer);
+    entry->fields[2] = allocator_strdup(data.allocator, buffer);
     // END DATE
     date_format(subsFound.end_date, buffer);
-    entry->fields[3] = strdup(buffer);
+    entry->fields[3] = allocator_strdup(data.allocator, buffer);
     // PLAN
-    entry->fields[4] = strdup(subsFound.plan);
+    entry->fields[4] = allocator_strdup(data.allocator, subsFound.plan);
     // PRICE
     if (subsFound.price == (int) subsFound.price) {
         snprintf(buffer, sizeof(buffer), "%d", (int)subsFound.price);
     } else {
         snprintf(buffer, sizeof(buffer), "%.2f", subsFound.price);
     }
-    entry->fields[5] = strdup(buffer);
+    entry->fields[5] = allocator_strdup(data.allocator, buffer);
     // NUM DEVICES
     snprintf(buffer, sizeof(buffer), "%d", subsFound.numDevices);
-    entry->fields[6] = strdup(buffer);
+    entry->fields[6] = allocator_strdup(data.allocator, buffer);
 
     return E_SUCCESS;
 }
@@ -304,42 +856,145 @@ tApiError api_getSubscription(tApiData data, const int id, tCSVEntry *entry) {
 // 4b - Get film data
 tApiError api_getFilm(tApiData data, const char *name, tCSVEntry *entry) {
     assert(entry != NULL);
-    csv_initEntry(entry); // EMPTY ENTRY
+    csv_initEntryWithAllocator(entry, data.allocator); // EMPTY ENTRY
     char buffer[FILE_READ_BUFFER_SIZE];
 
-    // SEARCH IN LINKED TREE
-    tFilmListNode *node = data.catalog.filmList.first;
-    while (node != NULL && strcmp(node->elem.name, name) != 0) {
-        node = node->next;
-    }
-    if (node == NULL) {
+    // SEARCH IN THE CATALOG STORE
+    const tFilm *found = catalog_film(&data.catalog, catalog_find(&data.catalog, name));
+    if (found == NULL) {
         return E_FILM_NOT_FOUND;
     }
-    tFilm film = node->elem;
+    tFilm film = *found;
 
     // FORMAT ENTRY
-    entry->type = (char *) malloc(strlen("FILM") + 1);
+    entry->type = (char *) allocator_alloc(data.allocator, strlen("FILM") + 1);
     strcpy(entry->type, "FILM");
     entry->numFields = NUM_FIELDS_FILM;
-    entry->fields = (char **) malloc(sizeof(char *) * entry->numFields);
+    entry->fields = (char **) allocator_alloc(data.allocator, sizeof(char *) * entry->numFields);
 
     // NAME
-    entry->fields[0] = strdup(film.name);
+    entry->fields[0] = allocator_strdup(data.allocator, film.name);
     // DURATION
     snprintf(buffer, sizeof(buffer), "%02d:%02d", film.duration.hour, film.duration.minutes);
-    entry->fields[1] = strdup(buffer);
+    entry->fields[1] = allocator_strdup(data.allocator, buffer);
     // GENRE
     snprintf(buffer, sizeof(buffer), "%d", film.genre);
-    entry->fields[2] = strdup(buffer);
+    entry->fields[2] = allocator_strdup(data.allocator, buffer);
     // RELEASE DATE
     date_format(film.release, buffer);
-    entry->fields[3] = strdup(buffer);
+    entry->fields[3] = allocator_strdup(data.allocator, buffer);
     // RATING
     snprintf(buffer, sizeof(buffer), "%.1f", film.rating);
-    entry->fields[4] = strdup(buffer);
+    entry->fields[4] = allocator_strdup(data.allocator, buffer);
     // IS FREE
     snprintf(buffer, sizeof(buffer), "%d", film.isFree);
-    entry->fields[5] = strdup(buffer);
+    entry->fields[5] = allocator_strdup(data.allocator, buffer);
+
+    return E_SUCCESS;
+}
+
+// Write the subscription record into a caller buffer of the given size
+tApiError api_getSubscriptionRecord(tApiData data, const int id, char *buffer, int size, int *needed) {
+    assert(size == 0 || buffer != NULL);
+    assert(needed != NULL);
+
+    const int found = subscriptions_find(data.subscriptions, id);
+    if (found < 0) {
+        *needed = 0;
+        return E_SUBSCRIPTION_NOT_FOUND;
+    }
+
+    *needed = subscription_format(data.subscriptions.elems[found], buffer, size);
+
+    return *needed <= size ? E_SUCCESS : E_BUFFER_TOO_SMALL;
+}
+
+// Write the film record into a caller buffer of the given size
+tApiError api_getFilmRecord(tApiData data, const char *name, char *buffer, int size, int *needed) {
+    assert(size == 0 || buffer != NULL);
+    assert(needed != NULL);
+
+    const tFilm *found = catalog_film(&data.catalog, catalog_find(&data.catalog, name));
+    if (found == NULL) {
+        *needed = 0;
+        return E_FILM_NOT_FOUND;
+    }
+
+    *needed = film_format(*found, buffer, size);
+
+    return *needed <= size ? E_SUCCESS : E_BUFFER_TOO_SMALL;
+}
+
+// Fill a caller-owned fixed capacity entry with the subscription data
+tApiError api_getSubscriptionFixedEntry(tApiData data, const int id, tCSVFixedEntry *entry) {
+    assert(entry != NULL);
+    csv_initFixedEntry(entry); // EMPTY ENTRY
+    int needed;
+
+    tApiError error = api_getSubscriptionRecord(data, id, entry->line, CSV_FIXED_ENTRY_SIZE, &needed);
+    if (error != E_SUCCESS) {
+        entry->line[0] = '\0';
+        return error;
+    }
+    csv_parseFixedEntry(entry, "SUBSCRIPTION");
+
+    return E_SUCCESS;
+}
+
+// Fill a caller-owned fixed capacity entry with the film data
+tApiError api_getFilmFixedEntry(tApiData data, const char *name, tCSVFixedEntry *entry) {
+    assert(entry != NULL);
+    csv_initFixedEntry(entry); // EMPTY ENTRY
+    int needed;
+
+    tApiError error = api_getFilmRecord(data, name, entry->line, CSV_FIXED_ENTRY_SIZE, &needed);
+    if (error != E_SUCCESS) {
+        entry->line[0] = '\0';
+        return error;
+    }
+    csv_parseFixedEntry(entry, "FILM");
+
+    return E_SUCCESS;
+}
+
+// Films of a page and the entries they are stored in
+typedef struct _tApiFilmsPage {
+    const tFilm **page;
+    tCSVEntry *entries;
+    const tAllocator *allocator;
+} tApiFilmsPage;
+
+// Store the films of a page in the range [begin, end) into their entries
+static void api_formatFilms(void *arg, int begin, int end) {
+    tApiFilmsPage *formatted = (tApiFilmsPage *) arg;
+    char buffer[FILE_READ_BUFFER_SIZE];
+
+    for (int i = begin; i < end; i++) {
+        film_get(*formatted->page[i], buffer);
+        csv_initEntryWithAllocator(&formatted->entries[i], formatted->allocator);
+        csv_parseEntry(&formatted->entries[i], buffer, "FILM");
+    }
+}
+
+// Format a page of films as csv entries, with the thread pool if there is one
+static tApiError api_addFilmsPage(tThreadPool *pool, tCSVData *films, const tFilm **page, int count) {
+    tApiFilmsPage formatted;
+
+    if (count == 0) {
+        return E_SUCCESS;
+    }
+    tCSVEntry *entries = (tCSVEntry *) allocator_realloc(films->allocator, films->entries, (films->count + count) * sizeof(tCSVEntry));
+    if (entries == NULL) {
+        return E_MEMORY_ERROR;
+    }
+
+    // EACH ENTRY IS PARSED BY ONE TASK INTO ITS OWN SLOT
+    films->entries = entries;
+    formatted.page = page;
+    formatted.entries = entries + films->count;
+    formatted.allocator = films->allocator;
+    films->count += count;
+    threadPool_parallelFor(pool, 0, count, API_FORMAT_GRAIN, api_formatFilms, &formatted);
 
     return E_SUCCESS;
 }
@@ -347,110 +1002,358 @@ tApiError api_getFilm(tApiData data, const char *name, tCSVEntry *entry) {
 // 4c - Get free films data
 tApiError api_getFreeFilms(tApiData data, tCSVData *freeFilms) {
     assert(freeFilms != NULL);
-    csv_init(freeFilms); // EMPTY CSV DATA
+    csv_initWithAllocator(freeFilms, data.allocator); // EMPTY CSV DATA
 
-    char buffer[FILE_READ_BUFFER_SIZE];
-    tFilmListNode *node = data.catalog.filmList.first;
-
-    while (node != NULL) {
-        tFilm film = node->elem;
-
-        if (film.isFree) {
-            tCSVEntry entry;
-            csv_initEntry(&entry); // EMPTY ENTRY
-
-            // FORMAT ENTRY
-            entry.type = (char *) malloc(strlen("FILM") + 1);
-            strcpy(entry.type, "FILM");
-            entry.numFields = NUM_FIELDS_FILM;
-            entry.fields = (char **) malloc(sizeof(char *) * entry.numFields);
-
-            // NAME
-            entry.fields[0] = strdup(film.name);
-            // DURATION
-            snprintf(buffer, sizeof(buffer), "%02d:%02d", film.duration.hour, film.duration.minutes);
-            entry.fields[1] = strdup(buffer);
-            // GENRE
-            snprintf(buffer, sizeof(buffer), "%d", film.genre);
-            entry.fields[2] = strdup(buffer);
-            // RELEASE DATE
-            date_format(film.release, buffer);
-            entry.fields[3] = strdup(buffer);
-            // RATING
-            snprintf(buffer, sizeof(buffer), "%.1f", film.rating);
-            entry.fields[4] = strdup(buffer);
-            // IS FREE
-            snprintf(buffer, sizeof(buffer), "%d", film.isFree);
-            entry.fields[5] = strdup(buffer);
-
-            // ENTRY FIELDS TO STRING
-            snprintf(buffer, sizeof(buffer), "%s;%s;%s;%s;%s;%s",
-                     entry.fields[0], entry.fields[1], entry.fields[2],
-                     entry.fields[3], entry.fields[4], entry.fields[5]);
-            // ADD TO CSV DATA
-            csv_addStrEntry(freeFilms, buffer, entry.type);
+    int count = api_freeFilmsCount(data);
+    if (count == 0) {
+        return E_SUCCESS;
+    }
+
+    const tFilm **films = (const tFilm **) allocator_alloc(data.allocator, count * sizeof(tFilm *));
+    if (films == NULL) {
+        return E_MEMORY_ERROR;
+    }
+
+    // FORMAT THE VIEW OF THE FREE FILMS
+    count = api_getFreeFilmsView(data, films, count);
+    tApiError error = api_addFilmsPage(data.pool, freeFilms, films, count);
+
+    allocator_free(data.allocator, films);
+
+    return error;
+}
+
+// 4d - Get films data by genre
+tApiError api_getFilmsByGenre(tApiData data, tCSVData *films, int genre) {
+    assert(films != NULL);
+    csv_initWithAllocator(films, data.allocator); // EMPTY CSV DATA
+
+    int count = api_genreFilmsCount(data, genre);
+    if (count == 0) {
+        return E_SUCCESS;
+    }
+
+    const tFilm **genreFilms = (const tFilm **) allocator_alloc(data.allocator, count * sizeof(tFilm *));
+    if (genreFilms == NULL) {
+        return E_MEMORY_ERROR;
+    }
+
+    // FORMAT THE VIEW OF THE FILMS OF THE GENRE
+    count = api_getFilmsByGenreView(data, genre, genreFilms, count);
+    tApiError error = api_addFilmsPage(data.pool, films, genreFilms, count);
+
+    allocator_free(data.allocator, genreFilms);
+
+    return error;
+}
+
+// Get up to max free films as pointers into the catalog, valid until it is modified
+int api_getFreeFilmsView(tApiData data, const tFilm **films, int max) {
+    return catalog_freeFilmsView(&data.catalog, max, films);
+}
+
+// Get up to max films of a genre as pointers into the catalog, valid until it is modified
+int api_getFilmsByGenreView(tApiData data, int genre, const tFilm **films, int max) {
+    if (genre < GENRE_FIRST || genre >= GENRE_END) {
+        return 0;
+    }
+    return catalog_genreFilmsView(&data.catalog, (tFilmGenre) genre, max, films);
+}
+
+// Get the next page of up to pageSize free films, resuming after the cursor
+tApiError api_getFreeFilmsPage(tApiData data, tFilmListCursor *cursor, int pageSize, tCSVData *films) {
+    assert(cursor != NULL);
+    assert(pageSize >= 0);
+    assert(films != NULL);
+    csv_initWithAllocator(films, data.allocator); // EMPTY CSV DATA
+
+    // THE PAGE CAN NOT BE LONGER THAN THE LIST
+    if (pageSize > api_freeFilmsCount(data)) {
+        pageSize = api_freeFilmsCount(data);
+    }
+    const tFilm **page = NULL;
+    if (pageSize > 0) {
+        page = (const tFilm **) allocator_alloc(data.allocator, pageSize * sizeof(tFilm *));
+        if (page == NULL) {
+            return E_MEMORY_ERROR;
         }
+    }
 
-        node = node->next;
+    int count = catalog_freeFilmsPage(&data.catalog, cursor, pageSize, page);
+    if (count < 0) {
+        allocator_free(data.allocator, page);
+        return E_CURSOR_EXPIRED;
     }
+    tApiError error = api_addFilmsPage(data.pool, films, page, count);
+    allocator_free(data.allocator, page);
+
+    return error;
+}
+
+// Get the next page of up to pageSize films of a genre, resuming after the cursor
+tApiError api_getFilmsByGenrePage(tApiData data, int genre, tFilmListCursor *cursor, int pageSize, tCSVData *films) {
+    assert(cursor != NULL);
+    assert(pageSize >= 0);
+    assert(films != NULL);
+    csv_initWithAllocator(films, data.allocator); // EMPTY CSV DATA
+
+    if (genre < GENRE_FIRST || genre >= GENRE_END) {
+        return E_SUCCESS;
+    }
+
+    // THE PAGE CAN NOT BE LONGER THAN THE LIST
+    if (pageSize > api_genreFilmsCount(data, genre)) {
+        pageSize = api_genreFilmsCount(data, genre);
+    }
+    const tFilm **page = NULL;
+    if (pageSize > 0) {
+        page = (const tFilm **) allocator_alloc(data.allocator, pageSize * sizeof(tFilm *));
+        if (page == NULL) {
+            return E_MEMORY_ERROR;
+        }
+    }
+
+    int count = catalog_genreFilmsPage(&data.catalog, (tFilmGenre) genre, cursor, pageSize, page);
+    if (count < 0) {
+        allocator_free(data.allocator, page);
+        return E_CURSOR_EXPIRED;
+    }
+    tApiError error = api_addFilmsPage(data.pool, films, page, count);
+    allocator_free(data.allocator, page);
+
+    return error;
+}
+
+// Get the k best rated films of a genre (or FILM_GENRE_ANY), optionally only the free ones
+tApiError api_getTopRatedFilms(tApiData data, int k, int genre, bool freeOnly, tCSVData *films) {
+    assert(films != NULL);
+    csv_initWithAllocator(films, data.allocator); // EMPTY CSV DATA
+
+    if (k <= 0 || (genre != FILM_GENRE_ANY && (genre < GENRE_FIRST || genre >= GENRE_END))) {
+        return E_SUCCESS;
+    }
+    if (k > catalog_len(data.catalog)) {
+        k = catalog_len(data.catalog);
+    }
+
+    char buffer[FILE_READ_BUFFER_SIZE];
+    tFilmHandle *topFilms = (tFilmHandle *) allocator_alloc(data.allocator, k * sizeof(tFilmHandle));
+    if (topFilms == NULL) {
+        return E_MEMORY_ERROR;
+    }
+
+    // ONLY THE K FIRST FILMS OF THE INDEX
+    int count = catalog_topRated(&data.catalog, k, genre, freeOnly, topFilms);
+    for (int i = 0; i < count; i++) {
+        film_get(*catalog_film(&data.catalog, topFilms[i]), buffer);
+        csv_addStrEntry(films, buffer, "FILM");
+    }
+
+    allocator_free(data.allocator, topFilms);
 
     return E_SUCCESS;
 }
 
+// Get the number of films released between from and to, both included
+int api_releasedFilmsCount(tApiData data, tDate from, tDate to) {
+    return catalog_releaseCount(&data.catalog, from, to);
+}
 
-// 4d - Get films data by genre
-tApiError api_getFilmsByGenre(tApiData data, tCSVData *films, int genre) {
+// Get the next page of films released between from and to, both included, sorted by release date
+tApiError api_getFilmsByRelease(tApiData data, tDate from, tDate to, tReleaseCursor *cursor, int pageSize, tCSVData *films) {
+    assert(cursor != NULL);
     assert(films != NULL);
-    csv_init(films); // EMPTY CSV DATA
+    csv_initWithAllocator(films, data.allocator); // EMPTY CSV DATA
+
+    if (pageSize > catalog_len(data.catalog)) {
+        pageSize = catalog_len(data.catalog);
+    }
+    if (pageSize <= 0) {
+        return E_SUCCESS;
+    }
 
     char buffer[FILE_READ_BUFFER_SIZE];
-    tFilmListNode *node = data.catalog.filmList.first;
-
-    while (node != NULL) {
-        tFilm film = node->elem;
-
-        if (film.genre == genre) {
-            tCSVEntry entry;
-            csv_initEntry(&entry); // Init the entry
-
-            // FORMAT ENTRY
-            entry.type = (char *) malloc(strlen("FILM") + 1);
-            strcpy(entry.type, "FILM");
-            entry.numFields = NUM_FIELDS_FILM;
-            entry.fields = (char **) malloc(sizeof(char *) * entry.numFields);
-
-            // NAME
-            entry.fields[0] = strdup(film.name);
-            // DURATION
-            snprintf(buffer, sizeof(buffer), "%02d:%02d", film.duration.hour, film.duration.minutes);
-            entry.fields[1] = strdup(buffer);
-            // GENRE
-            snprintf(buffer, sizeof(buffer), "%d", film.genre);
-            entry.fields[2] = strdup(buffer);
-            // RELEASE DATE
-            date_format(film.release, buffer);
-            entry.fields[3] = strdup(buffer);
-            // RATING
-            snprintf(buffer, sizeof(buffer), "%.1f", film.rating);
-            entry.fields[4] = strdup(buffer);
-            // IS FREE
-            snprintf(buffer, sizeof(buffer), "%d", film.isFree);
-            entry.fields[5] = strdup(buffer);
-
-            // ENTRY FIELDS TO STRING
-            snprintf(buffer, sizeof(buffer), "%s;%s;%s;%s;%s;%s",
-                     entry.fields[0], entry.fields[1], entry.fields[2],
-                     entry.fields[3], entry.fields[4], entry.fields[5]);
-            // ADD TO CSV DATA
-            csv_addStrEntry(films, buffer, entry.type);
+    tFilmHandle *page = (tFilmHandle *) allocator_alloc(data.allocator, pageSize * sizeof(tFilmHandle));
+    if (page == NULL) {
+        return E_MEMORY_ERROR;
+    }
+
+    // ONLY THE FILMS OF THE PAGE
+    int count = catalog_releaseRange(&data.catalog, from, to, cursor, pageSize, page);
+    for (int i = 0; i < count; i++) {
+        film_get(*catalog_film(&data.catalog, page[i]), buffer);
+        csv_addStrEntry(films, buffer, "FILM");
+    }
+
+    allocator_free(data.allocator, page);
+
+    return E_SUCCESS;
+}
+
+// Get the films whose name contains the fragment, ignoring case, punctuation and extra spaces
+tApiError api_searchFilms(tApiData data, const char *fragment, tCSVData *films) {
+    assert(fragment != NULL);
+    assert(films != NULL);
+    csv_initWithAllocator(films, data.allocator); // EMPTY CSV DATA
+
+    int max = catalog_len(data.catalog);
+    if (max == 0) {
+        return E_SUCCESS;
+    }
+
+    char buffer[FILE_READ_BUFFER_SIZE];
+    tFilmHandle *found = (tFilmHandle *) allocator_alloc(data.allocator, max * sizeof(tFilmHandle));
+    if (found == NULL) {
+        return E_MEMORY_ERROR;
+    }
+
+    int count = catalog_search(&data.catalog, fragment, max, found);
+    if (count < 0) {
+        allocator_free(data.allocator, found);
+        return E_MEMORY_ERROR;
+    }
+    for (int i = 0; i < count; i++) {
+        film_get(*catalog_film(&data.catalog, found[i]), buffer);
+        csv_addStrEntry(films, buffer, "FILM");
+    }
+
+    allocator_free(data.allocator, found);
+
+    return E_SUCCESS;
+}
+
+// Get up to limit films whose name is at most maxDistance typos away from the query, closest and best rated first
+tApiError api_fuzzySearchFilms(tApiData data, const char *query, int maxDistance, int limit, tCSVData *films) {
+    assert(query != NULL);
+    assert(films != NULL);
+    csv_initWithAllocator(films, data.allocator); // EMPTY CSV DATA
+
+    if (limit > catalog_len(data.catalog)) {
+        limit = catalog_len(data.catalog);
+    }
+    if (limit <= 0 || maxDistance < 0) {
+        return E_SUCCESS;
+    }
+
+    char buffer[FILE_READ_BUFFER_SIZE];
+    tFilmHandle *found = (tFilmHandle *) allocator_alloc(data.allocator, limit * sizeof(tFilmHandle));
+    if (found == NULL) {
+        return E_MEMORY_ERROR;
+    }
+
+    int count = catalog_fuzzySearch(&data.catalog, query, maxDistance, limit, found);
+    if (count < 0) {
+        allocator_free(data.allocator, found);
+        return E_MEMORY_ERROR;
+    }
+    for (int i = 0; i < count; i++) {
+        film_get(*catalog_film(&data.catalog, found[i]), buffer);
+        csv_addStrEntry(films, buffer, "FILM");
+    }
+
+    allocator_free(data.allocator, found);
+
+    return E_SUCCESS;
+}
+
+// Get up to limit (at most TRIE_TOP_K) best rated films whose name starts with the prefix
+tApiError api_autocompleteFilms(tApiData data, const char *prefix, int limit, tCSVData *films) {
+    assert(prefix != NULL);
+    assert(films != NULL);
+    csv_initWithAllocator(films, data.allocator); // EMPTY CSV DATA
+
+    if (limit > TRIE_TOP_K) {
+        limit = TRIE_TOP_K;
+    }
+    if (limit <= 0) {
+        return E_SUCCESS;
+    }
+
+    char buffer[FILE_READ_BUFFER_SIZE];
+    tFilmHandle completions[TRIE_TOP_K];
+
+    int count = catalog_complete(&data.catalog, prefix, limit, completions);
+    if (count < 0) {
+        return E_MEMORY_ERROR;
+    }
+    for (int i = 0; i < count; i++) {
+        film_get(*catalog_film(&data.catalog, completions[i]), buffer);
+        csv_addStrEntry(films, buffer, "FILM");
+    }
+
+    return E_SUCCESS;
+}
+
+// Get the films whose handles are in the bitmap, ordered by handle
+tApiError api_getBitmapFilms(tApiData data, const tBitmap *bitmap, tCSVData *films) {
+    assert(bitmap != NULL);
+    assert(films != NULL);
+    csv_initWithAllocator(films, data.allocator); // EMPTY CSV DATA
+
+    char buffer[FILE_READ_BUFFER_SIZE];
+    tFilmHandle handles[FILM_COLUMN_BITS];
+    tFilmHandle from = 0;
+    int count;
+
+    // A FEW HANDLES AT A TIME
+    while ((count = bitmap_values(bitmap, from, FILM_COLUMN_BITS, handles)) > 0) {
+        for (int i = 0; i < count; i++) {
+            tFilm *film = catalog_film(&data.catalog, handles[i]);
+            if (film != NULL) {
+                film_get(*film, buffer);
+                csv_addStrEntry(films, buffer, "FILM");
+            }
         }
+        from = handles[count - 1] + 1;
+    }
+
+    return E_SUCCESS;
+}
+
+// Get the next page of films of a query, starting after the cursor and moving it to the last returned film
+tApiError api_queryFilms(tApiData data, const tFilmQuery *query, tFilmQueryCursor *cursor, tCSVData *films) {
+    assert(query != NULL);
+    assert(cursor != NULL);
+    assert(films != NULL);
+    csv_initWithAllocator(films, data.allocator); // EMPTY CSV DATA
+
+    // NO PAGE LONGER THAN THE CATALOG
+    tFilmQuery page = *query;
+    if (page.limit > catalog_len(data.catalog)) {
+        page.limit = catalog_len(data.catalog);
+    }
+    if (page.limit <= 0) {
+        return E_SUCCESS;
+    }
 
-        node = node->next;
+    char buffer[FILE_READ_BUFFER_SIZE];
+    tFilmHandle *found = (tFilmHandle *) allocator_alloc(data.allocator, page.limit * sizeof(tFilmHandle));
+    if (found == NULL) {
+        return E_MEMORY_ERROR;
     }
 
+    int count = catalog_query(&data.catalog, &page, cursor, found);
+    if (count < 0) {
+        allocator_free(data.allocator, found);
+        return E_MEMORY_ERROR;
+    }
+    for (int i = 0; i < count; i++) {
+        film_get(*catalog_film(&data.catalog, found[i]), buffer);
+        csv_addStrEntry(films, buffer, "FILM");
+    }
+
+    allocator_free(data.allocator, found);
+
     return E_SUCCESS;
 }
 
+// Get the number of films, average rating and total duration by genre, by release decade and by isFree
+tApiError api_getFilmStats(tApiData data, tFilmStats *stats) {
+    assert(stats != NULL);
+
+    return catalog_stats(&data.catalog, stats);
+}
+
 void date_format(const tDate date, char *buffer) {
     // dd/mm/yyyy -> BUFFER
     snprintf(buffer, 11, "%02d/%02d/%04d", date.day, date.month, date.year);
@@ -0,0 +1,615 @@
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include "bitmap.h"
+
+// Key of the container of a value
+#define BITMAP_KEY(value) ((value) >> 16)
+
+// Low bits of a value, stored inside its container
+#define BITMAP_LOW(value) ((value) & 0xFFFF)
+
+// Initialize an empty bitmap
+void bitmap_init(tBitmap* bitmap, const tAllocator* allocator) {
+    // Check preconditions
+    assert(bitmap != NULL);
+
+    bitmap->containers = NULL;
+    bitmap->count = 0;
+    bitmap->capacity = 0;
+    bitmap->allocator = allocator;
+}
+
+// Return the number of bits set in a word
+static int bitmap_bitCount(unsigned int bits) {
+    int count = 0;
+    for (; bits != 0; bits &= bits - 1)
+        count++;
+    return count;
+}
+
+// Return the position of the lowest bit set in a word, which must not be 0
+static int bitmap_lowestBit(unsigned int bits) {
+    int pos = 0;
+    for (; (bits & 1u) == 0; bits >>= 1)
+        pos++;
+    return pos;
+}
+
+// Initialize an empty sparse container
+static void container_init(tBitmapContainer* container, int key) {
+    container->key = key;
+    container->count = 0;
+    container->values = NULL;
+    container->capacity = 0;
+    container->bits = NULL;
+}
+
+// Remove the data from a container
+static void container_free(tBitmapContainer* container, const tAllocator* allocator) {
+    allocator_free(allocator, container->values);
+    allocator_free(allocator, container->bits);
+    container_init(container, container->key);
+}
+
+// Get the position of the first value of a sparse container not lower than low
+static int container_lowerBound(const tBitmapContainer* container, int low) {
+    int first = 0;
+    int last = container->count;
+
+    while (first < last) {
+        int mid = first + (last - first) / 2;
+        if (container->values[mid] < low)
+            first = mid + 1;
+        else
+            last = mid;
+    }
+
+    return first;
+}
+
+// Set in bits the values of a container
+static void container_setBits(const tBitmapContainer* container, unsigned int* bits) {
+    if (container->bits != NULL) {
+        for (int i = 0; i < BITMAP_CONTAINER_WORDS; i++)
+            bits[i] |= container->bits[i];
+    } else {
+        for (int i = 0; i < container->count; i++)
+            bits[container->values[i] / 32] |= 1u << (container->values[i] % 32);
+    }
+}
+
+// Store the values of a sparse container as bits
+static tApiError container_toDense(tBitmapContainer* container, const tAllocator* allocator) {
+    unsigned int *bits = (unsigned int *) allocator_calloc(allocator, BITMAP_CONTAINER_WORDS, sizeof(unsigned int));
+    if (bits == NULL)
+        return E_MEMORY_ERROR;
+
+    container_setBits(container, bits);
+    allocator_free(allocator, container->values);
+    container->values = NULL;
+    container->capacity = 0;
+    container->bits = bits;
+
+    return E_SUCCESS;
+}
+
+// Store the values of a dense container as a sorted array
+static tApiError container_toSparse(tBitmapContainer* container, const tAllocator* allocator) {
+    unsigned short *values = (unsigned short *) allocator_alloc(allocator, (container->count > 0 ? container->count : 1) * sizeof(unsigned short));
+    if (values == NULL)
+        return E_MEMORY_ERROR;
+
+    int count = 0;
+    for (int i = 0; i < BITMAP_CONTAINER_WORDS; i++) {
+        for (unsigned int bits = container->bits[i]; bits != 0; bits &= bits - 1)
+            values[count++] = (unsigned short) (i * 32 + bitmap_lowestBit(bits));
+    }
+
+    allocator_free(allocator, container->bits);
+    container->bits = NULL;
+    container->values = values;
+    container->capacity = container->count;
+
+    return E_SUCCESS;
+}
+
+// Finish a dense container built by an operation: count its values and make it sparse if they are few
+static tApiError container_finishDense(tBitmapContainer* container, const tAllocator* allocator) {
+    container->count = 0;
+    for (int i = 0; i < BITMAP_CONTAINER_WORDS; i++)
+        container->count += bitmap_bitCount(container->bits[i]);
+
+    return container->count <= BITMAP_ARRAY_MAX ? container_toSparse(container, allocator) : E_SUCCESS;
+}
+
+// Get memory for the bits of a new dense container, all cleared
+static tApiError container_allocBits(tBitmapContainer* container, const tAllocator* allocator) {
+    container->bits = (unsigned int *) allocator_calloc(allocator, BITMAP_CONTAINER_WORDS, sizeof(unsigned int));
+    return container->bits == NULL ? E_MEMORY_ERROR : E_SUCCESS;
+}
+
+// Get memory for up to count sorted values of a new sparse container
+static tApiError container_allocValues(tBitmapContainer* container, int count, const tAllocator* allocator) {
+    container->values = (unsigned short *) allocator_alloc(allocator, (count > 0 ? count : 1) * sizeof(unsigned short));
+    container->capacity = count;
+    return container->values == NULL ? E_MEMORY_ERROR : E_SUCCESS;
+}
+
+// Check if a container contains the low bits of a value
+static bool container_contains(const tBitmapContainer* container, int low) {
+    if (container->bits != NULL)
+        return (container->bits[low / 32] >> (low % 32)) & 1u;
+
+    int pos = container_lowerBound(container, low);
+    return pos < container->count && container->values[pos] == low;
+}
+
+// Copy the container src to dst
+static tApiError container_cpy(tBitmapContainer* dst, const tBitmapContainer* src, const tAllocator* allocator) {
+    container_init(dst, src->key);
+
+    if (src->bits != NULL) {
+        if (container_allocBits(dst, allocator) != E_SUCCESS)
+            return E_MEMORY_ERROR;
+        memcpy(dst->bits, src->bits, BITMAP_CONTAINER_WORDS * sizeof(unsigned int));
+    } else {
+        if (container_allocValues(dst, src->count, allocator) != E_SUCCESS)
+            return E_MEMORY_ERROR;
+        memcpy(dst->values, src->values, src->count * sizeof(unsigned short));
+    }
+    dst->count = src->count;
+
+    return E_SUCCESS;
+}
+
+// Store in result the values in a and in b
+static tApiError container_and(const tBitmapContainer* a, const tBitmapContainer* b, tBitmapContainer* result,
+                                const tAllocator* allocator) {
+    container_init(result, a->key);
+
+    if (a->bits != NULL && b->bits != NULL) {
+        if (container_allocBits(result, allocator) != E_SUCCESS)
+            return E_MEMORY_ERROR;
+        for (int i = 0; i < BITMAP_CONTAINER_WORDS; i++)
+            result->bits[i] = a->bits[i] & b->bits[i];
+        return container_finishDense(result, allocator);
+    }
+
+    // The sparse container bounds the result
+    if (a->bits != NULL) {
+        const tBitmapContainer *swap = a;
+        a = b;
+        b = swap;
+    }
+    if (container_allocValues(result, a->count < b->count ? a->count : b->count, allocator) != E_SUCCESS)
+        return E_MEMORY_ERROR;
+
+    if (b->bits != NULL) {
+        for (int i = 0; i < a->count; i++) {
+            if (container_contains(b, a->values[i]))
+                result->values[result->count++] = a->values[i];
+        }
+    } else {
+        for (int i = 0, j = 0; i < a->count && j < b->count;) {
+            if (a->values[i] < b->values[j]) {
+                i++;
+            } else if (a->values[i] > b->values[j]) {
+                j++;
+            } else {
+                result->values[result->count++] = a->values[i];
+                i++;
+                j++;
+            }
+        }
+    }
+
+    return E_SUCCESS;
+}
+
+// Store in result the values in a or in b
+static tApiError container_or(const tBitmapContainer* a, const tBitmapContainer* b, tBitmapContainer* result,
+                                const tAllocator* allocator) {
+    container_init(result, a->key);
+
+    if (a->bits == NULL && b->bits == NULL && a->count + b->count <= BITMAP_ARRAY_MAX) {
+        if (container_allocValues(result, a->count + b->count, allocator) != E_SUCCESS)
+            return E_MEMORY_ERROR;
+
+        int i = 0;
+        int j = 0;
+        while (i < a->count || j < b->count) {
+            if (j == b->count || (i < a->count && a->values[i] < b->values[j])) {
+                result->values[result->count++] = a->values[i++];
+            } else if (i == a->count || b->values[j] < a->values[i]) {
+                result->values[result->count++] = b->values[j++];
+            } else {
+                result->values[result->count++] = a->values[i];
+                i++;
+                j++;
+            }
+        }
+        return E_SUCCESS;
+    }
+
+    if (container_allocBits(result, allocator) != E_SUCCESS)
+        return E_MEMORY_ERROR;
+    container_setBits(a, result->bits);
+    container_setBits(b, result->bits);
+
+    return container_finishDense(result, allocator);
+}
+
+// Store in result the values in a and not in b
+static tApiError container_andNot(const tBitmapContainer* a, const tBitmapContainer* b, tBitmapContainer* result,
+                                const tAllocator* allocator) {
+    container_init(result, a->key);
+
+    if (a->bits != NULL) {
+        if (container_allocBits(result, allocator) != E_SUCCESS)
+            return E_MEMORY_ERROR;
+        memcpy(result->bits, a->bits, BITMAP_CONTAINER_WORDS * sizeof(unsigned int));
+
+        if (b->bits != NULL) {
+            for (int i = 0; i < BITMAP_CONTAINER_WORDS; i++)
+                result->bits[i] &= ~b->bits[i];
+        } else {
+            for (int i = 0; i < b->count; i++)
+                result->bits[b->values[i] / 32] &= ~(1u << (b->values[i] % 32));
+        }
+        return container_finishDense(result, allocator);
+    }
+
+    if (container_allocValues(result, a->count, allocator) != E_SUCCESS)
+        return E_MEMORY_ERROR;
+
+    if (b->bits != NULL) {
+        for (int i = 0; i < a->count; i++) {
+            if (!container_contains(b, a->values[i]))
+                result->values[result->count++] = a->values[i];
+        }
+    } else {
+        int j = 0;
+        for (int i = 0; i < a->count; i++) {
+            while (j < b->count && b->values[j] < a->values[i])
+                j++;
+            if (j == b->count || b->values[j] != a->values[i])
+                result->values[result->count++] = a->values[i];
+        }
+    }
+
+    return E_SUCCESS;
+}
+
+// Find the container of a key. If there is none, return -(position where it goes) - 1
+static int bitmap_find(const tBitmap* bitmap, int key) {
+    int first = 0;
+    int last = bitmap->count;
+
+    while (first < last) {
+        int mid = first + (last - first) / 2;
+        if (bitmap->containers[mid].key < key)
+            first = mid + 1;
+        else
+            last = mid;
+    }
+
+    if (first < bitmap->count && bitmap->containers[first].key == key)
+        return first;
+    return -first - 1;
+}
+
+// Make room for one more container
+static tApiError bitmap_reserve(tBitmap* bitmap) {
+    if (bitmap->count == bitmap->capacity) {
+        int capacity = bitmap->capacity == 0 ? 4 : bitmap->capacity * 2;
+        tBitmapContainer *containers = (tBitmapContainer *) allocator_realloc(bitmap->allocator, bitmap->containers, capacity * sizeof(tBitmapContainer));
+        if (containers == NULL)
+            return E_MEMORY_ERROR;
+        bitmap->containers = containers;
+        bitmap->capacity = capacity;
+    }
+    return E_SUCCESS;
+}
+
+// Add a container at the end of a bitmap being built in key order. Empty containers are dropped
+static tApiError bitmap_append(tBitmap* bitmap, tBitmapContainer* container) {
+    if (container->count == 0) {
+        container_free(container, bitmap->allocator);
+        return E_SUCCESS;
+    }
+    if (bitmap_reserve(bitmap) != E_SUCCESS) {
+        container_free(container, bitmap->allocator);
+        return E_MEMORY_ERROR;
+    }
+    bitmap->containers[bitmap->count++] = *container;
+
+    return E_SUCCESS;
+}
+
+// Append the result of a container operation, or release it if the operation failed
+static tApiError bitmap_appendResult(tBitmap* bitmap, tBitmapContainer* container, tApiError error) {
+    if (error != E_SUCCESS) {
+        container_free(container, bitmap->allocator);
+        return error;
+    }
+    return bitmap_append(bitmap, container);
+}
+
+// Add a value to the bitmap
+tApiError bitmap_add(tBitmap* bitmap, int value) {
+    // Check preconditions
+    assert(bitmap != NULL);
+    assert(value >= 0);
+
+    int low = BITMAP_LOW(value);
+    int pos = bitmap_find(bitmap, BITMAP_KEY(value));
+    if (pos < 0) {
+        // New container
+        if (bitmap_reserve(bitmap) != E_SUCCESS)
+            return E_MEMORY_ERROR;
+        pos = -pos - 1;
+        memmove(&bitmap->containers[pos + 1], &bitmap->containers[pos], (bitmap->count - pos) * sizeof(tBitmapContainer));
+        container_init(&bitmap->containers[pos], BITMAP_KEY(value));
+        bitmap->count++;
+    }
+
+    tBitmapContainer *container = &bitmap->containers[pos];
+    if (container_contains(container, low))
+        return E_SUCCESS;
+
+    if (container->bits == NULL && container->count == BITMAP_ARRAY_MAX) {
+        if (container_toDense(container, bitmap->allocator) != E_SUCCESS)
+            return E_MEMORY_ERROR;
+    }
+
+    if (container->bits != NULL) {
+        container->bits[low / 32] |= 1u << (low % 32);
+    } else {
+        if (container->count == container->capacity) {
+            int capacity = container->capacity == 0 ? 4 : container->capacity * 2;
+            if (capacity > BITMAP_ARRAY_MAX)
+                capacity = BITMAP_ARRAY_MAX;
+            unsigned short *values = (unsigned short *) allocator_realloc(bitmap->allocator, container->values, capacity * sizeof(unsigned short));
+            if (values == NULL) {
+                if (container->count == 0) {
+                    // Do not leave an empty container
+                    memmove(&bitmap->containers[pos], &bitmap->containers[pos + 1], (bitmap->count - pos - 1) * sizeof(tBitmapContainer));
+                    bitmap->count--;
+                }
+                return E_MEMORY_ERROR;
+            }
+            container->values = values;
+            container->capacity = capacity;
+        }
+        int at = container_lowerBound(container, low);
+        memmove(&container->values[at + 1], &container->values[at], (container->count - at) * sizeof(unsigned short));
+        container->values[at] = (unsigned short) low;
+    }
+    container->count++;
+
+    return E_SUCCESS;
+}
+
+// Remove a value from the bitmap, if it is there
+void bitmap_del(tBitmap* bitmap, int value) {
+    // Check preconditions
+    assert(bitmap != NULL);
+
+    if (value < 0)
+        return;
+
+    int low = BITMAP_LOW(value);
+    int pos = bitmap_find(bitmap, BITMAP_KEY(value));
+    if (pos < 0 || !container_contains(&bitmap->containers[pos], low))
+        return;
+
+    tBitmapContainer *container = &bitmap->containers[pos];
+    if (container->bits != NULL) {
+        container->bits[low / 32] &= ~(1u << (low % 32));
+        container->count--;
+        // Half the limit avoids converting back and forth around it. If there is no memory, it stays dense
+        if (container->count <= BITMAP_ARRAY_MAX / 2)
+            container_toSparse(container, bitmap->allocator);
+    } else {
+        int at = container_lowerBound(container, low);
+        memmove(&container->values[at], &container->values[at + 1], (container->count - at - 1) * sizeof(unsigned short));
+        container->count--;
+    }
+
+    if (container->count == 0) {
+        container_free(container, bitmap->allocator);
+        memmove(&bitmap->containers[pos], &bitmap->containers[pos + 1], (bitmap->count - pos - 1) * sizeof(tBitmapContainer));
+        bitmap->count--;
+    }
+}
+
+// Check if the bitmap contains a value
+bool bitmap_contains(const tBitmap* bitmap, int value) {
+    // Check preconditions
+    assert(bitmap != NULL);
+
+    if (value < 0)
+        return false;
+
+    int pos = bitmap_find(bitmap, BITMAP_KEY(value));
+    return pos >= 0 && container_contains(&bitmap->containers[pos], BITMAP_LOW(value));
+}
+
+// Return the number of values of the bitmap
+int bitmap_count(const tBitmap* bitmap) {
+    // Check preconditions
+    assert(bitmap != NULL);
+
+    int count = 0;
+    for (int i = 0; i < bitmap->count; i++)
+        count += bitmap->containers[i].count;
+
+    return count;
+}
+
+// Store in result the values in a and in b
+tApiError bitmap_and(const tBitmap* a, const tBitmap* b, tBitmap* result) {
+    // Check preconditions
+    assert(a != NULL);
+    assert(b != NULL);
+    assert(result != NULL);
+    assert(result != a && result != b);
+
+    tApiError error = E_SUCCESS;
+    tBitmapContainer container;
+
+    bitmap_free(result);
+
+    // Only the keys in both bitmaps
+    for (int i = 0, j = 0; i < a->count && j < b->count && error == E_SUCCESS;) {
+        if (a->containers[i].key < b->containers[j].key) {
+            i++;
+        } else if (a->containers[i].key > b->containers[j].key) {
+            j++;
+        } else {
+            error = container_and(&a->containers[i], &b->containers[j], &container, result->allocator);
+            error = bitmap_appendResult(result, &container, error);
+            i++;
+            j++;
+        }
+    }
+
+    if (error != E_SUCCESS)
+        bitmap_free(result);
+
+    return error;
+}
+
+// Store in result the values in a or in b
+tApiError bitmap_or(const tBitmap* a, const tBitmap* b, tBitmap* result) {
+    // Check preconditions
+    assert(a != NULL);
+    assert(b != NULL);
+    assert(result != NULL);
+    assert(result != a && result != b);
+
+    tApiError error = E_SUCCESS;
+    tBitmapContainer container;
+
+    bitmap_free(result);
+
+    for (int i = 0, j = 0; (i < a->count || j < b->count) && error == E_SUCCESS;) {
+        if (j == b->count || (i < a->count && a->containers[i].key < b->containers[j].key)) {
+            error = container_cpy(&container, &a->containers[i++], result->allocator);
+        } else if (i == a->count || b->containers[j].key < a->containers[i].key) {
+            error = container_cpy(&container, &b->containers[j++], result->allocator);
+        } else {
+            error = container_or(&a->containers[i], &b->containers[j], &container, result->allocator);
+            i++;
+            j++;
+        }
+        error = bitmap_appendResult(result, &container, error);
+    }
+
+    if (error != E_SUCCESS)
+        bitmap_free(result);
+
+    return error;
+}
+
+// Store in result the values in a and not in b
+tApiError bitmap_andNot(const tBitmap* a, const tBitmap* b, tBitmap* result) {
+    // Check preconditions
+    assert(a != NULL);
+    assert(b != NULL);
+    assert(result != NULL);
+    assert(result != a && result != b);
+
+    tApiError error = E_SUCCESS;
+    tBitmapContainer container;
+
+    bitmap_free(result);
+
+    for (int i = 0, j = 0; i < a->count && error == E_SUCCESS; i++) {
+        while (j < b->count && b->containers[j].key < a->containers[i].key)
+            j++;
+
+        if (j < b->count && b->containers[j].key == a->containers[i].key)
+            error = container_andNot(&a->containers[i], &b->containers[j], &container, result->allocator);
+        else
+            error = container_cpy(&container, &a->containers[i], result->allocator);
+        error = bitmap_appendResult(result, &container, error);
+    }
+
+    if (error != E_SUCCESS)
+        bitmap_free(result);
+
+    return error;
+}
+
+// Copy the bitmap src to dst
+tApiError bitmap_cpy(tBitmap* dst, const tBitmap* src) {
+    // Check preconditions
+    assert(dst != NULL);
+    assert(src != NULL);
+    assert(dst != src);
+
+    tApiError error = E_SUCCESS;
+    tBitmapContainer container;
+
+    bitmap_free(dst);
+
+    for (int i = 0; i < src->count && error == E_SUCCESS; i++) {
+        error = container_cpy(&container, &src->containers[i], dst->allocator);
+        error = bitmap_appendResult(dst, &container, error);
+    }
+
+    if (error != E_SUCCESS)
+        bitmap_free(dst);
+
+    return error;
+}
+
+// Get up to max values not lower than from, sorted
+int bitmap_values(const tBitmap* bitmap, int from, int max, int* result) {
+    // Check preconditions
+    assert(bitmap != NULL);
+    assert(max >= 0);
+    assert(result != NULL || max == 0);
+
+    if (from < 0)
+        from = 0;
+
+    int count = 0;
+    int pos = bitmap_find(bitmap, BITMAP_KEY(from));
+    if (pos < 0)
+        pos = -pos - 1;
+
+    for (; pos < bitmap->count && count < max; pos++) {
+        const tBitmapContainer *container = &bitmap->containers[pos];
+        int base = container->key << 16;
+        int low = container->key == BITMAP_KEY(from) ? BITMAP_LOW(from) : 0;
+
+        if (container->bits != NULL) {
+            for (int i = low / 32; i < BITMAP_CONTAINER_WORDS && count < max; i++) {
+                unsigned int bits = container->bits[i];
+                if (i == low / 32)
+                    bits &= ~0u << (low % 32);
+                for (; bits != 0 && count < max; bits &= bits - 1)
+                    result[count++] = base + i * 32 + bitmap_lowestBit(bits);
+            }
+        } else {
+            for (int i = container_lowerBound(container, low); i < container->count && count < max; i++)
+                result[count++] = base + container->values[i];
+        }
+    }
+
+    return count;
+}
+
+// Remove the data from a bitmap
+void bitmap_free(tBitmap* bitmap) {
+    // Check preconditions
+    assert(bitmap != NULL);
+
+    for (int i = 0; i < bitmap->count; i++)
+        container_free(&bitmap->containers[i], bitmap->allocator);
+    allocator_free(bitmap->allocator, bitmap->containers);
+    bitmap_init(bitmap, bitmap->allocator);
+}
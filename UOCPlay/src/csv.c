@@ -6,16 +6,28 @@
 
 // Initialize the tCSVData structure
 void csv_init(tCSVData* data) {
+    csv_initWithAllocator(data, NULL);
+}
+
+// Initialize the tCSVEntry structure
+void csv_initEntry(tCSVEntry* entry) {
+    csv_initEntryWithAllocator(entry, NULL);
+}
+
+// Initialize the tCSVData structure, whose entries are allocated with the allocator
+void csv_initWithAllocator(tCSVData* data, const tAllocator* allocator) {
     data->count = 0;
     data->isValid = false;
     data->entries = NULL;
+    data->allocator = allocator;
 }
 
-// Initialize the tCSVEntry structure
-void csv_initEntry(tCSVEntry* entry) {
+// Initialize the tCSVEntry structure, whose fields are allocated with the allocator
+void csv_initEntryWithAllocator(tCSVEntry* entry, const tAllocator* allocator) {
     entry->numFields = 0;    
     entry->fields = NULL;
     entry->type = NULL;
+    entry->allocator = allocator;
 }
 
 // Add a new entry to the CSV Data
@@ -24,11 +36,11 @@ void csv_addStrEntry(tCSVData* data, const char* entry, const char* type) {
     assert( entry != NULL );
     data->count++;
     if (data->count == 1) {
-        data->entries = (tCSVEntry*) malloc(sizeof(tCSVEntry));
+        data->entries = (tCSVEntry*) allocator_alloc(data->allocator, sizeof(tCSVEntry));
     } else {
-        data->entries = (tCSVEntry*) realloc(data->entries, data->count * sizeof(tCSVEntry));
+        data->entries = (tCSVEntry*) allocator_realloc(data->allocator, data->entries, data->count * sizeof(tCSVEntry));
     }
-    csv_initEntry(&(data->entries[data->count-1]));
+    csv_initEntryWithAllocator(&(data->entries[data->count-1]), data->allocator);
     csv_parseEntry(&(data->entries[data->count-1]), entry, type);
 }
 
@@ -46,34 +58,77 @@ void csv_parse(tCSVData* data, const char* input, const char* type) {
     pEnd = strchr(pStart, '\n');    
     while(pEnd != NULL && pEnd != pStart) {
         len = pEnd - pStart + 1;
-        line = (char*) malloc(len * sizeof(char));
+        line = (char*) allocator_alloc(data->allocator, len * sizeof(char));
         memset(line, 0, len * sizeof(char));
         strncpy(line, pStart, pEnd - pStart);
         // Add the new entry line
         csv_addStrEntry(data, line, type);
-        free(line);
+        allocator_free(data->allocator, line);
         pStart = pEnd + 1;
         pEnd = strchr(pStart, '\n');
     }
     pEnd = strchr(pStart, '\0');
     if (pEnd != NULL && pEnd != pStart) {
         len = pEnd - pStart + 1;
-        line = (char*) malloc(len * sizeof(char));
+        line = (char*) allocator_alloc(data->allocator, len * sizeof(char));
         memset(line, 0, len * sizeof(char));
         strncpy(line, pStart, pEnd - pStart);
         data->count++;
         if (data->count == 1) {
-            data->entries = (tCSVEntry*) malloc(sizeof(tCSVEntry));
+            data->entries = (tCSVEntry*) allocator_alloc(data->allocator, sizeof(tCSVEntry));
         } else {
-            data->entries = (tCSVEntry*) realloc(data->entries, data->count * sizeof(tCSVEntry));
+            data->entries = (tCSVEntry*) allocator_realloc(data->allocator, data->entries, data->count * sizeof(tCSVEntry));
         }
-        csv_initEntry(&(data->entries[data->count-1]));
+        csv_initEntryWithAllocator(&(data->entries[data->count-1]), data->allocator);
         csv_parseEntry(&(data->entries[data->count-1]), line, type);
-        free(line);
+        allocator_free(data->allocator, line);
     }
     data->isValid = true;
 }
 
+// Initialize a fixed capacity entry
+void csv_initFixedEntry(tCSVFixedEntry* entry) {
+    assert(entry != NULL);
+    entry->type[0] = '\0';
+    entry->line[0] = '\0';
+    entry->entry.numFields = 0;
+    entry->entry.type = entry->type;
+    entry->entry.fields = entry->fields;
+    entry->entry.allocator = NULL;
+}
+
+// Split in place the line stored in a fixed capacity entry
+bool csv_parseFixedEntry(tCSVFixedEntry* entry, const char* type) {
+    char *pStart, *pEnd;
+    int numFields = 0;
+
+    assert(entry != NULL);
+    assert(type != NULL);
+
+    strncpy(entry->type, type, CSV_FIXED_ENTRY_TYPE - 1);
+    entry->type[CSV_FIXED_ENTRY_TYPE - 1] = '\0';
+    entry->entry.type = entry->type;
+    entry->entry.fields = entry->fields;
+    entry->entry.numFields = 0;
+
+    pStart = entry->line;
+    while (pStart != NULL) {
+        if (numFields == CSV_FIXED_ENTRY_FIELDS) {
+            return false;
+        }
+        entry->fields[numFields++] = pStart;
+        pEnd = strchr(pStart, ';');
+        if (pEnd != NULL) {
+            *pEnd = '\0';
+            pEnd++;
+        }
+        pStart = pEnd;
+    }
+    entry->entry.numFields = numFields;
+
+    return true;
+}
+
 // Print the content of the CSV data structure
 void csv_print(tCSVData data) {
     int i;
@@ -112,7 +167,7 @@ void csv_parseEntry(tCSVEntry* entry, const char* input, const char* type) {
     // If the type of the entry is not provided, use the first field
     if(type != NULL) {
         len = strlen(type) + 1;
-        entry->type = (char*) malloc(len * sizeof(char));
+        entry->type = (char*) allocator_alloc(entry->allocator, len * sizeof(char));
         memset(entry->type, 0, len * sizeof(char));
         strncpy(entry->type, type, len);
         readType = false;
@@ -124,18 +179,18 @@ void csv_parseEntry(tCSVEntry* entry, const char* input, const char* type) {
         len = pEnd - pStart + 1;
         
         if(readType) {
-            entry->type = (char*) malloc(len * sizeof(char));
+            entry->type = (char*) allocator_alloc(entry->allocator, len * sizeof(char));
             memset(entry->type, 0, len * sizeof(char));
             strncpy(entry->type, pStart, pEnd - pStart);
             readType = false;
         } else {
             entry->numFields++;
             if (entry->numFields == 1) {
-                entry->fields = (char**) malloc(sizeof(char*));
+                entry->fields = (char**) allocator_alloc(entry->allocator, sizeof(char*));
             } else {
-                entry->fields = (char**) realloc(entry->fields, entry->numFields * sizeof(char*));
+                entry->fields = (char**) allocator_realloc(entry->allocator, entry->fields, entry->numFields * sizeof(char*));
             }                
-            entry->fields[entry->numFields - 1] = (char*) malloc(len * sizeof(char));
+            entry->fields[entry->numFields - 1] = (char*) allocator_alloc(entry->allocator, len * sizeof(char));
             memset(entry->fields[entry->numFields - 1], 0, len * sizeof(char));
             strncpy(entry->fields[entry->numFields - 1], pStart, pEnd - pStart);
         }
@@ -150,12 +205,12 @@ void csv_parseEntry(tCSVEntry* entry, const char* input, const char* type) {
         
         entry->numFields++;
         if (entry->numFields == 1) {
-            entry->fields = (char**) malloc(sizeof(char*));
+            entry->fields = (char**) allocator_alloc(entry->allocator, sizeof(char*));
         } else {
-            entry->fields = (char**) realloc(entry->fields, entry->numFields * sizeof(char*));
+            entry->fields = (char**) allocator_realloc(entry->allocator, entry->fields, entry->numFields * sizeof(char*));
         }        
         len = pEnd - pStart + 1;
-        entry->fields[entry->numFields - 1] = (char*) malloc(len * sizeof(char));
+        entry->fields[entry->numFields - 1] = (char*) allocator_alloc(entry->allocator, len * sizeof(char));
         memset(entry->fields[entry->numFields - 1], 0, len * sizeof(char));
         strncpy(entry->fields[entry->numFields - 1], pStart, pEnd - pStart);
     }
@@ -173,8 +228,8 @@ void csv_free(tCSVData* data) {
     for (i = 0; i < data->count; i++) {
         csv_freeEntry(&(data->entries[i]));
     }
-    free(data->entries);
-    csv_init(data);
+    allocator_free(data->allocator, data->entries);
+    csv_initWithAllocator(data, data->allocator);
 }
 
 // Remove all data from structure
@@ -183,16 +238,16 @@ void csv_freeEntry(tCSVEntry* entry) {
     
     if(entry->fields != NULL) {
         for(i = 0; i < entry->numFields; i++) {
-            free(entry->fields[i]);
+            allocator_free(entry->allocator, entry->fields[i]);
             entry->fields[i] = NULL;
         }
         
-        free(entry->fields);
+        allocator_free(entry->allocator, entry->fields);
     }
     if(entry->type != NULL) {
-        free(entry->type);
+        allocator_free(entry->allocator, entry->type);
     }
-    csv_initEntry(entry);
+    csv_initEntryWithAllocator(entry, entry->allocator);
 }
 
 // Get the number of entries
@@ -65,6 +65,35 @@ int date_cmp(tDate date1, tDate date2) {
     return 0;
 }
 
+// Return the number of days from 01/01/1970 to the date
+int date_toDays(tDate date) {
+    // Count years from March, so the leap day is the last day of the year
+    int year = date.month <= 2 ? date.year - 1 : date.year;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int yearOfEra = year - era * 400;
+    int dayOfYear = (153 * (date.month + (date.month > 2 ? -3 : 9)) + 2) / 5 + date.day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+
+    return era * 146097 + dayOfEra - 719468;
+}
+
+// Store in date the day that is the given number of days from 01/01/1970
+void date_fromDays(tDate *date, int days) {
+    assert(date != NULL);
+
+    // Inverse of date_toDays, with years starting in March
+    int shifted = days + 719468;
+    int era = (shifted >= 0 ? shifted : shifted - 146096) / 146097;
+    int dayOfEra = shifted - era * 146097;
+    int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int monthFromMarch = (5 * dayOfYear + 2) / 153;
+
+    date->day = dayOfYear - (153 * monthFromMarch + 2) / 5 + 1;
+    date->month = monthFromMarch < 10 ? monthFromMarch + 3 : monthFromMarch - 9;
+    date->year = yearOfEra + era * 400 + (date->month <= 2 ? 1 : 0);
+}
+
 // Parse a tDateTime from string information
 void dateTime_parse(tDateTime* dateTime, const char* date, const char* time) {
     // Check output data
@@ -3,9 +3,16 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
+#include <limits.h>
+#include <stdatomic.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FILM_SSE2
+#endif
 
 // Parse input from CSVEntry
-void film_parse(tFilm *data, tCSVEntry entry) {
+void film_parse(tFilm *data, tCSVEntry entry, const tAllocator *allocator) {
     // Check input data
     assert(data != NULL);
     assert(csv_numFields(entry) == NUM_FIELDS_FILM);
@@ -42,20 +49,19 @@ void film_parse(tFilm *data, tCSVEntry entry) {
     assert(isFree == 0 || isFree == 1);
 
     // Call film_init with the parsed data
-    film_init(data, name, duration, genre, release, rating, (bool) isFree);
+    film_init(data, name, duration, genre, release, rating, (bool) isFree, allocator);
 }
 
 // Initialize a film
 void film_init(tFilm *data, const char *name, tTime duration, tFilmGenre genre, tDate release, float rating,
-               bool isFree) {
+               bool isFree, const tAllocator *allocator) {
     // Check preconditions
     assert(data != NULL);
     assert(name != NULL);
 
     // Name
-    data->name = (char *) malloc((strlen(name) + 1) * sizeof(char));
+    data->name = allocator_strdup(allocator, name);
     assert(data->name != NULL);
-    strcpy(data->name, name);
 
     // Duration
     time_cpy(&data->duration, duration);
@@ -74,11 +80,11 @@ void film_init(tFilm *data, const char *name, tTime duration, tFilmGenre genre,
 }
 
 // Copy a film from src to dst
-void film_cpy(tFilm *dst, tFilm src) {
+void film_cpy(tFilm *dst, tFilm src, const tAllocator *allocator) {
     // Check preconditions
     assert(dst != NULL);
 
-    film_init(dst, src.name, src.duration, src.genre, src.release, src.rating, src.isFree);
+    film_init(dst, src.name, src.duration, src.genre, src.release, src.rating, src.isFree, allocator);
 }
 
 // Get film data using a string
@@ -93,25 +99,39 @@ void film_get(tFilm data, char *buffer) {
             data.isFree);
 }
 
+// Write the film record into a buffer of the given size
+int film_format(tFilm data, char *buffer, int size) {
+    assert(size == 0 || buffer != NULL);
+
+    return snprintf(buffer, size, "%s;%02d:%02d;%d;%02d/%02d/%04d;%.1f;%d",
+                    data.name,
+                    data.duration.hour, data.duration.minutes,
+                    data.genre,
+                    data.release.day, data.release.month, data.release.year,
+                    data.rating,
+                    data.isFree) + 1;
+}
+
 // Remove the data from a film
-void film_free(tFilm *data) {
+void film_free(tFilm *data, const tAllocator *allocator) {
     // Check preconditions
     assert(data != NULL);
 
     if (data->name != NULL) {
-        free(data->name);
+        allocator_free(allocator, data->name);
         data->name = NULL;
     }
 }
 
 // Initialize the films list
-tApiError filmList_init(tFilmList *list) {
+tApiError filmList_init(tFilmList *list, const tAllocator *allocator) {
     // Check preconditions
     assert(list != NULL);
 
     list->first = NULL;
     list->last = NULL;
     list->count = 0;
+    list->allocator = allocator;
 
     return E_SUCCESS;
 }
@@ -128,12 +148,15 @@ tApiError filmList_add(tFilmList *list, tFilm film) {
         return E_FILM_DUPLICATED;
 
     // Create the node
-    node = (tFilmListNode *) malloc(sizeof(tFilmListNode));
+    node = (tFilmListNode *) allocator_alloc(list->allocator, sizeof(tFilmListNode));
     assert(node != NULL);
 
     // Assign the properties of the nodes
-    film_cpy(&node->elem, film);
+    film_cpy(&node->elem, film, list->allocator);
     node->next = NULL;
+    node->prev = list->last;
+    node->freeNode = NULL;
+    node->handle = FILM_HANDLE_NONE;
 
     // Link the new node to the end of the list
     if (list->first == NULL)
@@ -179,11 +202,13 @@ tApiError filmList_del(tFilmList *list, const char *name) {
 
     if (list->last == node)
         list->last = prev;
+    else
+        node->next->prev = prev;
 
     list->count--;
 
-    film_free(&(node->elem));
-    free(node);
+    film_free(&(node->elem), list->allocator);
+    allocator_free(list->allocator, node);
 
     return E_SUCCESS;
 }
@@ -219,25 +244,26 @@ tApiError filmList_free(tFilmList *list) {
     while (node != NULL) {
         auxNode = node->next;
 
-        film_free(&(node->elem));
-        free(node);
+        film_free(&(node->elem), list->allocator);
+        allocator_free(list->allocator, node);
 
         node = auxNode;
     }
 
-    filmList_init(list);
+    filmList_init(list, list->allocator);
 
     return E_SUCCESS;
 }
 
 // Initialize the free films list
-tApiError freeFilmList_init(tFreeFilmList *list) {
+tApiError freeFilmList_init(tFreeFilmList *list, const tAllocator *allocator) {
     // Check preconditions
     assert(list != NULL);
 
     list->first = NULL;
     list->last = NULL;
     list->count = 0;
+    list->allocator = allocator;
 
     return E_SUCCESS;
 }
@@ -251,11 +277,13 @@ tApiError freeFilmList_add(tFreeFilmList *list, tFilm *film) {
     if (freeFilmList_find(*list, film->name) != NULL)
         return E_FILM_DUPLICATED;
 
-    tFreeFilmListNode *node = (tFreeFilmListNode *) malloc(sizeof(tFreeFilmListNode));
+    tFreeFilmListNode *node = (tFreeFilmListNode *) allocator_alloc(list->allocator, sizeof(tFreeFilmListNode));
     assert(node != NULL);
 
     node->elem = film; // Store the reference
     node->next = NULL;
+    node->prev = list->last;
+    node->handle = FILM_HANDLE_NONE;
 
     if (list->first == NULL)
         list->first = node;
@@ -293,8 +321,10 @@ tApiError freeFilmList_del(tFreeFilmList *list, const char *name) {
 
     if (list->last == node)
         list->last = prev;
+    else
+        node->next->prev = prev;
 
-    free(node);
+    allocator_free(list->allocator, node);
     list->count--;
 
     return E_SUCCESS;
@@ -330,199 +360,2120 @@ tApiError freeFilmsList_free(tFreeFilmList *list) {
 
     while (node != NULL) {
         auxNode = node->next;
-        free(node);
+        allocator_free(list->allocator, node);
         node = auxNode;
     }
 
-    freeFilmList_init(list);
+    freeFilmList_init(list, list->allocator);
 
     return E_SUCCESS;
 }
 
-// 2a - Initialize the films catalog
-tApiError catalog_init(tCatalog *catalog) {
-    catalog->filmList.count = 0;
-    catalog->filmList.first = NULL;
-    catalog->filmList.last = NULL;
+// Initialize a genre films list
+tApiError genreFilmList_init(tGenreFilmList *list) {
+    // Check preconditions
+    assert(list != NULL);
 
-    catalog->freeFilmList.count = 0;
-    catalog->freeFilmList.first = NULL;
-    catalog->freeFilmList.last = NULL;
+    list->first = FILM_HANDLE_NONE;
+    list->last = FILM_HANDLE_NONE;
+    list->count = 0;
 
     return E_SUCCESS;
 }
 
-// 2b - Add a new film to the catalog
-tApiError catalog_add(tCatalog *catalog, tFilm film) {
-    const bool existingFilmList = catalog->filmList.count > 0;
-    const tFilm *existingFilm = filmList_find(catalog->filmList, film.name);
-    if (existingFilmList && (existingFilm != NULL)) {
-        // FOUND IN CATALOG
-        return E_FILM_DUPLICATED;
+// Initialize a film index whose blocks come from the allocator
+static void filmIndex_init(tFilmIndex *index, const tAllocator *allocator) {
+    index->blocks = NULL;
+    index->blockCount = 0;
+    index->blockCapacity = 0;
+    index->count = 0;
+    index->allocator = allocator;
+}
+
+// Check if an entry goes after the given key and handle
+static bool filmIndex_after(const tFilmIndexEntry *entry, int key, tFilmHandle handle) {
+    return entry->key > key || (entry->key == key && entry->handle > handle);
+}
+
+// Return the position of the first entry after the given key and handle
+static tFilmIndexPos filmIndex_upperBound(const tFilmIndex *index, int key, tFilmHandle handle) {
+    tFilmIndexPos pos = {0, 0};
+    int low = 0, high = index->blockCount;
+
+    // First block whose last entry goes after the key
+    while (low < high) {
+        int mid = (low + high) / 2;
+        const tFilmIndexBlock *block = index->blocks[mid];
+        if (filmIndex_after(&block->elems[block->count - 1], key, handle))
+            high = mid;
+        else
+            low = mid + 1;
     }
-    // ALLOCATE NEW NODE
-    tFilmListNode *newNode = malloc(sizeof(tFilmListNode));
-    if (newNode == NULL) {
-        return E_MEMORY_ERROR;
+    pos.block = low;
+    if (low == index->blockCount)
+        return pos;
+
+    const tFilmIndexBlock *block = index->blocks[low];
+    low = 0;
+    high = block->count;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (filmIndex_after(&block->elems[mid], key, handle))
+            high = mid;
+        else
+            low = mid + 1;
     }
-    newNode->elem.name = malloc(strlen(film.name) + 1);
-    if (newNode->elem.name == NULL) {
-        free(newNode);
-        return E_MEMORY_ERROR;
+    pos.offset = low;
+
+    return pos;
+}
+
+// Check if a position is past the last entry
+static bool filmIndex_end(const tFilmIndex *index, tFilmIndexPos pos) {
+    return pos.block == index->blockCount;
+}
+
+// Return the entry at a position that is not past the end
+static const tFilmIndexEntry *filmIndex_entry(const tFilmIndex *index, tFilmIndexPos pos) {
+    return &index->blocks[pos.block]->elems[pos.offset];
+}
+
+// Move a position to the next entry
+static void filmIndex_next(const tFilmIndex *index, tFilmIndexPos *pos) {
+    pos->offset++;
+    if (pos->offset == index->blocks[pos->block]->count) {
+        pos->block++;
+        pos->offset = 0;
     }
-    // NEW NODE = FILM
-    strcpy(newNode->elem.name, film.name);
-    newNode->elem.duration = film.duration;
-    newNode->elem.genre = film.genre;
-    newNode->elem.release = film.release;
-    newNode->elem.rating = film.rating;
-    newNode->elem.isFree = film.isFree;
-    newNode->next = NULL; // ... -> [NEW NODE] -> NULL
+}
 
-    if (catalog->filmList.first == NULL) {
-        // FILM LIST EMPTY
-        catalog->filmList.first = newNode;
-        catalog->filmList.last = newNode;
-    } else {
-        // ... -> LAST -> [NEW NODE] -> NULL
-        catalog->filmList.last->next = newNode;
-        catalog->filmList.last = newNode;
+// Return the later of two positions
+static tFilmIndexPos filmIndex_later(tFilmIndexPos a, tFilmIndexPos b) {
+    return b.block > a.block || (b.block == a.block && b.offset > a.offset) ? b : a;
+}
+
+// Return the number of entries from first to last, last not included
+static int filmIndex_distance(const tFilmIndex *index, tFilmIndexPos first, tFilmIndexPos last) {
+    if (last.block < first.block || (last.block == first.block && last.offset <= first.offset))
+        return 0;
+    if (last.block == first.block)
+        return last.offset - first.offset;
+
+    int count = index->blocks[first.block]->count - first.offset + last.offset;
+    for (int block = first.block + 1; block < last.block; block++)
+        count += index->blocks[block]->count;
+
+    return count;
+}
+
+// Insert an empty block at the given place of the block list, which has room for it. NULL if there is no memory available
+static tFilmIndexBlock *filmIndex_insertBlock(tFilmIndex *index, int at) {
+    tFilmIndexBlock *block = (tFilmIndexBlock *) allocator_alloc(index->allocator, sizeof(tFilmIndexBlock));
+    if (block == NULL)
+        return NULL;
+
+    block->count = 0;
+    memmove(&index->blocks[at + 1], &index->blocks[at], (index->blockCount - at) * sizeof(tFilmIndexBlock *));
+    index->blocks[at] = block;
+    index->blockCount++;
+
+    return block;
+}
+
+// Remove a block from the block list
+static void filmIndex_removeBlock(tFilmIndex *index, int at) {
+    allocator_free(index->allocator, index->blocks[at]);
+    memmove(&index->blocks[at], &index->blocks[at + 1], (index->blockCount - at - 1) * sizeof(tFilmIndexBlock *));
+    index->blockCount--;
+}
+
+// Add an entry to a film index. Only the block of the entry is moved, split in two halves when it is full
+static tApiError filmIndex_add(tFilmIndex *index, int key, tFilmHandle handle) {
+    // Room for one more block, in case the entry needs it
+    if (index->blockCount == index->blockCapacity) {
+        int capacity = index->blockCapacity == 0 ? 4 : index->blockCapacity * 2;
+        tFilmIndexBlock **blocks = (tFilmIndexBlock **) allocator_realloc(index->allocator, index->blocks, capacity * sizeof(tFilmIndexBlock *));
+        if (blocks == NULL)
+            return E_MEMORY_ERROR;
+
+        index->blocks = blocks;
+        index->blockCapacity = capacity;
     }
-    catalog->filmList.count++;
 
-    if (film.isFree) {
-        // FREE FILM
-        tFreeFilmListNode *newFreeNode = malloc(sizeof(tFreeFilmListNode));
-        if (newFreeNode == NULL) {
-            free(newNode->elem.name);
-            free(newNode);
+    tFilmIndexPos pos = filmIndex_upperBound(index, key, handle);
 
+    if (filmIndex_end(index, pos) && pos.block > 0 && index->blocks[pos.block - 1]->count < FILM_INDEX_BLOCK_SIZE) {
+        // After every entry, with room in the last block
+        pos.block--;
+        pos.offset = index->blocks[pos.block]->count;
+    } else if (filmIndex_end(index, pos)) {
+        // After every entry, in a new last block so sorted loads fill their blocks
+        if (filmIndex_insertBlock(index, pos.block) == NULL)
+            return E_MEMORY_ERROR;
+    } else if (index->blocks[pos.block]->count == FILM_INDEX_BLOCK_SIZE) {
+        // Move the upper half of the full block to a new one
+        tFilmIndexBlock *upper = filmIndex_insertBlock(index, pos.block + 1);
+        if (upper == NULL)
             return E_MEMORY_ERROR;
-        }
-        newFreeNode->elem = &newNode->elem; // ONLY FILM POINTER
-        newFreeNode->next = NULL;
 
-        if (catalog->freeFilmList.first == NULL) {
-            catalog->freeFilmList.first = newFreeNode;
-            catalog->freeFilmList.last = newFreeNode;
-        } else {
-            catalog->freeFilmList.last->next = newFreeNode;
-            catalog->freeFilmList.last = newFreeNode;
+        tFilmIndexBlock *lower = index->blocks[pos.block];
+        int half = FILM_INDEX_BLOCK_SIZE / 2;
+        memcpy(upper->elems, &lower->elems[half], (FILM_INDEX_BLOCK_SIZE - half) * sizeof(tFilmIndexEntry));
+        upper->count = FILM_INDEX_BLOCK_SIZE - half;
+        lower->count = half;
+        if (pos.offset > half) {
+            pos.block++;
+            pos.offset -= half;
         }
-        catalog->freeFilmList.count++;
     }
 
+    tFilmIndexBlock *block = index->blocks[pos.block];
+    memmove(&block->elems[pos.offset + 1], &block->elems[pos.offset], (block->count - pos.offset) * sizeof(tFilmIndexEntry));
+    block->elems[pos.offset].key = key;
+    block->elems[pos.offset].handle = handle;
+    block->count++;
+    index->count++;
+
     return E_SUCCESS;
 }
 
-// 2c - Remove a film from the catalog
-tApiError catalog_del(tCatalog *catalog, const char *name) {
-    assert(catalog != NULL);
-    assert(name != NULL);
-
-    tFilmListNode *tempFirst = catalog->filmList.first;
-    tFilmListNode *tempLast = catalog->filmList.last;
-    tFilmListNode *prev = NULL;
-    tFilmListNode *current = tempFirst;
-    const tFilm *existingFilm = filmList_find(catalog->filmList, name);
+// Remove an entry from a film index
+static tApiError filmIndex_del(tFilmIndex *index, int key, tFilmHandle handle) {
+    // The entry is the first one after the previous handle
+    tFilmIndexPos pos = filmIndex_upperBound(index, key, handle - 1);
 
-    if (existingFilm == NULL) {
-        // FILM NOT FOUND
+    if (filmIndex_end(index, pos) || filmIndex_entry(index, pos)->key != key || filmIndex_entry(index, pos)->handle != handle)
         return E_FILM_NOT_FOUND;
+
+    tFilmIndexBlock *block = index->blocks[pos.block];
+    memmove(&block->elems[pos.offset], &block->elems[pos.offset + 1], (block->count - pos.offset - 1) * sizeof(tFilmIndexEntry));
+    block->count--;
+    index->count--;
+
+    if (block->count == 0) {
+        filmIndex_removeBlock(index, pos.block);
+    } else if (pos.block + 1 < index->blockCount && block->count + index->blocks[pos.block + 1]->count <= FILM_INDEX_BLOCK_SIZE / 2) {
+        // Join the next block when both fit in half a block, so removals do not leave many small blocks
+        tFilmIndexBlock *next = index->blocks[pos.block + 1];
+        memcpy(&block->elems[block->count], next->elems, next->count * sizeof(tFilmIndexEntry));
+        block->count += next->count;
+        filmIndex_removeBlock(index, pos.block + 1);
     }
-    if (tempFirst == NULL) {
-        // EMPTY FILM LIST
-        catalog->filmList.last = NULL;
 
-        return E_SUCCESS;
+    return E_SUCCESS;
+}
+
+// Remove all the entries of a film index
+static void filmIndex_free(tFilmIndex *index) {
+    for (int block = 0; block < index->blockCount; block++)
+        allocator_free(index->allocator, index->blocks[block]);
+    allocator_free(index->allocator, index->blocks);
+
+    filmIndex_init(index, index->allocator);
+}
+
+_Static_assert(sizeof(float) == sizeof(int), "rating keys are the bits of the rating");
+
+// Return the key of a rating in the rating index, smaller for better ratings
+static int ratingIndex_key(float rating) {
+    int bits;
+
+    // Adding zero turns -0.0 into 0.0, so both get the same key
+    rating += 0.0f;
+    memcpy(&bits, &rating, sizeof(bits));
+
+    // Negative floats sort backwards as integers, then reverse the whole order
+    if (bits < 0)
+        bits ^= INT_MAX;
+
+    return ~bits;
+}
+
+// Initialize a rating index
+tApiError ratingIndex_init(tRatingIndex *index, const tAllocator *allocator) {
+    // Check preconditions
+    assert(index != NULL);
+
+    filmIndex_init(index, allocator);
+
+    return E_SUCCESS;
+}
+
+// Add a film to the rating index
+tApiError ratingIndex_add(tRatingIndex *index, float rating, tFilmHandle handle) {
+    // Check preconditions
+    assert(index != NULL);
+    assert(handle != FILM_HANDLE_NONE);
+
+    return filmIndex_add(index, ratingIndex_key(rating), handle);
+}
+
+// Remove a film from the rating index
+tApiError ratingIndex_del(tRatingIndex *index, float rating, tFilmHandle handle) {
+    // Check preconditions
+    assert(index != NULL);
+
+    return filmIndex_del(index, ratingIndex_key(rating), handle);
+}
+
+// Remove all the references from the rating index
+tApiError ratingIndex_free(tRatingIndex *index) {
+    // Check preconditions
+    assert(index != NULL);
+
+    filmIndex_free(index);
+
+    return E_SUCCESS;
+}
+
+// Initialize a release date index
+tApiError releaseIndex_init(tReleaseIndex *index, const tAllocator *allocator) {
+    // Check preconditions
+    assert(index != NULL);
+
+    filmIndex_init(index, allocator);
+
+    return E_SUCCESS;
+}
+
+// Add a film to the release date index
+tApiError releaseIndex_add(tReleaseIndex *index, tDate release, tFilmHandle handle) {
+    // Check preconditions
+    assert(index != NULL);
+    assert(handle != FILM_HANDLE_NONE);
+
+    return filmIndex_add(index, date_toDays(release), handle);
+}
+
+// Remove a film from the release date index
+tApiError releaseIndex_del(tReleaseIndex *index, tDate release, tFilmHandle handle) {
+    // Check preconditions
+    assert(index != NULL);
+
+    return filmIndex_del(index, date_toDays(release), handle);
+}
+
+// Remove all the references from the release date index
+tApiError releaseIndex_free(tReleaseIndex *index) {
+    // Check preconditions
+    assert(index != NULL);
+
+    filmIndex_free(index);
+
+    return E_SUCCESS;
+}
+
+// Initialize a cursor to the start of a release date range
+void releaseCursor_init(tReleaseCursor *cursor) {
+    // Check preconditions
+    assert(cursor != NULL);
+
+    cursor->day = INT_MIN;
+    cursor->handle = FILM_HANDLE_NONE;
+}
+
+// Initialize the film store
+tApiError filmStore_init(tFilmStore *store, const tAllocator *allocator) {
+    // Check preconditions
+    assert(store != NULL);
+
+    store->slots = NULL;
+    store->capacity = 0;
+    store->used = 0;
+    store->holes = NULL;
+    store->holeCount = 0;
+    store->slotOf = NULL;
+    store->handleCount = 0;
+    store->freeHandles = NULL;
+    store->freeHandleCount = 0;
+    store->allocator = allocator;
+
+    return E_SUCCESS;
+}
+
+// Remove all the films of the store
+tApiError filmStore_free(tFilmStore *store) {
+    // Check preconditions
+    assert(store != NULL);
+
+    // Names are owned by the catalog arena
+    allocator_free(store->allocator, store->slots);
+    allocator_free(store->allocator, store->holes);
+    allocator_free(store->allocator, store->slotOf);
+    allocator_free(store->allocator, store->freeHandles);
+
+    filmStore_init(store, store->allocator);
+
+    return E_SUCCESS;
+}
+
+// Return the node of a film in the store
+static tFilmListNode *catalog_node(const tCatalog *catalog, tFilmHandle handle) {
+    assert(handle >= 0 && handle < catalog->store.handleCount);
+    assert(catalog->store.slotOf[handle] >= 0);
+
+    return &catalog->store.slots[catalog->store.slotOf[handle]];
+}
+
+// Point the catalog lists to the nodes at their new slots. Nodes keep their handles,
+// and the old nodes referenced by the lists must still be readable
+static void catalog_relink(tCatalog *catalog, tFilmListNode *nodes, int count) {
+    tFilmStore *store = &catalog->store;
+    tFreeFilmListNode *freeNode;
+
+    for (int slot = 0; slot < count; slot++) {
+        if (nodes[slot].handle == FILM_HANDLE_NONE)
+            continue;
+        if (nodes[slot].next != NULL)
+            nodes[slot].next = &store->slots[store->slotOf[nodes[slot].next->handle]];
+        if (nodes[slot].prev != NULL)
+            nodes[slot].prev = &store->slots[store->slotOf[nodes[slot].prev->handle]];
     }
-    // FREE FILM
-    if (existingFilm->isFree) {
-        freeFilmList_del(&catalog->freeFilmList, name);
+
+    if (catalog->filmList.first != NULL) {
+        catalog->filmList.first = &store->slots[store->slotOf[catalog->filmList.first->handle]];
+        catalog->filmList.last = &store->slots[store->slotOf[catalog->filmList.last->handle]];
     }
-    //ONE NODE
-    if (tempFirst == tempLast) {
-        catalog->filmList.first = NULL;
-        catalog->filmList.last = NULL;
-        catalog->filmList.count = 0;
 
-        free(tempFirst->elem.name);
-        free(tempFirst);
+    for (freeNode = catalog->freeFilmList.first; freeNode != NULL; freeNode = freeNode->next) {
+        freeNode->elem = &store->slots[store->slotOf[freeNode->handle]].elem;
+    }
+}
 
-        return E_SUCCESS;
+// Number of words of a column bitmap for the given number of handles
+#define COLUMN_WORDS(capacity) (((capacity) + FILM_COLUMN_BITS - 1) / FILM_COLUMN_BITS)
+
+// Grow the columns to the given number of handles. New positions are zeroed
+static tApiError catalog_growColumns(tCatalog *catalog, int capacity) {
+    tFilmColumns *columns = &catalog->columns;
+    int oldCapacity = columns->capacity;
+    int words = COLUMN_WORDS(capacity);
+    int oldWords = COLUMN_WORDS(oldCapacity);
+
+    // Whole words, so the filter sweeps never check for a partial one
+    capacity = words * FILM_COLUMN_BITS;
+
+    // Arrays already grown keep their new size if a later one fails
+    unsigned char *genre = (unsigned char *) allocator_realloc(catalog->allocator, columns->genre, capacity * sizeof(unsigned char));
+    if (genre == NULL)
+        return E_MEMORY_ERROR;
+    columns->genre = genre;
+    float *rating = (float *) allocator_realloc(catalog->allocator, columns->rating, capacity * sizeof(float));
+    if (rating == NULL)
+        return E_MEMORY_ERROR;
+    columns->rating = rating;
+    int *release = (int *) allocator_realloc(catalog->allocator, columns->release, capacity * sizeof(int));
+    if (release == NULL)
+        return E_MEMORY_ERROR;
+    columns->release = release;
+    int *duration = (int *) allocator_realloc(catalog->allocator, columns->duration, capacity * sizeof(int));
+    if (duration == NULL)
+        return E_MEMORY_ERROR;
+    columns->duration = duration;
+    unsigned int *isFree = (unsigned int *) allocator_realloc(catalog->allocator, columns->isFree, words * sizeof(unsigned int));
+    if (isFree == NULL)
+        return E_MEMORY_ERROR;
+    columns->isFree = isFree;
+    unsigned int *live = (unsigned int *) allocator_realloc(catalog->allocator, columns->live, words * sizeof(unsigned int));
+    if (live == NULL)
+        return E_MEMORY_ERROR;
+    columns->live = live;
+
+    memset(&genre[oldCapacity], 0, (capacity - oldCapacity) * sizeof(unsigned char));
+    memset(&rating[oldCapacity], 0, (capacity - oldCapacity) * sizeof(float));
+    memset(&release[oldCapacity], 0, (capacity - oldCapacity) * sizeof(int));
+    memset(&duration[oldCapacity], 0, (capacity - oldCapacity) * sizeof(int));
+    memset(&isFree[oldWords], 0, (words - oldWords) * sizeof(unsigned int));
+    memset(&live[oldWords], 0, (words - oldWords) * sizeof(unsigned int));
+    columns->capacity = capacity;
+
+    return E_SUCCESS;
+}
+
+// Store the filtered fields of a film in the columns and mark its handle in use
+static void catalog_columnsSet(tCatalog *catalog, tFilmHandle handle, const tFilm *film) {
+    tFilmColumns *columns = &catalog->columns;
+    unsigned int bit = 1u << (handle % FILM_COLUMN_BITS);
+
+    columns->genre[handle] = (unsigned char) film->genre;
+    columns->rating[handle] = film->rating;
+    columns->release[handle] = date_toDays(film->release);
+    columns->duration[handle] = film->duration.hour * 60 + film->duration.minutes;
+    if (film->isFree)
+        columns->isFree[handle / FILM_COLUMN_BITS] |= bit;
+    else
+        columns->isFree[handle / FILM_COLUMN_BITS] &= ~bit;
+    columns->live[handle / FILM_COLUMN_BITS] |= bit;
+}
+
+// Mark the handle of a removed film as not in use
+static void catalog_columnsClear(tCatalog *catalog, tFilmHandle handle) {
+    unsigned int bit = 1u << (handle % FILM_COLUMN_BITS);
+
+    catalog->columns.isFree[handle / FILM_COLUMN_BITS] &= ~bit;
+    catalog->columns.live[handle / FILM_COLUMN_BITS] &= ~bit;
+}
+
+// Double the capacity of the store, moving the films to a new array
+static tApiError catalog_growStore(tCatalog *catalog) {
+    tFilmStore *store = &catalog->store;
+    int capacity = store->capacity == 0 ? 16 : store->capacity * 2;
+
+    // Handles in use are never more than the films, so all the arrays share the capacity
+    tFilmListNode *slots = (tFilmListNode *) allocator_alloc(store->allocator, capacity * sizeof(tFilmListNode));
+    int *holes = (int *) allocator_realloc(store->allocator, store->holes, capacity * sizeof(int));
+    if (holes != NULL)
+        store->holes = holes;
+    int *slotOf = (int *) allocator_realloc(store->allocator, store->slotOf, capacity * sizeof(int));
+    if (slotOf != NULL)
+        store->slotOf = slotOf;
+    tFilmHandle *freeHandles = (tFilmHandle *) allocator_realloc(store->allocator, store->freeHandles, capacity * sizeof(tFilmHandle));
+    if (freeHandles != NULL)
+        store->freeHandles = freeHandles;
+
+    if (slots == NULL || holes == NULL || slotOf == NULL || freeHandles == NULL) {
+        allocator_free(store->allocator, slots);
+        return E_MEMORY_ERROR;
+    }
+    if (catalog_growColumns(catalog, capacity) != E_SUCCESS) {
+        allocator_free(store->allocator, slots);
+        return E_MEMORY_ERROR;
     }
-    // FIRST NODE
-    if (strcmp(existingFilm->name, tempFirst->elem.name) == 0) {
-        // (FIRST) [FIRST.NEXT] -> ...
-        catalog->filmList.first = catalog->filmList.first->next;
 
-        free(tempFirst->elem.name);
-        free(tempFirst);
-        catalog->filmList.count--;
+    tFilmListNode *oldSlots = store->slots;
+    if (store->used > 0)
+        memcpy(slots, oldSlots, store->used * sizeof(tFilmListNode));
+    store->slots = slots;
+    store->capacity = capacity;
 
-        return E_SUCCESS;
+    catalog_relink(catalog, slots, store->used);
+    allocator_free(store->allocator, oldSlots);
+
+    return E_SUCCESS;
+}
+
+// Return the rating bitmap of a film
+static int catalog_ratingBucket(float rating) {
+    int bucket = (int) (rating / FILM_RATING_BUCKET_SIZE);
+    if (bucket < 0)
+        return 0;
+    return bucket < FILM_RATING_BUCKETS ? bucket : FILM_RATING_BUCKETS - 1;
+}
+
+// Remove a film from the predicate bitmaps. Bitmaps without it are not changed
+static void catalog_bitmapsDel(tCatalog *catalog, tFilmHandle handle, const tFilm *film) {
+    bitmap_del(&catalog->filmsBitmap, handle);
+    bitmap_del(&catalog->genreBitmap[film->genre], handle);
+    bitmap_del(&catalog->freeBitmap, handle);
+    bitmap_del(&catalog->ratingBitmap[catalog_ratingBucket(film->rating)], handle);
+}
+
+// Add a film to the predicate bitmaps. If there is no memory available, none of them is changed
+static tApiError catalog_bitmapsAdd(tCatalog *catalog, tFilmHandle handle, const tFilm *film) {
+    tApiError error = bitmap_add(&catalog->filmsBitmap, handle);
+    if (error == E_SUCCESS)
+        error = bitmap_add(&catalog->genreBitmap[film->genre], handle);
+    if (error == E_SUCCESS && film->isFree)
+        error = bitmap_add(&catalog->freeBitmap, handle);
+    if (error == E_SUCCESS)
+        error = bitmap_add(&catalog->ratingBitmap[catalog_ratingBucket(film->rating)], handle);
+
+    if (error != E_SUCCESS)
+        catalog_bitmapsDel(catalog, handle, film);
+
+    return error;
+}
+
+// Take a slot and a handle for a new film. NULL if there is no memory available
+static tFilmListNode *catalog_allocNode(tCatalog *catalog) {
+    tFilmStore *store = &catalog->store;
+    tFilmHandle handle;
+    int slot;
+
+    if (store->holeCount == 0 && store->used == store->capacity) {
+        if (catalog_growStore(catalog) != E_SUCCESS)
+            return NULL;
+    }
+
+    // Reuse the holes left by removed films
+    if (store->holeCount > 0)
+        slot = store->holes[--store->holeCount];
+    else
+        slot = store->used++;
+
+    if (store->freeHandleCount > 0)
+        handle = store->freeHandles[--store->freeHandleCount];
+    else
+        handle = store->handleCount++;
+
+    store->slotOf[handle] = slot;
+    store->slots[slot].handle = handle;
+
+    return &store->slots[slot];
+}
+
+static void catalog_packNames(tCatalog *catalog);
+
+// Give the memory of a film node back to the catalog
+static void catalog_releaseNode(tCatalog *catalog, tFilmListNode *node) {
+    tFilmStore *store = &catalog->store;
+
+    stringArena_release(&catalog->names, node->elem.name);
+
+    // Leave a hole and release the handle
+    store->slotOf[node->handle] = -1;
+    store->freeHandles[store->freeHandleCount++] = node->handle;
+    store->holes[store->holeCount++] = (int) (node - store->slots);
+    node->handle = FILM_HANDLE_NONE;
+
+    if (store->holeCount >= STORE_MIN_HOLES && store->holeCount * 2 > store->used) {
+        catalog_compact(catalog);
     }
-    // LAST OR OTHER
-    while (current != NULL && strcmp(current->elem.name, name) != 0) {
-        // FIRST -> ... (-> PREV -> CURRENT) -> [CURRENT.NEXT] -> ... -> LAST
-        prev = current;
-        current = current->next;
+    if (stringArena_isFragmented(catalog->names)) {
+        catalog_packNames(catalog);
     }
+}
 
-    if (current == NULL) {
-        return E_FILM_NOT_FOUND;
+// Move the names to a new arena when most of the old one is released
+static void catalog_packNames(tCatalog *catalog) {
+    tFilmStore *store = &catalog->store;
+    tStringArena names;
+
+    // Reserve all the space at once, so copying the names can not fail
+    stringArena_init(&names, catalog->allocator);
+    if (!stringArena_reserve(&names, catalog->names.used)) {
+        return;
     }
 
-    if (current == tempLast) {
-        catalog->filmList.last = prev;
-        prev->next = NULL;
-    } else {
-        prev->next = current->next;
+    for (int slot = 0; slot < store->used; slot++) {
+        if (store->slots[slot].handle != FILM_HANDLE_NONE)
+            store->slots[slot].elem.name = stringArena_dup(&names, store->slots[slot].elem.name);
     }
 
-    free(current->elem.name);
-    free(current);
-    catalog->filmList.count--;
+    stringArena_free(&catalog->names);
+    catalog->names = names;
+}
 
-    return E_SUCCESS;
+// Add a film at the end of its genre list
+static void catalog_genreLink(tCatalog *catalog, tFilmListNode *node) {
+    tGenreFilmList *list = &catalog->genreFilmList[node->elem.genre];
+
+    node->genrePrev = list->last;
+    node->genreNext = FILM_HANDLE_NONE;
+
+    if (list->first == FILM_HANDLE_NONE)
+        list->first = node->handle;
+    else
+        catalog_node(catalog, list->last)->genreNext = node->handle;
+
+    list->last = node->handle;
+    list->count++;
 }
 
-// 2d.1 - Return the number of total films
-int catalog_len(tCatalog catalog) {
-    return catalog.filmList.count;
+// Remove a film from its genre list
+static void catalog_genreUnlink(tCatalog *catalog, tFilmListNode *node) {
+    tGenreFilmList *list = &catalog->genreFilmList[node->elem.genre];
+
+    if (node->genrePrev == FILM_HANDLE_NONE)
+        list->first = node->genreNext;
+    else
+        catalog_node(catalog, node->genrePrev)->genreNext = node->genreNext;
+
+    if (node->genreNext == FILM_HANDLE_NONE)
+        list->last = node->genrePrev;
+    else
+        catalog_node(catalog, node->genreNext)->genrePrev = node->genrePrev;
+
+    list->count--;
 }
 
-// 2d.2 Return the number of free films
-int catalog_freeLen(tCatalog catalog) {
-    return catalog.freeFilmList.count;
+// Remove a free film from the catalog free list
+static void catalog_delFreeFilm(tCatalog *catalog, tFreeFilmListNode *node) {
+    // PREV -> [NODE] -> NEXT  =>  PREV -> NEXT
+    if (node->prev == NULL)
+        catalog->freeFilmList.first = node->next;
+    else
+        node->prev->next = node->next;
+
+    if (node->next == NULL)
+        catalog->freeFilmList.last = node->prev;
+    else
+        node->next->prev = node->prev;
+
+    pool_release(&catalog->freeFilmNodePool, node);
+    catalog->freeFilmList.count--;
 }
 
-// 2e - Remove the films from the catalog
-tApiError catalog_free(tCatalog *catalog) {
-    assert(catalog != NULL);
+// Hash of a film name (FNV-1a)
+static unsigned int film_nameHash(const char *name) {
+    unsigned int hash = 2166136261u;
 
-    tFilmListNode *temp = catalog->filmList.first;
-    while (temp != NULL) {
-        tFilmListNode *next = temp->next;
-        free(temp->elem.name);
-        free(temp);
-        temp = next;
+    while (*name != '\0') {
+        hash ^= (unsigned char) *name++;
+        hash *= 16777619u;
     }
 
-    catalog->filmList.first = NULL;
-    catalog->filmList.last = NULL;
-    catalog->filmList.count = 0;
+    return hash;
+}
 
-    tFreeFilmListNode *tempFree = catalog->freeFilmList.first;
-    while (tempFree != NULL) {
-        tFreeFilmListNode *next = tempFree->next;
-        free(tempFree);
-        tempFree = next;
+// Position of a name in the name index, or the empty position where it would be stored
+static int catalog_nameSlot(const tCatalog *catalog, const char *name, unsigned int hash) {
+    const tFilmNameIndex *index = &catalog->nameIndex;
+    int mask = index->capacity - 1;
+    int pos = (int) (hash & mask);
+
+    while (index->elems[pos].handle != FILM_HANDLE_NONE) {
+        if (index->elems[pos].hash == hash && strcmp(catalog_node(catalog, index->elems[pos].handle)->elem.name, name) == 0)
+            return pos;
+        pos = (pos + 1) & mask;
     }
 
-    catalog->freeFilmList.first = NULL;
-    catalog->freeFilmList.last = NULL;
-    catalog->freeFilmList.count = 0;
+    return pos;
+}
+
+// Add a film of the store to the name index
+static tApiError catalog_nameIndexAdd(tCatalog *catalog, tFilmHandle handle) {
+    tFilmNameIndex *index = &catalog->nameIndex;
+
+    // Keep the table at most half full
+    if ((index->count + 1) * 2 > index->capacity) {
+        int capacity = index->capacity == 0 ? 64 : index->capacity * 2;
+        tFilmNameIndexEntry *elems = (tFilmNameIndexEntry *) allocator_alloc(catalog->allocator, capacity * sizeof(tFilmNameIndexEntry));
+        if (elems == NULL)
+            return E_MEMORY_ERROR;
+
+        for (int pos = 0; pos < capacity; pos++)
+            elems[pos].handle = FILM_HANDLE_NONE;
+
+        // Names are unique, so the entries only need an empty position
+        for (int pos = 0; pos < index->capacity; pos++) {
+            if (index->elems[pos].handle != FILM_HANDLE_NONE) {
+                int newPos = (int) (index->elems[pos].hash & (capacity - 1));
+                while (elems[newPos].handle != FILM_HANDLE_NONE)
+                    newPos = (newPos + 1) & (capacity - 1);
+                elems[newPos] = index->elems[pos];
+            }
+        }
+
+        allocator_free(catalog->allocator, index->elems);
+        index->elems = elems;
+        index->capacity = capacity;
+    }
+
+    const char *name = catalog_node(catalog, handle)->elem.name;
+    unsigned int hash = film_nameHash(name);
+    int pos = catalog_nameSlot(catalog, name, hash);
+
+    index->elems[pos].hash = hash;
+    index->elems[pos].handle = handle;
+    index->count++;
+
+    return E_SUCCESS;
+}
+
+// Remove a film from the name index
+static void catalog_nameIndexDel(tCatalog *catalog, const char *name) {
+    tFilmNameIndex *index = &catalog->nameIndex;
+    int mask = index->capacity - 1;
+    int hole = catalog_nameSlot(catalog, name, film_nameHash(name));
+    int pos = (hole + 1) & mask;
+
+    assert(index->elems[hole].handle != FILM_HANDLE_NONE);
+
+    // Move back the entries that can not be found anymore after the hole
+    while (index->elems[pos].handle != FILM_HANDLE_NONE) {
+        int home = (int) (index->elems[pos].hash & mask);
+        bool reachable = hole <= pos ? (home > hole && home <= pos) : (home > hole || home <= pos);
+        if (!reachable) {
+            index->elems[hole] = index->elems[pos];
+            hole = pos;
+        }
+        pos = (pos + 1) & mask;
+    }
+
+    index->elems[hole].handle = FILM_HANDLE_NONE;
+    index->count--;
+}
+
+// Last version given to a catalog, shared by all of them so a version is never reused
+static atomic_ullong catalog_lastVersion = 0;
+
+// Return a version not used by any catalog yet
+static unsigned long long catalog_nextVersion(void) {
+    return atomic_fetch_add(&catalog_lastVersion, 1) + 1;
+}
+
+// Initialize the indexes and bitmaps of the catalog, whose memory comes from its block arena. Searches allocate their
+// results and temporary memory from the catalog allocator, since the arena is not thread-safe
+static void catalog_initIndexes(tCatalog *catalog) {
+    const tAllocator *indexAllocator = blockArena_allocator(&catalog->indexes);
+
+    for (int genre = GENRE_FIRST; genre < GENRE_END; genre++) {
+        ratingIndex_init(&catalog->ratingIndex[genre][0], indexAllocator);
+        ratingIndex_init(&catalog->ratingIndex[genre][1], indexAllocator);
+    }
+    releaseIndex_init(&catalog->releaseIndex, indexAllocator);
+
+    trigramIndex_init(&catalog->trigramIndex, catalog->allocator, indexAllocator);
+    trie_init(&catalog->completions, indexAllocator);
+
+    bitmap_init(&catalog->filmsBitmap, indexAllocator);
+    bitmap_init(&catalog->freeBitmap, indexAllocator);
+    for (int genre = GENRE_FIRST; genre < GENRE_END; genre++) {
+        bitmap_init(&catalog->genreBitmap[genre], indexAllocator);
+    }
+    for (int bucket = 0; bucket < FILM_RATING_BUCKETS; bucket++) {
+        bitmap_init(&catalog->ratingBitmap[bucket], indexAllocator);
+    }
+}
+
+// 2a - Initialize the films catalog
+tApiError catalog_init(tCatalog *catalog, const tAllocator *allocator) {
+    catalog->allocator = allocator;
+
+    catalog->filmList.count = 0;
+    catalog->filmList.first = NULL;
+    catalog->filmList.last = NULL;
+    catalog->filmList.allocator = allocator;
+
+    catalog->freeFilmList.count = 0;
+    catalog->freeFilmList.first = NULL;
+    catalog->freeFilmList.last = NULL;
+    catalog->freeFilmList.allocator = allocator;
+
+    for (int genre = GENRE_FIRST; genre < GENRE_END; genre++) {
+        genreFilmList_init(&catalog->genreFilmList[genre]);
+    }
+
+    catalog->nameIndex.elems = NULL;
+    catalog->nameIndex.capacity = 0;
+    catalog->nameIndex.count = 0;
+
+    blockArena_init(&catalog->indexes, allocator);
+    catalog_initIndexes(catalog);
+
+    filmStore_init(&catalog->store, allocator);
+    catalog->columns.genre = NULL;
+    catalog->columns.rating = NULL;
+    catalog->columns.release = NULL;
+    catalog->columns.duration = NULL;
+    catalog->columns.isFree = NULL;
+    catalog->columns.live = NULL;
+    catalog->columns.capacity = 0;
+    pool_init(&catalog->freeFilmNodePool, sizeof(tFreeFilmListNode), allocator);
+    stringArena_init(&catalog->names, allocator);
+    catalog->version = catalog_nextVersion();
+
+    return E_SUCCESS;
+}
+
+// 2b - Add a new film to the catalog
+tApiError catalog_add(tCatalog *catalog, tFilm film) {
+    if (catalog_find(catalog, film.name) != FILM_HANDLE_NONE) {
+        // FOUND IN CATALOG
+        return E_FILM_DUPLICATED;
+    }
+    // ALLOCATE NEW NODES FROM THE CATALOG STORE AND POOLS
+    char *name = stringArena_dup(&catalog->names, film.name);
+    if (name == NULL) {
+        return E_MEMORY_ERROR;
+    }
+    tFilmListNode *newNode = catalog_allocNode(catalog);
+    if (newNode == NULL) {
+        stringArena_release(&catalog->names, name);
+        return E_MEMORY_ERROR;
+    }
+    newNode->elem.name = name;
+    tFreeFilmListNode *newFreeNode = NULL;
+    if (film.isFree) {
+        newFreeNode = (tFreeFilmListNode *) pool_alloc(&catalog->freeFilmNodePool);
+        if (newFreeNode == NULL) {
+            catalog_releaseNode(catalog, newNode);
+            return E_MEMORY_ERROR;
+        }
+    }
+    // NEW NODE = FILM
+    newNode->elem.duration = film.duration;
+    newNode->elem.genre = film.genre;
+    newNode->elem.release = film.release;
+    newNode->elem.rating = film.rating;
+    newNode->elem.isFree = film.isFree;
+    newNode->next = NULL; // ... -> [NEW NODE] -> NULL
+    newNode->prev = catalog->filmList.last;
+    newNode->freeNode = newFreeNode;
+
+    // NAME INDEX
+    tApiError error = catalog_nameIndexAdd(catalog, newNode->handle);
+    if (error == E_SUCCESS) {
+        // RATING INDEX
+        error = ratingIndex_add(&catalog->ratingIndex[film.genre][film.isFree], film.rating, newNode->handle);
+        if (error == E_SUCCESS) {
+            // RELEASE DATE INDEX
+            error = releaseIndex_add(&catalog->releaseIndex, film.release, newNode->handle);
+            if (error == E_SUCCESS) {
+                // TITLE SEARCH INDEX
+                error = trigramIndex_add(&catalog->trigramIndex, newNode->elem.name, newNode->handle);
+                if (error == E_SUCCESS) {
+                    // AUTOCOMPLETE TRIE
+                    error = trie_add(&catalog->completions, newNode->elem.name, newNode->handle, film.rating);
+                    if (error == E_SUCCESS) {
+                        // PREDICATE BITMAPS
+                        error = catalog_bitmapsAdd(catalog, newNode->handle, &film);
+                        if (error != E_SUCCESS) {
+                            trie_del(&catalog->completions, newNode->elem.name, newNode->handle);
+                        }
+                    }
+                    if (error != E_SUCCESS) {
+                        trigramIndex_del(&catalog->trigramIndex, newNode->elem.name, newNode->handle);
+                    }
+                }
+                if (error != E_SUCCESS) {
+                    releaseIndex_del(&catalog->releaseIndex, film.release, newNode->handle);
+                }
+            }
+            if (error != E_SUCCESS) {
+                ratingIndex_del(&catalog->ratingIndex[film.genre][film.isFree], film.rating, newNode->handle);
+            }
+        }
+        if (error != E_SUCCESS) {
+            catalog_nameIndexDel(catalog, newNode->elem.name);
+        }
+    }
+    if (error != E_SUCCESS) {
+        if (newFreeNode != NULL) {
+            pool_release(&catalog->freeFilmNodePool, newFreeNode);
+        }
+        catalog_releaseNode(catalog, newNode);
+        return error;
+    }
+
+    // GENRE INDEX
+    catalog_genreLink(catalog, newNode);
+    // FILTER COLUMNS, ALREADY GROWN WITH THE STORE
+    catalog_columnsSet(catalog, newNode->handle, &newNode->elem);
+
+    if (catalog->filmList.first == NULL) {
+        // FILM LIST EMPTY
+        catalog->filmList.first = newNode;
+        catalog->filmList.last = newNode;
+    } else {
+        // ... -> LAST -> [NEW NODE] -> NULL
+        catalog->filmList.last->next = newNode;
+        catalog->filmList.last = newNode;
+    }
+    catalog->filmList.count++;
+
+    if (film.isFree) {
+        // FREE FILM
+        newFreeNode->elem = &newNode->elem; // ONLY FILM POINTER
+        newFreeNode->handle = newNode->handle;
+        newFreeNode->next = NULL;
+        newFreeNode->prev = catalog->freeFilmList.last;
+
+        if (catalog->freeFilmList.first == NULL) {
+            catalog->freeFilmList.first = newFreeNode;
+            catalog->freeFilmList.last = newFreeNode;
+        } else {
+            catalog->freeFilmList.last->next = newFreeNode;
+            catalog->freeFilmList.last = newFreeNode;
+        }
+        catalog->freeFilmList.count++;
+    }
+    catalog->version = catalog_nextVersion();
+
+    return E_SUCCESS;
+}
+
+// 2c - Remove a film from the catalog
+tApiError catalog_del(tCatalog *catalog, const char *name) {
+    assert(catalog != NULL);
+    assert(name != NULL);
+
+    const tFilmHandle handle = catalog_find(catalog, name);
+
+    if (handle == FILM_HANDLE_NONE) {
+        // FILM NOT FOUND
+        return E_FILM_NOT_FOUND;
+    }
+    tFilmListNode *node = catalog_node(catalog, handle);
+    const tFilm *existingFilm = &node->elem;
+
+    // FREE FILM
+    if (node->freeNode != NULL) {
+        catalog_delFreeFilm(catalog, node->freeNode);
+    }
+    // GENRE INDEX
+    catalog_genreUnlink(catalog, node);
+    // FILTER COLUMNS
+    catalog_columnsClear(catalog, handle);
+    // PREDICATE BITMAPS
+    catalog_bitmapsDel(catalog, handle, existingFilm);
+    // RATING INDEX
+    ratingIndex_del(&catalog->ratingIndex[existingFilm->genre][existingFilm->isFree], existingFilm->rating, handle);
+    // RELEASE DATE INDEX
+    releaseIndex_del(&catalog->releaseIndex, existingFilm->release, handle);
+    // TITLE SEARCH INDEX. Stale entries are harmless, searches check every candidate
+    trigramIndex_del(&catalog->trigramIndex, existingFilm->name, handle);
+    // AUTOCOMPLETE TRIE
+    trie_del(&catalog->completions, existingFilm->name, handle);
+    // NAME INDEX
+    catalog_nameIndexDel(catalog, existingFilm->name);
+
+    // PREV -> [NODE] -> NEXT  =>  PREV -> NEXT
+    if (node->prev == NULL) {
+        catalog->filmList.first = node->next;
+    } else {
+        node->prev->next = node->next;
+    }
+    if (node->next == NULL) {
+        catalog->filmList.last = node->prev;
+    } else {
+        node->next->prev = node->prev;
+    }
+    catalog->filmList.count--;
+
+    catalog_releaseNode(catalog, node);
+    catalog->version = catalog_nextVersion();
+
+    return E_SUCCESS;
+}
+
+// 2d.1 - Return the number of total films
+int catalog_len(tCatalog catalog) {
+    return catalog.filmList.count;
+}
+
+// 2d.2 Return the number of free films
+int catalog_freeLen(tCatalog catalog) {
+    return catalog.freeFilmList.count;
+}
+
+// Return the number of films of the given genre
+int catalog_genreLen(tCatalog catalog, tFilmGenre genre) {
+    assert(genre >= GENRE_FIRST && genre < GENRE_END);
+
+    return catalog.genreFilmList[genre].count;
+}
+
+// Return the handle of the film with the given name
+tFilmHandle catalog_find(const tCatalog *catalog, const char *name) {
+    assert(catalog != NULL);
+    assert(name != NULL);
+
+    if (catalog->nameIndex.count == 0)
+        return FILM_HANDLE_NONE;
+
+    return catalog->nameIndex.elems[catalog_nameSlot(catalog, name, film_nameHash(name))].handle;
+}
+
+// Return a pointer to the film with the given handle
+tFilm *catalog_film(const tCatalog *catalog, tFilmHandle handle) {
+    assert(catalog != NULL);
+
+    if (handle < 0 || handle >= catalog->store.handleCount || catalog->store.slotOf[handle] < 0)
+        return NULL;
+
+    return &catalog->store.slots[catalog->store.slotOf[handle]].elem;
+}
+
+// Get up to max free films in catalog order, as pointers valid until the catalog is modified
+int catalog_freeFilmsView(const tCatalog *catalog, int max, const tFilm **result) {
+    assert(catalog != NULL);
+    assert(max == 0 || result != NULL);
+
+    int count = 0;
+    for (const tFreeFilmListNode *node = catalog->freeFilmList.first; node != NULL && count < max; node = node->next)
+        result[count++] = node->elem;
+
+    return count;
+}
+
+// Get up to max films of a genre in catalog order, as pointers valid until the catalog is modified
+int catalog_genreFilmsView(const tCatalog *catalog, tFilmGenre genre, int max, const tFilm **result) {
+    assert(catalog != NULL);
+    assert(genre >= GENRE_FIRST && genre < GENRE_END);
+    assert(max == 0 || result != NULL);
+
+    int count = 0;
+    for (tFilmHandle handle = catalog->genreFilmList[genre].first; handle != FILM_HANDLE_NONE && count < max;
+         handle = catalog_node(catalog, handle)->genreNext)
+        result[count++] = &catalog_node(catalog, handle)->elem;
+
+    return count;
+}
+
+// Initialize a cursor to the start of a film list
+void filmListCursor_init(tFilmListCursor *cursor) {
+    assert(cursor != NULL);
+
+    cursor->handle = FILM_HANDLE_NONE;
+    cursor->version = 0;
+}
+
+// Get up to max free films after the cursor, moving it to the last returned film
+int catalog_freeFilmsPage(const tCatalog *catalog, tFilmListCursor *cursor, int max, const tFilm **result) {
+    assert(catalog != NULL);
+    assert(cursor != NULL);
+    assert(max == 0 || result != NULL);
+
+    const tFreeFilmListNode *node = catalog->freeFilmList.first;
+    if (cursor->handle != FILM_HANDLE_NONE) {
+        // RESUME AFTER THE LAST RETURNED FILM, WHICH MUST STILL BE THE SAME FREE FILM
+        if (cursor->version != catalog->version || catalog_film(catalog, cursor->handle) == NULL
+            || catalog_node(catalog, cursor->handle)->freeNode == NULL) {
+            return -1;
+        }
+        node = catalog_node(catalog, cursor->handle)->freeNode->next;
+    }
+
+    int count = 0;
+    for (; node != NULL && count < max; node = node->next) {
+        result[count++] = node->elem;
+        cursor->handle = node->handle;
+    }
+    cursor->version = catalog->version;
+
+    return count;
+}
+
+// Get up to max films of a genre after the cursor, moving it to the last returned film
+int catalog_genreFilmsPage(const tCatalog *catalog, tFilmGenre genre, tFilmListCursor *cursor, int max, const tFilm **result) {
+    assert(catalog != NULL);
+    assert(genre >= GENRE_FIRST && genre < GENRE_END);
+    assert(cursor != NULL);
+    assert(max == 0 || result != NULL);
+
+    tFilmHandle handle = catalog->genreFilmList[genre].first;
+    if (cursor->handle != FILM_HANDLE_NONE) {
+        // RESUME AFTER THE LAST RETURNED FILM, WHICH MUST STILL BE A FILM OF THE GENRE
+        if (cursor->version != catalog->version || catalog_film(catalog, cursor->handle) == NULL
+            || catalog_node(catalog, cursor->handle)->elem.genre != genre) {
+            return -1;
+        }
+        handle = catalog_node(catalog, cursor->handle)->genreNext;
+    }
+
+    int count = 0;
+    for (; handle != FILM_HANDLE_NONE && count < max; handle = catalog_node(catalog, handle)->genreNext) {
+        result[count++] = &catalog_node(catalog, handle)->elem;
+        cursor->handle = handle;
+    }
+    cursor->version = catalog->version;
+
+    return count;
+}
+
+// Return the first film of the given genre
+tFilmHandle catalog_genreFirst(const tCatalog *catalog, tFilmGenre genre) {
+    assert(catalog != NULL);
+    assert(genre >= GENRE_FIRST && genre < GENRE_END);
+
+    return catalog->genreFilmList[genre].first;
+}
+
+// Return the next film with the same genre
+tFilmHandle catalog_genreNext(const tCatalog *catalog, tFilmHandle handle) {
+    assert(catalog != NULL);
+
+    return catalog_node(catalog, handle)->genreNext;
+}
+
+// Cursor over one of the rating indexes, used to merge them
+typedef struct _tRatingCursor {
+    const tRatingIndex *index;
+    tFilmIndexPos pos;
+} tRatingCursor;
+
+// Check if the cursor a points to a better film than the cursor b
+static bool ratingCursor_better(tRatingCursor a, tRatingCursor b) {
+    const tFilmIndexEntry *entryA = filmIndex_entry(a.index, a.pos);
+    const tFilmIndexEntry *entryB = filmIndex_entry(b.index, b.pos);
+
+    return entryA->key < entryB->key || (entryA->key == entryB->key && entryA->handle < entryB->handle);
+}
+
+// Restore the heap property from position pos downwards
+static void ratingCursor_siftDown(tRatingCursor *heap, int count, int pos) {
+    while (true) {
+        int best = pos;
+        int left = 2 * pos + 1, right = 2 * pos + 2;
+
+        if (left < count && ratingCursor_better(heap[left], heap[best]))
+            best = left;
+        if (right < count && ratingCursor_better(heap[right], heap[best]))
+            best = right;
+        if (best == pos)
+            return;
+
+        tRatingCursor aux = heap[pos];
+        heap[pos] = heap[best];
+        heap[best] = aux;
+        pos = best;
+    }
+}
+
+// Get the k best rated films of a genre (or FILM_GENRE_ANY), optionally only the free ones
+int catalog_topRated(const tCatalog *catalog, int k, int genre, bool freeOnly, tFilmHandle *result) {
+    assert(catalog != NULL);
+    assert(genre == FILM_GENRE_ANY || (genre >= GENRE_FIRST && genre < GENRE_END));
+    assert(k == 0 || result != NULL);
+
+    tRatingCursor heap[GENRE_END * 2];
+    int count = 0, found = 0;
+
+    // One cursor for each non-empty index that matches the filter
+    for (int g = GENRE_FIRST; g < GENRE_END; g++) {
+        if (genre != FILM_GENRE_ANY && g != genre)
+            continue;
+        for (int isFree = freeOnly ? 1 : 0; isFree <= 1; isFree++) {
+            if (catalog->ratingIndex[g][isFree].count > 0) {
+                heap[count].index = &catalog->ratingIndex[g][isFree];
+                heap[count].pos.block = 0;
+                heap[count].pos.offset = 0;
+                count++;
+            }
+        }
+    }
+    for (int i = count / 2 - 1; i >= 0; i--)
+        ratingCursor_siftDown(heap, count, i);
+
+    // Take the best film and advance its cursor
+    while (found < k && count > 0) {
+        result[found++] = filmIndex_entry(heap[0].index, heap[0].pos)->handle;
+        filmIndex_next(heap[0].index, &heap[0].pos);
+        if (filmIndex_end(heap[0].index, heap[0].pos))
+            heap[0] = heap[--count];
+        ratingCursor_siftDown(heap, count, 0);
+    }
+
+    return found;
+}
+
+// Return the number of films released between from and to, both included
+int catalog_releaseCount(const tCatalog *catalog, tDate from, tDate to) {
+    assert(catalog != NULL);
+
+    tFilmIndexPos first = filmIndex_upperBound(&catalog->releaseIndex, date_toDays(from) - 1, INT_MAX);
+    tFilmIndexPos last = filmIndex_upperBound(&catalog->releaseIndex, date_toDays(to), INT_MAX);
+
+    return filmIndex_distance(&catalog->releaseIndex, first, last);
+}
+
+// Get up to max films released between from and to, both included, sorted by release date
+int catalog_releaseRange(const tCatalog *catalog, tDate from, tDate to, tReleaseCursor *cursor, int max,
+                         tFilmHandle *result) {
+    assert(catalog != NULL);
+    assert(cursor != NULL);
+    assert(max == 0 || result != NULL);
+
+    const tReleaseIndex *index = &catalog->releaseIndex;
+    int fromDay = date_toDays(from), toDay = date_toDays(to);
+    int found = 0;
+    tFilmIndexPos pos;
+
+    // Resume after the cursor, or at the start of the range
+    if (cursor->day < fromDay)
+        pos = filmIndex_upperBound(index, fromDay - 1, INT_MAX);
+    else
+        pos = filmIndex_upperBound(index, cursor->day, cursor->handle);
+
+    while (found < max && !filmIndex_end(index, pos) && filmIndex_entry(index, pos)->key <= toDay) {
+        const tFilmIndexEntry *entry = filmIndex_entry(index, pos);
+        result[found++] = entry->handle;
+        cursor->day = entry->key;
+        cursor->handle = entry->handle;
+        filmIndex_next(index, &pos);
+    }
+
+    return found;
+}
+
+// Normalize the name of a film into buffer, which grows as needed with the allocator. NULL if there is no memory available
+static const char *catalog_normalizedName(const char *name, char **buffer, size_t *bufferSize, const tAllocator *allocator) {
+    size_t size = strlen(name) + 1;
+    if (size > *bufferSize) {
+        char *grown = (char *) allocator_realloc(allocator, *buffer, size);
+        if (grown == NULL)
+            return NULL;
+        *buffer = grown;
+        *bufferSize = size;
+    }
+    text_normalize(name, *buffer);
+
+    return *buffer;
+}
+
+// Check if the normalized name of a film contains a normalized fragment. False if there is no memory available
+static bool catalog_nameContains(const char *name, const char *fragment, char **buffer, size_t *bufferSize,
+                                 const tAllocator *allocator) {
+    const char *normalized = catalog_normalizedName(name, buffer, bufferSize, allocator);
+
+    return normalized != NULL && strstr(normalized, fragment) != NULL;
+}
+
+// Get up to max films whose normalized name contains the normalized fragment, ordered by handle
+int catalog_search(const tCatalog *catalog, const char *fragment, int max, tFilmHandle *result) {
+    assert(catalog != NULL);
+    assert(fragment != NULL);
+    assert(max >= 0);
+    assert(result != NULL || max == 0);
+
+    char *query = (char *) allocator_alloc(catalog->allocator, strlen(fragment) + 1);
+    if (query == NULL)
+        return -1;
+    int queryLen = text_normalize(fragment, query);
+
+    char *buffer = NULL;
+    size_t bufferSize = 0;
+    int count = 0;
+
+    if (queryLen < TRIGRAM_LENGTH) {
+        // Too short to use the index, check every film
+        for (tFilmHandle handle = 0; handle < catalog->store.handleCount && count < max; handle++) {
+            const tFilm *film = catalog_film(catalog, handle);
+            if (film != NULL && catalog_nameContains(film->name, query, &buffer, &bufferSize, catalog->allocator))
+                result[count++] = handle;
+        }
+    } else {
+        tPostingList candidates;
+        if (trigramIndex_match(&catalog->trigramIndex, query, &candidates) != E_SUCCESS) {
+            allocator_free(catalog->allocator, query);
+            return -1;
+        }
+        // Candidates have every trigram of the fragment, but maybe not in sequence
+        for (int i = 0; i < candidates.count && count < max; i++) {
+            const tFilm *film = catalog_film(catalog, candidates.elems[i]);
+            if (film != NULL && catalog_nameContains(film->name, query, &buffer, &bufferSize, catalog->allocator))
+                result[count++] = candidates.elems[i];
+        }
+        postingList_free(&candidates);
+    }
+
+    allocator_free(catalog->allocator, buffer);
+    allocator_free(catalog->allocator, query);
+
+    return count;
+}
+
+// Film close to a fuzzy search query
+typedef struct _tFuzzyMatch {
+    tFilmHandle handle;
+    int distance;
+    float rating;
+} tFuzzyMatch;
+
+// Order fuzzy matches by distance, then by rating (best first) and then by handle
+static int fuzzyMatch_compare(const void *a, const void *b) {
+    const tFuzzyMatch *matchA = (const tFuzzyMatch *) a;
+    const tFuzzyMatch *matchB = (const tFuzzyMatch *) b;
+
+    if (matchA->distance != matchB->distance)
+        return matchA->distance < matchB->distance ? -1 : 1;
+    if (matchA->rating != matchB->rating)
+        return matchA->rating > matchB->rating ? -1 : 1;
+    return (matchA->handle > matchB->handle) - (matchA->handle < matchB->handle);
+}
+
+// Get up to max films whose normalized name is at most maxDistance edits away from the normalized query,
+// sorted by distance and then by rating
+int catalog_fuzzySearch(const tCatalog *catalog, const char *query, int maxDistance, int max, tFilmHandle *result) {
+    assert(catalog != NULL);
+    assert(query != NULL);
+    assert(maxDistance >= 0);
+    assert(max >= 0);
+    assert(result != NULL || max == 0);
+
+    char *normalizedQuery = (char *) allocator_alloc(catalog->allocator, strlen(query) + 1);
+    if (normalizedQuery == NULL)
+        return -1;
+    text_normalize(query, normalizedQuery);
+
+    // Candidates share enough trigrams with the query. Short queries may match any film
+    tPostingList candidates;
+    tApiError error = E_SUCCESS;
+    int minShared = text_minSharedTrigrams(normalizedQuery, maxDistance, catalog->allocator);
+    if (minShared > 0) {
+        error = trigramIndex_similar(&catalog->trigramIndex, normalizedQuery, minShared, catalog->store.handleCount, &candidates);
+    } else {
+        postingList_init(&candidates, catalog->allocator);
+        candidates.elems = (int *) allocator_alloc(catalog->allocator, (catalog->filmList.count + 1) * sizeof(int));
+        if (candidates.elems == NULL) {
+            error = E_MEMORY_ERROR;
+        } else {
+            for (tFilmHandle handle = 0; handle < catalog->store.handleCount; handle++) {
+                if (catalog->store.slotOf[handle] >= 0)
+                    candidates.elems[candidates.count++] = handle;
+            }
+        }
+    }
+
+    tFuzzyMatch *matches = NULL;
+    if (error == E_SUCCESS && candidates.count > 0) {
+        matches = (tFuzzyMatch *) allocator_alloc(catalog->allocator, candidates.count * sizeof(tFuzzyMatch));
+        if (matches == NULL)
+            error = E_MEMORY_ERROR;
+    }
+
+    // Verify every candidate, giving up on each one as soon as it is too far
+    char *buffer = NULL;
+    size_t bufferSize = 0;
+    int count = 0;
+    for (int i = 0; error == E_SUCCESS && i < candidates.count; i++) {
+        const tFilm *film = catalog_film(catalog, candidates.elems[i]);
+        if (film == NULL)
+            continue;
+
+        const char *name = catalog_normalizedName(film->name, &buffer, &bufferSize, catalog->allocator);
+        if (name == NULL) {
+            error = E_MEMORY_ERROR;
+        } else {
+            int distance = text_editDistance(normalizedQuery, name, maxDistance, catalog->allocator);
+            if (distance <= maxDistance) {
+                matches[count].handle = candidates.elems[i];
+                matches[count].distance = distance;
+                matches[count].rating = film->rating;
+                count++;
+            }
+        }
+    }
+
+    if (error == E_SUCCESS) {
+        if (count > 1)
+            qsort(matches, count, sizeof(tFuzzyMatch), fuzzyMatch_compare);
+        if (count > max)
+            count = max;
+        for (int i = 0; i < count; i++)
+            result[i] = matches[i].handle;
+    }
+
+    allocator_free(catalog->allocator, buffer);
+    allocator_free(catalog->allocator, matches);
+    postingList_free(&candidates);
+    allocator_free(catalog->allocator, normalizedQuery);
+
+    return error == E_SUCCESS ? count : -1;
+}
+
+// Get up to max (at most TRIE_TOP_K) best rated films whose normalized name starts with the normalized prefix
+int catalog_complete(const tCatalog *catalog, const char *prefix, int max, tFilmHandle *result) {
+    assert(catalog != NULL);
+    assert(prefix != NULL);
+    assert(max >= 0);
+
+    char *normalizedPrefix = (char *) allocator_alloc(catalog->allocator, strlen(prefix) + 1);
+    if (normalizedPrefix == NULL)
+        return -1;
+    text_normalize(prefix, normalizedPrefix);
+
+    int count = trie_complete(&catalog->completions, normalizedPrefix, max, result);
+    allocator_free(catalog->allocator, normalizedPrefix);
+
+    return count;
+}
+
+// Initialize a filter that accepts every film
+void filmFilter_init(tFilmFilter *filter) {
+    assert(filter != NULL);
+
+    filter->genres = (1u << GENRE_END) - 1;
+    filter->minRating = RATING_MIN;
+    filter->maxRating = RATING_MAX;
+    filter->minRelease = INT_MIN;
+    filter->maxRelease = INT_MAX;
+    filter->minDuration = 0;
+    filter->maxDuration = INT_MAX;
+    filter->isFree = FILM_FREE_ANY;
+}
+
+// Return 1 if the columns of a film pass the filter, ignoring isFree, without branches
+static unsigned int catalog_filterLane(const tFilmColumns *columns, const tFilmFilter *filter, int handle) {
+    return ((filter->genres >> columns->genre[handle]) & 1u)
+           & (unsigned int) (columns->rating[handle] >= filter->minRating)
+           & (unsigned int) (columns->rating[handle] <= filter->maxRating)
+           & (unsigned int) (columns->release[handle] >= filter->minRelease)
+           & (unsigned int) (columns->release[handle] <= filter->maxRelease)
+           & (unsigned int) (columns->duration[handle] >= filter->minDuration)
+           & (unsigned int) (columns->duration[handle] <= filter->maxDuration);
+}
+
+_Static_assert(FILM_COLUMN_BITS == 32, "column words are packed from 32 byte lanes");
+
+// Set the lanes of the accepted genres of a filter to 0xFF, so the sweep looks them up instead of shifting
+static void catalog_filterGenres(const tFilmFilter *filter, unsigned char *genreMask) {
+    for (int genre = 0; genre < GENRE_END; genre++)
+        genreMask[genre] = (filter->genres >> genre) & 1u ? 0xFF : 0;
+}
+
+// Pack the high bit of each of the 32 lanes into a word
+static unsigned int catalog_packLanes(const unsigned char *lanes) {
+#ifdef FILM_SSE2
+    unsigned int low = (unsigned int) _mm_movemask_epi8(_mm_loadu_si128((const __m128i *) lanes));
+    unsigned int high = (unsigned int) _mm_movemask_epi8(_mm_loadu_si128((const __m128i *) (lanes + 16)));
+    return low | high << 16;
+#else
+    unsigned int bits = 0;
+    for (int lane = 0; lane < FILM_COLUMN_BITS; lane++)
+        bits |= (unsigned int) (lanes[lane] >> 7) << lane;
+    return bits;
+#endif
+}
+
+// Get the bits of the films of a column word that pass the filter. Each column is compared in its own
+// loop without branches into 0 or 0xFF lanes, which the compiler vectorizes from -O2 on
+static unsigned int catalog_filterWord(const tFilmColumns *columns, const tFilmFilter *filter,
+                                       const unsigned char *genreMask, int word) {
+    int base = word * FILM_COLUMN_BITS;
+    const unsigned char *genre = &columns->genre[base];
+    const float *rating = &columns->rating[base];
+    const int *release = &columns->release[base];
+    const int *duration = &columns->duration[base];
+    const float minRating = filter->minRating, maxRating = filter->maxRating;
+    const int minRelease = filter->minRelease, maxRelease = filter->maxRelease;
+    const int minDuration = filter->minDuration, maxDuration = filter->maxDuration;
+    unsigned char pass[FILM_COLUMN_BITS];
+
+    for (int lane = 0; lane < FILM_COLUMN_BITS; lane++)
+        pass[lane] = genreMask[genre[lane]];
+    for (int lane = 0; lane < FILM_COLUMN_BITS; lane++)
+        pass[lane] &= (unsigned char) -((rating[lane] >= minRating) & (rating[lane] <= maxRating));
+    for (int lane = 0; lane < FILM_COLUMN_BITS; lane++)
+        pass[lane] &= (unsigned char) -((release[lane] >= minRelease) & (release[lane] <= maxRelease));
+    for (int lane = 0; lane < FILM_COLUMN_BITS; lane++)
+        pass[lane] &= (unsigned char) -((duration[lane] >= minDuration) & (duration[lane] <= maxDuration));
+
+    unsigned int bits = catalog_packLanes(pass) & columns->live[word];
+    if (filter->isFree != FILM_FREE_ANY)
+        bits &= filter->isFree ? columns->isFree[word] : ~columns->isFree[word];
+
+    return bits;
+}
+
+// Return the number of bits set in a word
+static int catalog_bitCount(unsigned int bits) {
+    int count = 0;
+    for (; bits != 0; bits &= bits - 1)
+        count++;
+    return count;
+}
+
+// Return the position of the lowest bit set in a word, which must not be 0
+static int catalog_lowestBit(unsigned int bits) {
+    int pos = 0;
+    for (; (bits & 1u) == 0; bits >>= 1)
+        pos++;
+    return pos;
+}
+
+// Return the number of films that pass the filter
+int catalog_filterCount(const tCatalog *catalog, const tFilmFilter *filter) {
+    assert(catalog != NULL);
+    assert(filter != NULL);
+
+    unsigned char genreMask[GENRE_END];
+    int count = 0;
+    int words = COLUMN_WORDS(catalog->store.handleCount);
+
+    catalog_filterGenres(filter, genreMask);
+    for (int word = 0; word < words; word++)
+        count += catalog_bitCount(catalog_filterWord(&catalog->columns, filter, genreMask, word));
+
+    return count;
+}
+
+// Get up to max films that pass the filter, starting at handle from, ordered by handle
+int catalog_filter(const tCatalog *catalog, const tFilmFilter *filter, tFilmHandle from, int max, tFilmHandle *result) {
+    assert(catalog != NULL);
+    assert(filter != NULL);
+    assert(from >= 0);
+    assert(max >= 0);
+
+    unsigned char genreMask[GENRE_END];
+    int count = 0;
+    int words = COLUMN_WORDS(catalog->store.handleCount);
+
+    catalog_filterGenres(filter, genreMask);
+    for (int word = from / FILM_COLUMN_BITS; word < words && count < max; word++) {
+        unsigned int bits = catalog_filterWord(&catalog->columns, filter, genreMask, word);
+        if (word == from / FILM_COLUMN_BITS)
+            bits &= ~0u << (from % FILM_COLUMN_BITS);
+
+        for (; bits != 0 && count < max; bits &= bits - 1)
+            result[count++] = word * FILM_COLUMN_BITS + catalog_lowestBit(bits);
+    }
+
+    return count;
+}
+
+// Return the bitmap with the handles of all the films
+const tBitmap *catalog_filmsBitmap(const tCatalog *catalog) {
+    assert(catalog != NULL);
+
+    return &catalog->filmsBitmap;
+}
+
+// Return the bitmap with the handles of the films of a genre
+const tBitmap *catalog_genreBitmap(const tCatalog *catalog, tFilmGenre genre) {
+    assert(catalog != NULL);
+    assert(genre >= GENRE_FIRST && genre < GENRE_END);
+
+    return &catalog->genreBitmap[genre];
+}
+
+// Return the bitmap with the handles of the free films
+const tBitmap *catalog_freeBitmap(const tCatalog *catalog) {
+    assert(catalog != NULL);
+
+    return &catalog->freeBitmap;
+}
+
+// Store in result the handles of the films rated between minRating and maxRating, both included
+tApiError catalog_ratingBitmap(const tCatalog *catalog, float minRating, float maxRating, tBitmap *result) {
+    assert(catalog != NULL);
+    assert(result != NULL);
+
+    tApiError error = E_SUCCESS;
+    tBitmap merged;
+    int handles[FILM_COLUMN_BITS];
+    int count;
+
+    bitmap_free(result);
+
+    for (int bucket = 0; bucket < FILM_RATING_BUCKETS && error == E_SUCCESS; bucket++) {
+        float low = bucket * FILM_RATING_BUCKET_SIZE;
+        float high = bucket == FILM_RATING_BUCKETS - 1 ? RATING_MAX : (bucket + 1) * FILM_RATING_BUCKET_SIZE;
+        const tBitmap *films = &catalog->ratingBitmap[bucket];
+
+        if (high < minRating || low > maxRating || bitmap_count(films) == 0)
+            continue;
+
+        if (low >= minRating && high <= maxRating) {
+            // Every film of the range is in the result
+            bitmap_init(&merged, result->allocator);
+            error = bitmap_or(result, films, &merged);
+            bitmap_free(result);
+            *result = merged;
+        } else {
+            // Only some films of the range, checked in the rating column
+            tFilmHandle from = 0;
+            while (error == E_SUCCESS && (count = bitmap_values(films, from, FILM_COLUMN_BITS, handles)) > 0) {
+                for (int i = 0; i < count && error == E_SUCCESS; i++) {
+                    float rating = catalog->columns.rating[handles[i]];
+                    if (rating >= minRating && rating <= maxRating)
+                        error = bitmap_add(result, handles[i]);
+                }
+                from = handles[count - 1] + 1;
+            }
+        }
+    }
+
+    if (error != E_SUCCESS)
+        bitmap_free(result);
+
+    return error;
+}
+
+// Order handles from the lowest to the highest
+static int catalog_compareHandle(const void *a, const void *b) {
+    tFilmHandle handleA = *(const tFilmHandle *) a;
+    tFilmHandle handleB = *(const tFilmHandle *) b;
+    return (handleA > handleB) - (handleA < handleB);
+}
+
+// Initialize a query that returns every film in handle order, in a single page
+void filmQuery_init(tFilmQuery *query) {
+    assert(query != NULL);
+
+    filmFilter_init(&query->filter);
+    query->namePrefix = NULL;
+    query->order = FILM_ORDER_HANDLE;
+    query->limit = INT_MAX;
+}
+
+// Initialize a cursor at the start of a query
+void filmQueryCursor_init(tFilmQueryCursor *cursor) {
+    assert(cursor != NULL);
+
+    cursor->rating = RATING_MAX;
+    cursor->day = INT_MIN;
+    cursor->handle = FILM_HANDLE_NONE;
+}
+
+// Conditions of a query ready to be checked on single films
+typedef struct _tFilmMatcher {
+    tFilmFilter filter;
+    // Normalized name prefix, NULL if any name is accepted
+    char *prefix;
+    size_t prefixLen;
+    // Normalized name of the film being checked
+    char *buffer;
+    size_t bufferSize;
+    // Allocator of the prefix and of the buffer
+    const tAllocator *allocator;
+} tFilmMatcher;
+
+// Prepare the conditions of a query
+static tApiError filmMatcher_init(tFilmMatcher *matcher, const tFilmQuery *query, const tAllocator *allocator) {
+    matcher->filter = query->filter;
+    matcher->prefix = NULL;
+    matcher->prefixLen = 0;
+    matcher->buffer = NULL;
+    matcher->bufferSize = 0;
+    matcher->allocator = allocator;
+
+    if (query->namePrefix != NULL) {
+        matcher->prefix = (char *) allocator_alloc(allocator, strlen(query->namePrefix) + 1);
+        if (matcher->prefix == NULL)
+            return E_MEMORY_ERROR;
+        matcher->prefixLen = text_normalize(query->namePrefix, matcher->prefix);
+        if (matcher->prefixLen == 0) {
+            // Every name starts with an empty prefix
+            allocator_free(allocator, matcher->prefix);
+            matcher->prefix = NULL;
+        }
+    }
+
+    return E_SUCCESS;
+}
+
+// Check if a film in use passes every condition of the query
+static bool filmMatcher_match(tFilmMatcher *matcher, const tCatalog *catalog, tFilmHandle handle) {
+    const tFilmColumns *columns = &catalog->columns;
+    unsigned int bit = 1u << (handle % FILM_COLUMN_BITS);
+    bool isFree = (columns->isFree[handle / FILM_COLUMN_BITS] & bit) != 0;
+
+    if (!catalog_filterLane(columns, &matcher->filter, handle))
+        return false;
+    if (matcher->filter.isFree != FILM_FREE_ANY && matcher->filter.isFree != isFree)
+        return false;
+    if (matcher->prefix == NULL)
+        return true;
+
+    const char *name = catalog_normalizedName(catalog_film(catalog, handle)->name, &matcher->buffer, &matcher->bufferSize,
+                                              matcher->allocator);
+    return name != NULL && strncmp(name, matcher->prefix, matcher->prefixLen) == 0;
+}
+
+// Remove the data of the prepared conditions
+static void filmMatcher_free(tFilmMatcher *matcher) {
+    allocator_free(matcher->allocator, matcher->prefix);
+    allocator_free(matcher->allocator, matcher->buffer);
+}
+
+// Page of films being filled by a query
+typedef struct _tFilmPage {
+    tFilmQueryCursor *cursor;
+    tFilmHandle *result;
+    int count;
+    int limit;
+} tFilmPage;
+
+// Add a film to the page if it matches, and move the cursor to it. Return true when the page is full
+static bool filmPage_take(tFilmPage *page, tFilmMatcher *matcher, const tCatalog *catalog, tFilmHandle handle) {
+    if (filmMatcher_match(matcher, catalog, handle)) {
+        page->result[page->count++] = handle;
+        page->cursor->rating = catalog->columns.rating[handle];
+        page->cursor->day = catalog->columns.release[handle];
+        page->cursor->handle = handle;
+    }
+    return page->count == page->limit;
+}
+
+// Fill a page walking the release date index from the cursor
+static void catalog_queryByRelease(const tCatalog *catalog, tFilmMatcher *matcher, tFilmPage *page) {
+    const tReleaseIndex *index = &catalog->releaseIndex;
+    const tFilmFilter *filter = &matcher->filter;
+    tFilmIndexPos pos = {0, 0};
+
+    if (filter->minRelease != INT_MIN)
+        pos = filmIndex_upperBound(index, filter->minRelease - 1, INT_MAX);
+    if (page->cursor->handle != FILM_HANDLE_NONE)
+        pos = filmIndex_later(pos, filmIndex_upperBound(index, page->cursor->day, page->cursor->handle));
+
+    for (; !filmIndex_end(index, pos) && filmIndex_entry(index, pos)->key <= filter->maxRelease; filmIndex_next(index, &pos)) {
+        if (filmPage_take(page, matcher, catalog, filmIndex_entry(index, pos)->handle))
+            return;
+    }
+}
+
+// Fill a page merging the rating indexes of the accepted genres and isFree values from the cursor
+static void catalog_queryByRating(const tCatalog *catalog, tFilmMatcher *matcher, tFilmPage *page) {
+    const tFilmFilter *filter = &matcher->filter;
+    tRatingCursor heap[GENRE_END * 2];
+    int count = 0;
+
+    for (int genre = GENRE_FIRST; genre < GENRE_END; genre++) {
+        if (((filter->genres >> genre) & 1u) == 0)
+            continue;
+        for (int isFree = 0; isFree <= 1; isFree++) {
+            if (filter->isFree != FILM_FREE_ANY && filter->isFree != isFree)
+                continue;
+
+            const tRatingIndex *index = &catalog->ratingIndex[genre][isFree];
+            tFilmIndexPos pos = filmIndex_upperBound(index, ratingIndex_key(filter->maxRating), FILM_HANDLE_NONE);
+            if (page->cursor->handle != FILM_HANDLE_NONE)
+                pos = filmIndex_later(pos, filmIndex_upperBound(index, ratingIndex_key(page->cursor->rating), page->cursor->handle));
+            if (!filmIndex_end(index, pos)) {
+                heap[count].index = index;
+                heap[count].pos = pos;
+                count++;
+            }
+        }
+    }
+    for (int i = count / 2 - 1; i >= 0; i--)
+        ratingCursor_siftDown(heap, count, i);
+
+    int minKey = ratingIndex_key(filter->minRating);
+    while (count > 0 && filmIndex_entry(heap[0].index, heap[0].pos)->key <= minKey) {
+        if (filmPage_take(page, matcher, catalog, filmIndex_entry(heap[0].index, heap[0].pos)->handle))
+            return;
+        filmIndex_next(heap[0].index, &heap[0].pos);
+        if (filmIndex_end(heap[0].index, heap[0].pos))
+            heap[0] = heap[--count];
+        ratingCursor_siftDown(heap, count, 0);
+    }
+}
+
+// Fill a page with the films of a sorted list of handles, starting at handle from
+static void catalog_queryHandles(const tCatalog *catalog, tFilmMatcher *matcher, tFilmPage *page, const int *handles,
+                                 int count, tFilmHandle from) {
+    int first = 0, last = count;
+
+    while (first < last) {
+        int mid = (first + last) / 2;
+        if (handles[mid] < from)
+            first = mid + 1;
+        else
+            last = mid;
+    }
+
+    for (int i = first; i < count; i++) {
+        if (filmPage_take(page, matcher, catalog, handles[i]))
+            return;
+    }
+}
+
+// Fill a page with the films of a bitmap, starting at handle from
+static void catalog_queryBitmap(const tCatalog *catalog, tFilmMatcher *matcher, tFilmPage *page, const tBitmap *films,
+                                tFilmHandle from) {
+    int handles[FILM_COLUMN_BITS];
+    int count;
+
+    while ((count = bitmap_values(films, from, FILM_COLUMN_BITS, handles)) > 0) {
+        for (int i = 0; i < count; i++) {
+            if (filmPage_take(page, matcher, catalog, handles[i]))
+                return;
+        }
+        from = handles[count - 1] + 1;
+    }
+}
+
+// Store in films the handles of the accepted genres and isFree values
+static tApiError catalog_queryGenreBitmap(const tCatalog *catalog, const tFilmFilter *filter, tBitmap *films) {
+    tApiError error = E_SUCCESS;
+    tBitmap merged;
+
+    bitmap_free(films);
+    for (int genre = GENRE_FIRST; genre < GENRE_END && error == E_SUCCESS; genre++) {
+        if ((filter->genres >> genre) & 1u) {
+            bitmap_init(&merged, films->allocator);
+            error = bitmap_or(films, &catalog->genreBitmap[genre], &merged);
+            bitmap_free(films);
+            *films = merged;
+        }
+    }
+
+    if (error == E_SUCCESS && filter->isFree != FILM_FREE_ANY) {
+        bitmap_init(&merged, films->allocator);
+        if (filter->isFree)
+            error = bitmap_and(films, &catalog->freeBitmap, &merged);
+        else
+            error = bitmap_andNot(films, &catalog->freeBitmap, &merged);
+        bitmap_free(films);
+        *films = merged;
+    }
+
+    return error;
+}
+
+// Fill a page in handle order, from the smallest set of candidates available
+static tApiError catalog_queryByHandle(const tCatalog *catalog, tFilmMatcher *matcher, tFilmPage *page) {
+    const tFilmFilter *filter = &matcher->filter;
+    tFilmHandle from = page->cursor->handle + 1;
+    tApiError error = E_SUCCESS;
+
+    // Names with the trigrams of a long enough prefix
+    if (matcher->prefix != NULL && matcher->prefixLen >= TRIGRAM_LENGTH) {
+        tPostingList candidates;
+        error = trigramIndex_match(&catalog->trigramIndex, matcher->prefix, &candidates);
+        if (error == E_SUCCESS)
+            catalog_queryHandles(catalog, matcher, page, candidates.elems, candidates.count, from);
+        postingList_free(&candidates);
+        return error;
+    }
+
+    // Estimate the candidates of the genre and release date indexes
+    int films = catalog->filmList.count;
+    int genreFilms = 0;
+    for (int genre = GENRE_FIRST; genre < GENRE_END; genre++) {
+        if ((filter->genres >> genre) & 1u)
+            genreFilms += catalog->genreFilmList[genre].count;
+    }
+    if (filter->isFree == true && catalog->freeFilmList.count < genreFilms)
+        genreFilms = catalog->freeFilmList.count;
+    if (filter->isFree == false && films - catalog->freeFilmList.count < genreFilms)
+        genreFilms = films - catalog->freeFilmList.count;
+
+    tFilmIndexPos first = {0, 0};
+    if (filter->minRelease != INT_MIN)
+        first = filmIndex_upperBound(&catalog->releaseIndex, filter->minRelease - 1, INT_MAX);
+    tFilmIndexPos last = filmIndex_upperBound(&catalog->releaseIndex, filter->maxRelease, INT_MAX);
+    int releaseFilms = filmIndex_distance(&catalog->releaseIndex, first, last);
+
+    if (genreFilms <= releaseFilms && genreFilms * 4 < films) {
+        // Few films of the accepted genres
+        tBitmap candidates;
+        bitmap_init(&candidates, catalog->allocator);
+        error = catalog_queryGenreBitmap(catalog, filter, &candidates);
+        if (error == E_SUCCESS)
+            catalog_queryBitmap(catalog, matcher, page, &candidates, from);
+        bitmap_free(&candidates);
+    } else if (releaseFilms * 4 < films) {
+        // Few films released in the range
+        int *candidates = (int *) allocator_alloc(catalog->allocator, (releaseFilms > 0 ? releaseFilms : 1) * sizeof(int));
+        if (candidates == NULL)
+            return E_MEMORY_ERROR;
+        for (int i = 0; i < releaseFilms; i++, filmIndex_next(&catalog->releaseIndex, &first))
+            candidates[i] = filmIndex_entry(&catalog->releaseIndex, first)->handle;
+        qsort(candidates, releaseFilms, sizeof(int), catalog_compareHandle);
+        catalog_queryHandles(catalog, matcher, page, candidates, releaseFilms, from);
+        allocator_free(catalog->allocator, candidates);
+    } else {
+        // Sweep the columns
+        tFilmHandle handles[FILM_COLUMN_BITS];
+        int count;
+        while ((count = catalog_filter(catalog, filter, from, FILM_COLUMN_BITS, handles)) > 0) {
+            for (int i = 0; i < count; i++) {
+                if (filmPage_take(page, matcher, catalog, handles[i]))
+                    return E_SUCCESS;
+            }
+            from = handles[count - 1] + 1;
+        }
+    }
+
+    return error;
+}
+
+// Get the next page of films of a query, starting after the cursor and moving it to the last returned film
+int catalog_query(const tCatalog *catalog, const tFilmQuery *query, tFilmQueryCursor *cursor, tFilmHandle *result) {
+    assert(catalog != NULL);
+    assert(query != NULL);
+    assert(cursor != NULL);
+    assert(query->limit <= 0 || result != NULL);
+
+    tFilmMatcher matcher;
+    tFilmPage page;
+    tApiError error;
+
+    if (query->limit <= 0 || catalog->filmList.count == 0)
+        return 0;
+
+    error = filmMatcher_init(&matcher, query, catalog->allocator);
+    if (error != E_SUCCESS)
+        return -1;
+
+    page.cursor = cursor;
+    page.result = result;
+    page.count = 0;
+    page.limit = query->limit;
+
+    // The order of the query decides the index walked
+    if (query->order == FILM_ORDER_RELEASE)
+        catalog_queryByRelease(catalog, &matcher, &page);
+    else if (query->order == FILM_ORDER_RATING)
+        catalog_queryByRating(catalog, &matcher, &page);
+    else
+        error = catalog_queryByHandle(catalog, &matcher, &page);
+
+    filmMatcher_free(&matcher);
+
+    return error == E_SUCCESS ? page.count : -1;
+}
+
+// Return the first year of the decade of a release day
+static int catalog_decade(int day) {
+    tDate date;
+    date_fromDays(&date, day);
+
+    int year = date.year - date.year % 10;
+    return date.year % 10 < 0 ? year - 10 : year;
+}
+
+// Initialize an empty group of films
+static void filmGroup_init(tFilmGroup *group, int key) {
+    group->key = key;
+    group->count = 0;
+    group->averageRating = 0.0f;
+    group->totalDuration = 0;
+}
+
+// Add a film to a group. The rating sum is kept apart to avoid rounding errors
+static void filmGroup_add(tFilmGroup *group, double *ratingSum, float rating, int duration) {
+    group->count++;
+    group->totalDuration += duration;
+    *ratingSum += rating;
+}
+
+// Turn the rating sum of a group into its average
+static void filmGroup_finish(tFilmGroup *group, double ratingSum) {
+    group->averageRating = group->count > 0 ? (float) (ratingSum / group->count) : 0.0f;
+}
+
+// Group the films by genre, by release decade and by isFree in a single pass over the columns
+tApiError catalog_stats(const tCatalog *catalog, tFilmStats *stats) {
+    assert(catalog != NULL);
+    assert(stats != NULL);
+
+    const tFilmColumns *columns = &catalog->columns;
+    const tReleaseIndex *releases = &catalog->releaseIndex;
+    double genreSum[GENRE_END] = {0};
+    double freeSum[2] = {0};
+    double *decadeSum = NULL;
+    int firstDecade = 0;
+
+    for (int genre = GENRE_FIRST; genre < GENRE_END; genre++)
+        filmGroup_init(&stats->genre[genre], genre);
+    filmGroup_init(&stats->isFree[0], false);
+    filmGroup_init(&stats->isFree[1], true);
+    stats->decade = NULL;
+    stats->decadeCount = 0;
+    stats->allocator = catalog->allocator;
+
+    // The release index knows the oldest and newest films, so the decades are known in advance
+    if (releases->count > 0) {
+        const tFilmIndexBlock *lastBlock = releases->blocks[releases->blockCount - 1];
+        firstDecade = catalog_decade(releases->blocks[0]->elems[0].key);
+        stats->decadeCount = (catalog_decade(lastBlock->elems[lastBlock->count - 1].key) - firstDecade) / 10 + 1;
+        stats->decade = (tFilmGroup *) allocator_alloc(catalog->allocator, stats->decadeCount * sizeof(tFilmGroup));
+        decadeSum = (double *) allocator_calloc(catalog->allocator, stats->decadeCount, sizeof(double));
+        if (stats->decade == NULL || decadeSum == NULL) {
+            allocator_free(catalog->allocator, decadeSum);
+            filmStats_free(stats);
+            return E_MEMORY_ERROR;
+        }
+        for (int i = 0; i < stats->decadeCount; i++)
+            filmGroup_init(&stats->decade[i], firstDecade + i * 10);
+    }
+
+    int words = COLUMN_WORDS(catalog->store.handleCount);
+    for (int word = 0; word < words; word++) {
+        for (unsigned int bits = columns->live[word]; bits != 0; bits &= bits - 1) {
+            int handle = word * FILM_COLUMN_BITS + catalog_lowestBit(bits);
+            int genre = columns->genre[handle];
+            int isFree = (columns->isFree[word] >> (handle % FILM_COLUMN_BITS)) & 1u;
+            int decade = (catalog_decade(columns->release[handle]) - firstDecade) / 10;
+            float rating = columns->rating[handle];
+            int duration = columns->duration[handle];
+
+            filmGroup_add(&stats->genre[genre], &genreSum[genre], rating, duration);
+            filmGroup_add(&stats->isFree[isFree], &freeSum[isFree], rating, duration);
+            filmGroup_add(&stats->decade[decade], &decadeSum[decade], rating, duration);
+        }
+    }
+
+    for (int genre = GENRE_FIRST; genre < GENRE_END; genre++)
+        filmGroup_finish(&stats->genre[genre], genreSum[genre]);
+    filmGroup_finish(&stats->isFree[0], freeSum[0]);
+    filmGroup_finish(&stats->isFree[1], freeSum[1]);
+    for (int i = 0; i < stats->decadeCount; i++)
+        filmGroup_finish(&stats->decade[i], decadeSum[i]);
+
+    allocator_free(catalog->allocator, decadeSum);
+
+    return E_SUCCESS;
+}
+
+// Remove the data from the film statistics
+void filmStats_free(tFilmStats *stats) {
+    assert(stats != NULL);
+
+    allocator_free(stats->allocator, stats->decade);
+    stats->decade = NULL;
+    stats->decadeCount = 0;
+}
+
+// Move the films to fill the holes of the store
+tApiError catalog_compact(tCatalog *catalog) {
+    assert(catalog != NULL);
+
+    tFilmStore *store = &catalog->store;
+    int used = 0;
+
+    if (store->holeCount == 0)
+        return E_SUCCESS;
+
+    // New slots keep the order of the films in the store
+    for (int slot = 0; slot < store->used; slot++) {
+        if (store->slots[slot].handle != FILM_HANDLE_NONE)
+            store->slotOf[store->slots[slot].handle] = used++;
+    }
+
+    // Fix the links while the nodes are still at their old slots, then move them
+    catalog_relink(catalog, store->slots, store->used);
+    for (int slot = 0; slot < store->used; slot++) {
+        tFilmListNode *node = &store->slots[slot];
+        if (node->handle != FILM_HANDLE_NONE && store->slotOf[node->handle] != slot)
+            store->slots[store->slotOf[node->handle]] = *node;
+    }
+
+    store->used = used;
+    store->holeCount = 0;
+
+    return E_SUCCESS;
+}
+
+// 2e - Remove the films from the catalog
+tApiError catalog_free(tCatalog *catalog) {
+    assert(catalog != NULL);
+
+    // Nodes, names, indexes and bitmaps are released with their store, pools and arenas
+    filmStore_free(&catalog->store);
+    allocator_free(catalog->allocator, catalog->columns.genre);
+    allocator_free(catalog->allocator, catalog->columns.rating);
+    allocator_free(catalog->allocator, catalog->columns.release);
+    allocator_free(catalog->allocator, catalog->columns.duration);
+    allocator_free(catalog->allocator, catalog->columns.isFree);
+    allocator_free(catalog->allocator, catalog->columns.live);
+    catalog->columns.genre = NULL;
+    catalog->columns.rating = NULL;
+    catalog->columns.release = NULL;
+    catalog->columns.duration = NULL;
+    catalog->columns.isFree = NULL;
+    catalog->columns.live = NULL;
+    catalog->columns.capacity = 0;
+    pool_free(&catalog->freeFilmNodePool);
+    stringArena_free(&catalog->names);
+
+    allocator_free(catalog->allocator, catalog->nameIndex.elems);
+    catalog->nameIndex.elems = NULL;
+    catalog->nameIndex.capacity = 0;
+    catalog->nameIndex.count = 0;
+
+    // The slots of the trigram index are the only index memory out of the arena
+    allocator_free(catalog->allocator, catalog->trigramIndex.elems);
+    blockArena_free(&catalog->indexes);
+    catalog_initIndexes(catalog);
+
+    catalog->filmList.first = NULL;
+    catalog->filmList.last = NULL;
+    catalog->filmList.count = 0;
+
+    catalog->freeFilmList.first = NULL;
+    catalog->freeFilmList.last = NULL;
+    catalog->freeFilmList.count = 0;
+
+    for (int genre = GENRE_FIRST; genre < GENRE_END; genre++) {
+        genreFilmList_init(&catalog->genreFilmList[genre]);
+    }
 
     return E_SUCCESS;
 }
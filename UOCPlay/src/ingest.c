@@ -0,0 +1,584 @@
+#include "ingest.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Initial number of slots of a key table
+#define INGEST_TABLE_MIN 16
+
+// Record of any shard waiting to be moved to the data
+typedef struct _tIngestRef {
+    int row;
+    int shard;
+    int index;
+} tIngestRef;
+
+// FNV-1a hash of a string key
+static unsigned int ingest_hashStr(const char *key) {
+    unsigned int hash = 2166136261u;
+
+    while (*key != '\0') {
+        hash ^= (unsigned char) *key++;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+// Hash of an integer key
+static unsigned int ingest_hashInt(int key) {
+    unsigned int hash = (unsigned int) key;
+
+    hash ^= hash >> 16;
+    hash *= 0x45d9f3bu;
+    hash ^= hash >> 16;
+
+    return hash;
+}
+
+// Shard owning the keys with the given hash. The high bits are used, the tables probe with the low ones.
+// It must match the shard computed by ingest_classify
+static tIngestShard *ingest_shard(tIngest *ingest, unsigned int hash) {
+    return &ingest->shards[(hash >> 24) % INGEST_SHARDS];
+}
+
+// Initialize an empty key table
+static void ingestTable_init(tIngestTable *table) {
+    table->slots = NULL;
+    table->count = 0;
+    table->capacity = 0;
+}
+
+// Document of a person of the shard or of the data
+static const char *ingest_personKey(const tIngest *ingest, const tIngestShard *shard, int index) {
+    if (index >= 0) {
+        return shard->people[index].document;
+    }
+    return ingest->data->people.elems[INGEST_EXISTING(index)].document;
+}
+
+// Id of a subscription of the shard or of the data
+static int ingest_subscriptionKey(const tIngest *ingest, const tIngestShard *shard, int index) {
+    if (index >= 0) {
+        return shard->subscriptions[index].id;
+    }
+    return ingest->data->subscriptions.elems[INGEST_EXISTING(index)].id;
+}
+
+// Position of a person key in the table, or the empty position where it would be stored
+static int ingestTable_findPerson(const tIngest *ingest, const tIngestShard *shard, const char *document, unsigned int hash) {
+    const tIngestTable *table = &shard->peopleKeys;
+    int mask = table->capacity - 1;
+    int pos = (int) (hash & (unsigned int) mask);
+
+    while (table->slots[pos].index != -1
+           && (table->slots[pos].hash != hash
+               || strcmp(ingest_personKey(ingest, shard, table->slots[pos].index), document) != 0)) {
+        pos = (pos + 1) & mask;
+    }
+
+    return pos;
+}
+
+// Position of a subscription key in the table, or the empty position where it would be stored
+static int ingestTable_findSubscription(const tIngest *ingest, const tIngestShard *shard, int id, unsigned int hash) {
+    const tIngestTable *table = &shard->subscriptionKeys;
+    int mask = table->capacity - 1;
+    int pos = (int) (hash & (unsigned int) mask);
+
+    while (table->slots[pos].index != -1
+           && (table->slots[pos].hash != hash
+               || ingest_subscriptionKey(ingest, shard, table->slots[pos].index) != id)) {
+        pos = (pos + 1) & mask;
+    }
+
+    return pos;
+}
+
+// Position of a film key in the table, or the empty position where it would be stored
+static int ingestTable_findFilm(const tIngestShard *shard, const char *name, unsigned int hash) {
+    const tIngestTable *table = &shard->filmKeys;
+    int mask = table->capacity - 1;
+    int pos = (int) (hash & (unsigned int) mask);
+
+    while (table->slots[pos].index != -1
+           && (table->slots[pos].hash != hash || strcmp(shard->films[table->slots[pos].index].name, name) != 0)) {
+        pos = (pos + 1) & mask;
+    }
+
+    return pos;
+}
+
+// Make room in a key table for one more key, keeping it at most half full. Slots keep their hash,
+// so they are moved without reading the keys
+static tApiError ingestTable_reserve(tIngestTable *table, const tAllocator *allocator) {
+    if (2 * (table->count + 1) <= table->capacity) {
+        return E_SUCCESS;
+    }
+
+    int capacity = table->capacity == 0 ? INGEST_TABLE_MIN : 2 * table->capacity;
+    tIngestSlot *slots = (tIngestSlot *) allocator_alloc(allocator, capacity * sizeof(tIngestSlot));
+    if (slots == NULL) {
+        return E_MEMORY_ERROR;
+    }
+    for (int pos = 0; pos < capacity; pos++) {
+        slots[pos].index = -1;
+    }
+    for (int i = 0; i < table->capacity; i++) {
+        if (table->slots[i].index != -1) {
+            int pos = (int) (table->slots[i].hash & (unsigned int) (capacity - 1));
+            while (slots[pos].index != -1) {
+                pos = (pos + 1) & (capacity - 1);
+            }
+            slots[pos] = table->slots[i];
+        }
+    }
+
+    allocator_free(allocator, table->slots);
+    table->slots = slots;
+    table->capacity = capacity;
+
+    return E_SUCCESS;
+}
+
+// Make room for one more record of a kind in a shard
+static tApiError ingestShard_reserve(tIngestShard *shard, tIngestKind kind, const tAllocator *allocator) {
+    int *count, *capacity, **rows;
+    void **records;
+    size_t size;
+
+    if (kind == INGEST_PERSON) {
+        count = &shard->peopleCount;
+        capacity = &shard->peopleCapacity;
+        rows = &shard->peopleRows;
+        records = (void **) &shard->people;
+        size = sizeof(tPerson);
+    } else if (kind == INGEST_SUBSCRIPTION) {
+        count = &shard->subscriptionCount;
+        capacity = &shard->subscriptionCapacity;
+        rows = &shard->subscriptionRows;
+        records = (void **) &shard->subscriptions;
+        size = sizeof(tSubscription);
+    } else {
+        count = &shard->filmCount;
+        capacity = &shard->filmCapacity;
+        rows = &shard->filmRows;
+        records = (void **) &shard->films;
+        size = sizeof(tFilm);
+    }
+
+    if (*count < *capacity) {
+        return E_SUCCESS;
+    }
+
+    int newCapacity = *capacity == 0 ? INGEST_TABLE_MIN : 2 * *capacity;
+    void *newRecords = allocator_realloc(allocator, *records, newCapacity * size);
+    if (newRecords == NULL) {
+        return E_MEMORY_ERROR;
+    }
+    *records = newRecords;
+    int *newRows = (int *) allocator_realloc(allocator, *rows, newCapacity * sizeof(int));
+    if (newRows == NULL) {
+        return E_MEMORY_ERROR;
+    }
+    *rows = newRows;
+    *capacity = newCapacity;
+
+    return E_SUCCESS;
+}
+
+// Start adding rows to the data
+tApiError ingest_init(tIngest *ingest, tApiData *data) {
+    assert(ingest != NULL);
+    assert(data != NULL);
+
+    ingest->data = data;
+    for (int i = 0; i < INGEST_SHARDS; i++) {
+        tIngestShard *shard = &ingest->shards[i];
+
+        ingestTable_init(&shard->peopleKeys);
+        ingestTable_init(&shard->subscriptionKeys);
+        ingestTable_init(&shard->filmKeys);
+        shard->people = NULL;
+        shard->peopleRows = NULL;
+        shard->peopleCount = 0;
+        shard->peopleCapacity = 0;
+        shard->subscriptions = NULL;
+        shard->subscriptionRows = NULL;
+        shard->subscriptionCount = 0;
+        shard->subscriptionCapacity = 0;
+        shard->films = NULL;
+        shard->filmRows = NULL;
+        shard->filmCount = 0;
+        shard->filmCapacity = 0;
+
+        if (mtx_init(&shard->lock, mtx_plain) != thrd_success) {
+            while (--i >= 0) {
+                mtx_destroy(&ingest->shards[i].lock);
+            }
+            return E_MEMORY_ERROR;
+        }
+    }
+
+    // KEYS OF THE CURRENT PEOPLE AND SUBSCRIPTIONS. FILMS ARE FOUND IN THE CATALOG NAME INDEX
+    for (int i = 0; i < data->people.count; i++) {
+        unsigned int hash = ingest_hashStr(data->people.elems[i].document);
+        tIngestShard *shard = ingest_shard(ingest, hash);
+        if (ingestTable_reserve(&shard->peopleKeys, data->allocator) != E_SUCCESS) {
+            ingest_free(ingest);
+            return E_MEMORY_ERROR;
+        }
+        int pos = ingestTable_findPerson(ingest, shard, data->people.elems[i].document, hash);
+        if (shard->peopleKeys.slots[pos].index == -1) {
+            shard->peopleKeys.slots[pos].hash = hash;
+            shard->peopleKeys.slots[pos].index = INGEST_EXISTING(i);
+            shard->peopleKeys.count++;
+        }
+    }
+    for (int i = 0; i < data->subscriptions.count; i++) {
+        unsigned int hash = ingest_hashInt(data->subscriptions.elems[i].id);
+        tIngestShard *shard = ingest_shard(ingest, hash);
+        if (ingestTable_reserve(&shard->subscriptionKeys, data->allocator) != E_SUCCESS) {
+            ingest_free(ingest);
+            return E_MEMORY_ERROR;
+        }
+        int pos = ingestTable_findSubscription(ingest, shard, data->subscriptions.elems[i].id, hash);
+        if (shard->subscriptionKeys.slots[pos].index == -1) {
+            shard->subscriptionKeys.slots[pos].hash = hash;
+            shard->subscriptionKeys.slots[pos].index = INGEST_EXISTING(i);
+            shard->subscriptionKeys.count++;
+        }
+    }
+
+    return E_SUCCESS;
+}
+
+// Add a person, taking ownership of it on success
+tApiError ingest_addPerson(tIngest *ingest, int row, tPerson person) {
+    assert(ingest != NULL);
+    assert(person.document != NULL);
+
+    unsigned int hash = ingest_hashStr(person.document);
+    tIngestShard *shard = ingest_shard(ingest, hash);
+    tApiError error = E_SUCCESS;
+
+    mtx_lock(&shard->lock);
+    if (ingestTable_reserve(&shard->peopleKeys, ingest->data->allocator) != E_SUCCESS
+        || ingestShard_reserve(shard, INGEST_PERSON, ingest->data->allocator) != E_SUCCESS) {
+        error = E_MEMORY_ERROR;
+    } else {
+        int pos = ingestTable_findPerson(ingest, shard, person.document, hash);
+        if (shard->peopleKeys.slots[pos].index != -1) {
+            error = E_PERSON_DUPLICATED;
+        } else {
+            shard->people[shard->peopleCount] = person;
+            shard->peopleRows[shard->peopleCount] = row;
+            shard->peopleKeys.slots[pos].hash = hash;
+            shard->peopleKeys.slots[pos].index = shard->peopleCount++;
+            shard->peopleKeys.count++;
+        }
+    }
+    mtx_unlock(&shard->lock);
+
+    return error;
+}
+
+// Add a subscription of a person added from an earlier row
+tApiError ingest_addSubscription(tIngest *ingest, int row, tSubscription subscription) {
+    assert(ingest != NULL);
+    bool personFound = false;
+
+    // PEOPLE ARE NEVER REMOVED WHILE INGESTING, SO THE ANSWER STAYS TRUE ONCE THE LOCK IS RELEASED.
+    // LATER ROWS ARE IGNORED, AS A SEQUENTIAL LOAD WOULD NOT HAVE ADDED THEM YET
+    unsigned int hash = ingest_hashStr(subscription.document);
+    tIngestShard *shard = ingest_shard(ingest, hash);
+    mtx_lock(&shard->lock);
+    if (shard->peopleKeys.capacity > 0) {
+        int index = shard->peopleKeys.slots[ingestTable_findPerson(ingest, shard, subscription.document, hash)].index;
+        personFound = index < -1 || (index >= 0 && shard->peopleRows[index] < row);
+    }
+    mtx_unlock(&shard->lock);
+
+    hash = ingest_hashInt(subscription.id);
+    shard = ingest_shard(ingest, hash);
+    tApiError error = E_SUCCESS;
+
+    mtx_lock(&shard->lock);
+    if (ingestTable_reserve(&shard->subscriptionKeys, ingest->data->allocator) != E_SUCCESS
+        || ingestShard_reserve(shard, INGEST_SUBSCRIPTION, ingest->data->allocator) != E_SUCCESS) {
+        error = E_MEMORY_ERROR;
+    } else {
+        int pos = ingestTable_findSubscription(ingest, shard, subscription.id, hash);
+        // SAME CHECKS AND ORDER AS subscriptions_add
+        if (shard->subscriptionKeys.slots[pos].index != -1) {
+            error = E_SUBSCRIPTION_DUPLICATED;
+        } else if (!personFound) {
+            error = E_PERSON_NOT_FOUND;
+        } else {
+            shard->subscriptions[shard->subscriptionCount] = subscription;
+            shard->subscriptionRows[shard->subscriptionCount] = row;
+            shard->subscriptionKeys.slots[pos].hash = hash;
+            shard->subscriptionKeys.slots[pos].index = shard->subscriptionCount++;
+            shard->subscriptionKeys.count++;
+        }
+    }
+    mtx_unlock(&shard->lock);
+
+    return error;
+}
+
+// Add a film, taking ownership of it on success
+tApiError ingest_addFilm(tIngest *ingest, int row, tFilm film) {
+    assert(ingest != NULL);
+    assert(film.name != NULL);
+
+    // The catalog is not changed while ingesting, so it can be read by every thread
+    if (catalog_find(&ingest->data->catalog, film.name) != FILM_HANDLE_NONE) {
+        return E_FILM_DUPLICATED;
+    }
+
+    unsigned int hash = ingest_hashStr(film.name);
+    tIngestShard *shard = ingest_shard(ingest, hash);
+    tApiError error = E_SUCCESS;
+
+    mtx_lock(&shard->lock);
+    if (ingestTable_reserve(&shard->filmKeys, ingest->data->allocator) != E_SUCCESS
+        || ingestShard_reserve(shard, INGEST_FILM, ingest->data->allocator) != E_SUCCESS) {
+        error = E_MEMORY_ERROR;
+    } else {
+        int pos = ingestTable_findFilm(shard, film.name, hash);
+        if (shard->filmKeys.slots[pos].index != -1) {
+            error = E_FILM_DUPLICATED;
+        } else {
+            shard->films[shard->filmCount] = film;
+            shard->filmRows[shard->filmCount] = row;
+            shard->filmKeys.slots[pos].hash = hash;
+            shard->filmKeys.slots[pos].index = shard->filmCount++;
+            shard->filmKeys.count++;
+        }
+    }
+    mtx_unlock(&shard->lock);
+
+    return error;
+}
+
+// Get the kind of a csv line and the shard owning the key of its record
+tIngestKind ingest_classify(const char *line, int *shard) {
+    assert(line != NULL);
+    assert(shard != NULL);
+    char key[FILE_READ_BUFFER_SIZE];
+    tIngestKind kind;
+    unsigned int hash;
+
+    const char *field = strchr(line, ';');
+    if (field == NULL) {
+        return INGEST_INVALID;
+    }
+    if ((size_t) (field - line) == strlen("PERSON") && strncmp(line, "PERSON", field - line) == 0) {
+        kind = INGEST_PERSON;
+    } else if ((size_t) (field - line) == strlen("SUBSCRIPTION") && strncmp(line, "SUBSCRIPTION", field - line) == 0) {
+        kind = INGEST_SUBSCRIPTION;
+    } else if ((size_t) (field - line) == strlen("FILM") && strncmp(line, "FILM", field - line) == 0) {
+        kind = INGEST_FILM;
+    } else {
+        return INGEST_INVALID;
+    }
+
+    // THE KEY IS THE FIRST FIELD OF THE PERSON AND FILM RECORDS, AND THE ID OF THE SUBSCRIPTION
+    field++;
+    size_t length = strcspn(field, ";");
+    if (length >= sizeof(key)) {
+        length = sizeof(key) - 1;
+    }
+    memcpy(key, field, length);
+    key[length] = '\0';
+    if (kind == INGEST_SUBSCRIPTION) {
+        hash = ingest_hashInt(atoi(key));
+    } else {
+        hash = ingest_hashStr(key);
+    }
+    *shard = (int) ((hash >> 24) % INGEST_SHARDS);
+
+    return kind;
+}
+
+// Parse and add an entry of any type
+tApiError ingest_addEntry(tIngest *ingest, int row, tCSVEntry entry) {
+    assert(ingest != NULL);
+    tApiError error;
+
+    if (strcmp(entry.type, "PERSON") == 0) {
+        if (csv_numFields(entry) != NUM_FIELDS_PERSON) {
+            return E_INVALID_ENTRY_FORMAT;
+        }
+        tPerson newPerson;
+        person_parse(&newPerson, entry, ingest->data->allocator);
+        error = ingest_addPerson(ingest, row, newPerson);
+        if (error != E_SUCCESS) {
+            person_free(&newPerson, ingest->data->allocator);
+        }
+    } else if (strcmp(entry.type, "SUBSCRIPTION") == 0) {
+        if (csv_numFields(entry) != NUM_FIELDS_SUBSCRIPTION) {
+            return E_INVALID_ENTRY_FORMAT;
+        }
+        tSubscription newSubs;
+        subscription_parse(&newSubs, entry);
+        error = ingest_addSubscription(ingest, row, newSubs);
+    } else if (strcmp(entry.type, "FILM") == 0) {
+        if (csv_numFields(entry) != NUM_FIELDS_FILM) {
+            return E_INVALID_ENTRY_FORMAT;
+        }
+        tFilm newFilm;
+        film_parse(&newFilm, entry, ingest->data->allocator);
+        error = ingest_addFilm(ingest, row, newFilm);
+        if (error != E_SUCCESS) {
+            film_free(&newFilm, ingest->data->allocator);
+        }
+    } else {
+        error = E_INVALID_ENTRY_TYPE;
+    }
+
+    return error;
+}
+
+// Order records by the row they came from
+static int ingest_compareRef(const void *a, const void *b) {
+    const tIngestRef *refA = (const tIngestRef *) a;
+    const tIngestRef *refB = (const tIngestRef *) b;
+
+    return (refA->row > refB->row) - (refA->row < refB->row);
+}
+
+// Get the records of a kind of every shard sorted by row. Return NULL if there is no memory available
+static tIngestRef *ingest_sortedRefs(tIngest *ingest, tIngestKind kind, int *count) {
+    *count = 0;
+    for (int i = 0; i < INGEST_SHARDS; i++) {
+        tIngestShard *shard = &ingest->shards[i];
+        *count += kind == INGEST_PERSON ? shard->peopleCount
+                  : kind == INGEST_SUBSCRIPTION ? shard->subscriptionCount : shard->filmCount;
+    }
+
+    tIngestRef *refs = (tIngestRef *) allocator_alloc(ingest->data->allocator, (*count > 0 ? *count : 1) * sizeof(tIngestRef));
+    if (refs == NULL) {
+        return NULL;
+    }
+
+    int pos = 0;
+    for (int i = 0; i < INGEST_SHARDS; i++) {
+        tIngestShard *shard = &ingest->shards[i];
+        int shardCount = kind == INGEST_PERSON ? shard->peopleCount
+                         : kind == INGEST_SUBSCRIPTION ? shard->subscriptionCount : shard->filmCount;
+        const int *rows = kind == INGEST_PERSON ? shard->peopleRows
+                          : kind == INGEST_SUBSCRIPTION ? shard->subscriptionRows : shard->filmRows;
+        for (int j = 0; j < shardCount; j++) {
+            refs[pos].row = rows[j];
+            refs[pos].shard = i;
+            refs[pos].index = j;
+            pos++;
+        }
+    }
+    if (*count > 1) {
+        qsort(refs, *count, sizeof(tIngestRef), ingest_compareRef);
+    }
+
+    return refs;
+}
+
+// Move the added records to the data in row order
+tApiError ingest_finish(tIngest *ingest) {
+    assert(ingest != NULL);
+    tApiData *data = ingest->data;
+    tIngestRef *refs;
+    int count;
+
+    // PEOPLE, THEIR FIELDS ARE COPIED INTO THE STRINGS OF THE DATA
+    refs = ingest_sortedRefs(ingest, INGEST_PERSON, &count);
+    if (refs == NULL) {
+        ingest_free(ingest);
+        return E_MEMORY_ERROR;
+    }
+    for (int i = 0; i < count; i++) {
+        tIngestShard *shard = &ingest->shards[refs[i].shard];
+        if (people_append(&data->people, shard->people[refs[i].index]) != E_SUCCESS) {
+            allocator_free(data->allocator, refs);
+            ingest_free(ingest);
+            return E_MEMORY_ERROR;
+        }
+    }
+    allocator_free(data->allocator, refs);
+
+    // SUBSCRIPTIONS
+    refs = ingest_sortedRefs(ingest, INGEST_SUBSCRIPTION, &count);
+    if (refs == NULL) {
+        ingest_free(ingest);
+        return E_MEMORY_ERROR;
+    }
+    for (int i = 0; i < count; i++) {
+        tIngestShard *shard = &ingest->shards[refs[i].shard];
+        if (subscriptions_append(&data->subscriptions, shard->subscriptions[refs[i].index]) != E_SUCCESS) {
+            allocator_free(data->allocator, refs);
+            ingest_free(ingest);
+            return E_MEMORY_ERROR;
+        }
+    }
+    allocator_free(data->allocator, refs);
+
+    // FILMS, THE CATALOG KEEPS ITS OWN COPY AND UPDATES THE INDEXES
+    refs = ingest_sortedRefs(ingest, INGEST_FILM, &count);
+    if (refs == NULL) {
+        ingest_free(ingest);
+        return E_MEMORY_ERROR;
+    }
+    tApiError error = E_SUCCESS;
+    for (int i = 0; i < count && error == E_SUCCESS; i++) {
+        tIngestShard *shard = &ingest->shards[refs[i].shard];
+        error = catalog_add(&data->catalog, shard->films[refs[i].index]);
+    }
+    allocator_free(data->allocator, refs);
+
+    ingest_free(ingest);
+
+    return error;
+}
+
+// Discard the added records and remove the ingestion data
+void ingest_free(tIngest *ingest) {
+    assert(ingest != NULL);
+
+    for (int i = 0; i < INGEST_SHARDS; i++) {
+        tIngestShard *shard = &ingest->shards[i];
+
+        for (int j = 0; j < shard->peopleCount; j++) {
+            person_free(&shard->people[j], ingest->data->allocator);
+        }
+        for (int j = 0; j < shard->filmCount; j++) {
+            film_free(&shard->films[j], ingest->data->allocator);
+        }
+        allocator_free(ingest->data->allocator, shard->people);
+        allocator_free(ingest->data->allocator, shard->peopleRows);
+        allocator_free(ingest->data->allocator, shard->subscriptions);
+        allocator_free(ingest->data->allocator, shard->subscriptionRows);
+        allocator_free(ingest->data->allocator, shard->films);
+        allocator_free(ingest->data->allocator, shard->filmRows);
+        allocator_free(ingest->data->allocator, shard->peopleKeys.slots);
+        allocator_free(ingest->data->allocator, shard->subscriptionKeys.slots);
+        allocator_free(ingest->data->allocator, shard->filmKeys.slots);
+        mtx_destroy(&shard->lock);
+
+        shard->people = NULL;
+        shard->peopleRows = NULL;
+        shard->peopleCount = 0;
+        shard->peopleCapacity = 0;
+        shard->subscriptions = NULL;
+        shard->subscriptionRows = NULL;
+        shard->subscriptionCount = 0;
+        shard->subscriptionCapacity = 0;
+        shard->films = NULL;
+        shard->filmRows = NULL;
+        shard->filmCount = 0;
+        shard->filmCapacity = 0;
+        ingestTable_init(&shard->peopleKeys);
+        ingestTable_init(&shard->subscriptionKeys);
+        ingestTable_init(&shard->filmKeys);
+    }
+}
@@ -5,7 +5,7 @@
 #include "person.h"
 
 // Parse input from CSVEntry
-void person_parse(tPerson* data, tCSVEntry entry) {
+void person_parse(tPerson* data, tCSVEntry entry, const tAllocator* allocator) {
     // Check input data
     assert(data != NULL);
     
@@ -13,43 +13,43 @@ void person_parse(tPerson* data, tCSVEntry entry) {
     assert(csv_numFields(entry) == NUM_FIELDS_PERSON);
       
     // Copy identity document data
-    data->document = (char*) malloc((strlen(entry.fields[0]) + 1) * sizeof(char));
+    data->document = (char*) allocator_alloc(allocator, (strlen(entry.fields[0]) + 1) * sizeof(char));
     assert(data->document != NULL);
     memset(data->document, 0, (strlen(entry.fields[0]) + 1) * sizeof(char));
     csv_getAsString(entry, 0, data->document, strlen(entry.fields[0]) + 1);
     
     // Copy name data
-    data->name = (char*) malloc((strlen(entry.fields[1]) + 1) * sizeof(char));
+    data->name = (char*) allocator_alloc(allocator, (strlen(entry.fields[1]) + 1) * sizeof(char));
     assert(data->name != NULL);
     memset(data->name, 0, (strlen(entry.fields[1]) + 1) * sizeof(char));
     csv_getAsString(entry, 1, data->name, strlen(entry.fields[1]) + 1);
     
     // Copy surname data
-    data->surname = (char*) malloc((strlen(entry.fields[2]) + 1) * sizeof(char));
+    data->surname = (char*) allocator_alloc(allocator, (strlen(entry.fields[2]) + 1) * sizeof(char));
     assert(data->surname != NULL);
     memset(data->surname, 0, (strlen(entry.fields[2]) + 1) * sizeof(char));
     csv_getAsString(entry, 2, data->surname, strlen(entry.fields[2]) + 1);
     
     // Copy phone data
-    data->phone = (char*) malloc((strlen(entry.fields[3]) + 1) * sizeof(char));
+    data->phone = (char*) allocator_alloc(allocator, (strlen(entry.fields[3]) + 1) * sizeof(char));
     assert(data->phone != NULL);
     memset(data->phone, 0, (strlen(entry.fields[3]) + 1) * sizeof(char));
     csv_getAsString(entry, 3, data->phone, strlen(entry.fields[3]) + 1);
 
     // Copy email data
-    data->email = (char*) malloc((strlen(entry.fields[4]) + 1) * sizeof(char));
+    data->email = (char*) allocator_alloc(allocator, (strlen(entry.fields[4]) + 1) * sizeof(char));
     assert(data->email != NULL);
     memset(data->email, 0, (strlen(entry.fields[4]) + 1) * sizeof(char));
     csv_getAsString(entry, 4, data->email, strlen(entry.fields[4]) + 1);
     
     // Copy address data
-    data->address = (char*) malloc((strlen(entry.fields[5]) + 1) * sizeof(char));
+    data->address = (char*) allocator_alloc(allocator, (strlen(entry.fields[5]) + 1) * sizeof(char));
     assert(data->address != NULL);
     memset(data->address, 0, (strlen(entry.fields[5]) + 1) * sizeof(char));
     csv_getAsString(entry, 5, data->address, strlen(entry.fields[5]) + 1);
     
     // Copy cp data
-    data->cp = (char*) malloc((strlen(entry.fields[6]) + 1) * sizeof(char));
+    data->cp = (char*) allocator_alloc(allocator, (strlen(entry.fields[6]) + 1) * sizeof(char));
     assert(data->cp != NULL);
     memset(data->cp, 0, (strlen(entry.fields[6]) + 1) * sizeof(char));
     csv_getAsString(entry, 6, data->cp, strlen(entry.fields[6]) + 1);
@@ -61,39 +61,39 @@ void person_parse(tPerson* data, tCSVEntry entry) {
 }
 
 // Copy the data from the source to destination
-void person_cpy(tPerson* destination, tPerson source) {
+void person_cpy(tPerson* destination, tPerson source, const tAllocator* allocator) {
     // Copy identity document data
-    destination->document = (char*) malloc((strlen(source.document) + 1) * sizeof(char));
+    destination->document = (char*) allocator_alloc(allocator, (strlen(source.document) + 1) * sizeof(char));
     assert(destination->document != NULL);
     strcpy(destination->document, source.document);
     
     // Copy name data
-    destination->name = (char*) malloc((strlen(source.name) + 1) * sizeof(char));
+    destination->name = (char*) allocator_alloc(allocator, (strlen(source.name) + 1) * sizeof(char));
     assert(destination->name != NULL);
     strcpy(destination->name, source.name);
     
     // Copy surname data
-    destination->surname = (char*) malloc((strlen(source.surname) + 1) * sizeof(char));
+    destination->surname = (char*) allocator_alloc(allocator, (strlen(source.surname) + 1) * sizeof(char));
     assert(destination->surname != NULL);
     strcpy(destination->surname, source.surname);
     
     // Copy phone data
-    destination->phone = (char*) malloc((strlen(source.phone) + 1) * sizeof(char));
+    destination->phone = (char*) allocator_alloc(allocator, (strlen(source.phone) + 1) * sizeof(char));
     assert(destination->phone != NULL);
     strcpy(destination->phone, source.phone);
 
     // Copy email data
-    destination->email = (char*) malloc((strlen(source.email) + 1) * sizeof(char));
+    destination->email = (char*) allocator_alloc(allocator, (strlen(source.email) + 1) * sizeof(char));
     assert(destination->email != NULL);
     strcpy(destination->email, source.email);
     
     // Copy address data
-    destination->address = (char*) malloc((strlen(source.address) + 1) * sizeof(char));
+    destination->address = (char*) allocator_alloc(allocator, (strlen(source.address) + 1) * sizeof(char));
     assert(destination->address != NULL);
     strcpy(destination->address, source.address);
     
     // Copy cp data
-    destination->cp = (char*) malloc((strlen(source.cp) + 1) * sizeof(char));
+    destination->cp = (char*) allocator_alloc(allocator, (strlen(source.cp) + 1) * sizeof(char));
     assert(destination->cp != NULL);
     strcpy(destination->cp, source.cp);
     
@@ -102,46 +102,49 @@ void person_cpy(tPerson* destination, tPerson source) {
 }
 
 // Remove the data from a person
-void person_free(tPerson* data) {
+void person_free(tPerson* data, const tAllocator* allocator) {
     // Check input data
     assert(data != NULL);
     
     // Release document data
-    if(data->document != NULL) free(data->document);
+    if(data->document != NULL) allocator_free(allocator, data->document);
     data->document = NULL;
     
     // Release name data
-    if(data->name != NULL) free(data->name);
+    if(data->name != NULL) allocator_free(allocator, data->name);
     data->name = NULL;
     
     // Release surname data
-    if(data->surname != NULL) free(data->surname);
+    if(data->surname != NULL) allocator_free(allocator, data->surname);
     data->surname = NULL;
     
     // Release phone data
-    if(data->phone != NULL) free(data->phone);
+    if(data->phone != NULL) allocator_free(allocator, data->phone);
     data->phone = NULL;
     
     // Release email data
-    if(data->email != NULL) free(data->email);
+    if(data->email != NULL) allocator_free(allocator, data->email);
     data->email = NULL;
     
     // Release address data
-    if(data->address != NULL) free(data->address);
+    if(data->address != NULL) allocator_free(allocator, data->address);
     data->address = NULL;
     
     // Release cp data
-    if(data->cp != NULL) free(data->cp);
+    if(data->cp != NULL) allocator_free(allocator, data->cp);
     data->cp = NULL;
 }
 
 // Initialize the people data
-tApiError people_init(tPeople* data) {
+tApiError people_init(tPeople* data, const tAllocator* allocator) {
     // Check input/output data
     assert(data != NULL);
     
     data->elems = NULL;
     data->count = 0;
+    data->capacity = 0;
+    data->allocator = allocator;
+    stringArena_init(&data->strings, allocator);
 	
 	return E_SUCCESS;
 }
@@ -160,18 +163,42 @@ tApiError people_add(tPeople* data, tPerson person) {
 	if (people_find(data[0], person.document) >= 0)
 		return E_PERSON_DUPLICATED;
 	
-    // Allocate memory for new element
-	if (data->count == 0) {
-		// Request new memory space
-		data->elems = (tPerson*) malloc(sizeof(tPerson));            
-	} else {
-		// Modify currently allocated memory
-		data->elems = (tPerson*) realloc(data->elems, (data->count + 1) * sizeof(tPerson));            
+	return people_append(data, person);
+}
+
+// Add a person known not to exist
+tApiError people_append(tPeople* data, tPerson person) {
+    tPerson* elems;
+    tPerson* newPerson;
+    
+    // Check input data
+    assert(data != NULL);
+    
+    // Allocate memory for new elements, doubling it when it is full
+	if (data->count == data->capacity) {
+		int capacity = data->capacity == 0 ? 16 : 2 * data->capacity;
+		elems = (tPerson*) allocator_realloc(data->allocator, data->elems, capacity * sizeof(tPerson));
+		if (elems == NULL)
+			return E_MEMORY_ERROR;
+		data->elems = elems;
+		data->capacity = capacity;
 	}
-	assert(data->elems != NULL);
-			
+	
+	// Make room for all the fields, so their copies can not fail
+	if (!stringArena_reserve(&data->strings, strlen(person.document) + strlen(person.name) + strlen(person.surname)
+			+ strlen(person.phone) + strlen(person.email) + strlen(person.address) + strlen(person.cp) + 7))
+		return E_MEMORY_ERROR;
+	
 	// Copy the data to the new position
-	person_cpy(&(data->elems[data->count]), person);
+	newPerson = &(data->elems[data->count]);
+	newPerson->document = stringArena_dup(&data->strings, person.document);
+	newPerson->name = stringArena_dup(&data->strings, person.name);
+	newPerson->surname = stringArena_dup(&data->strings, person.surname);
+	newPerson->phone = stringArena_dup(&data->strings, person.phone);
+	newPerson->email = stringArena_dup(&data->strings, person.email);
+	newPerson->address = stringArena_dup(&data->strings, person.address);
+	newPerson->cp = stringArena_dup(&data->strings, person.cp);
+	newPerson->birthday = person.birthday;
 	
 	// Increase the number of elements
 	data->count ++;
@@ -179,6 +206,30 @@ tApiError people_add(tPeople* data, tPerson person) {
 	return E_SUCCESS;
 }
 
+// Move the fields of the people to a new arena when most of the old one is released
+static void people_packStrings(tPeople* data) {
+    tStringArena strings;
+    int i;
+    
+    // Reserve all the space at once, so copying the fields can not fail
+    stringArena_init(&strings, data->allocator);
+    if (!stringArena_reserve(&strings, data->strings.used))
+        return;
+    
+    for(i = 0; i < data->count; i++) {
+        data->elems[i].document = stringArena_dup(&strings, data->elems[i].document);
+        data->elems[i].name = stringArena_dup(&strings, data->elems[i].name);
+        data->elems[i].surname = stringArena_dup(&strings, data->elems[i].surname);
+        data->elems[i].phone = stringArena_dup(&strings, data->elems[i].phone);
+        data->elems[i].email = stringArena_dup(&strings, data->elems[i].email);
+        data->elems[i].address = stringArena_dup(&strings, data->elems[i].address);
+        data->elems[i].cp = stringArena_dup(&strings, data->elems[i].cp);
+    }
+    
+    stringArena_free(&data->strings);
+    data->strings = strings;
+}
+
 // Remove a person
 tApiError people_del(tPeople* data, const char *document) {
     int i;
@@ -194,8 +245,14 @@ tApiError people_del(tPeople* data, const char *document) {
 	if (pos < 0)
 		return E_PERSON_NOT_FOUND;
 	
-	// Remove current position memory
-	person_free(&(data->elems[pos]));
+	// Its fields are recovered when most of the arena is released, or when the people are removed
+	stringArena_release(&data->strings, data->elems[pos].document);
+	stringArena_release(&data->strings, data->elems[pos].name);
+	stringArena_release(&data->strings, data->elems[pos].surname);
+	stringArena_release(&data->strings, data->elems[pos].phone);
+	stringArena_release(&data->strings, data->elems[pos].email);
+	stringArena_release(&data->strings, data->elems[pos].address);
+	stringArena_release(&data->strings, data->elems[pos].cp);
 	// Shift elements 
 	for(i = pos; i < data->count-1; i++) {
 		// Copy address of element on position i+1 to position i
@@ -206,13 +263,22 @@ tApiError people_del(tPeople* data, const char *document) {
 	// Resize the used memory
 	if (data->count == 0) {
 		// No element remaining
-		free(data->elems);
+		allocator_free(data->allocator, data->elems);
 		data->elems = NULL;
-	} else {
-		// Still some elements are remaining
-		data->elems = (tPerson*)realloc(data->elems, data->count * sizeof(tPerson));
+		data->capacity = 0;
+	} else if (data->count < data->capacity / 4) {
+		// Still some elements are remaining. If the memory can not shrink, the bigger block is kept
+		tPerson* elems = (tPerson*) allocator_realloc(data->allocator, data->elems, 2 * data->count * sizeof(tPerson));
+		if (elems != NULL) {
+			data->elems = elems;
+			data->capacity = 2 * data->count;
+		}
 	}
 	
+	// Recover the memory of the removed fields
+	if (stringArena_isFragmented(data->strings))
+		people_packStrings(data);
+	
 	return E_SUCCESS;
 }
 
@@ -251,22 +317,17 @@ void people_print(tPeople data) {
 
 // Remove the data from all persons
 tApiError people_free(tPeople* data) {
-    int i;
-    
     // Check input data
     assert(data != NULL);
     
-    // Remove contents
-    for(i = 0; i < data->count; i++) {
-        person_free(&(data->elems[i]));
-    }    
+    // Remove the fields of every person at once
+    stringArena_free(&data->strings);
     
     // Release memory
-    if (data->count > 0) {
-        free(data->elems);
-        data->elems = NULL;
-        data->count = 0;
-    }
+    allocator_free(data->allocator, data->elems);
+    data->elems = NULL;
+    data->count = 0;
+    data->capacity = 0;
 	
 	return E_SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,509 @@
+// MAP_ANONYMOUS, MAP_HUGETLB and madvise are not POSIX
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <assert.h>
+#include <string.h>
+#include "pool.h"
+
+#if defined(_WIN32) && !defined(POOL_NO_HUGE_PAGES)
+#include <windows.h>
+#elif defined(__linux__) && !defined(POOL_NO_HUGE_PAGES)
+#include <sys/mman.h>
+#endif
+
+// Alignment of the elements and strings stored in pools and arenas
+#define POOL_ALIGN (sizeof(max_align_t))
+
+// Round a size up to the pool alignment
+#define POOL_ROUND(size) (((size) + POOL_ALIGN - 1) / POOL_ALIGN * POOL_ALIGN)
+
+// Round a size up to a whole number of huge pages
+#define POOL_HUGE_ROUND(size) (((size) + POOL_HUGE_PAGE_SIZE - 1) / POOL_HUGE_PAGE_SIZE * POOL_HUGE_PAGE_SIZE)
+
+// Get a block of memory of the given size, which is updated to the size really given. Without an allocator,
+// big blocks are mapped with huge pages when available, to need fewer TLB entries. NULL if there is no memory available
+static void *pool_allocBlock(const tAllocator *allocator, size_t *size) {
+    if (allocator != NULL)
+        return allocator_alloc(allocator, *size);
+
+#if defined(_WIN32) && !defined(POOL_NO_HUGE_PAGES)
+    if (*size >= POOL_HUGE_PAGE_SIZE) {
+        // LARGE PAGES NEED THE LOCK PAGES PRIVILEGE, OTHERWISE USE NORMAL ONES
+        size_t large = GetLargePageMinimum();
+        if (large > 0) {
+            size_t rounded = (*size + large - 1) / large * large;
+            void *block = VirtualAlloc(NULL, rounded, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+            if (block != NULL) {
+                *size = rounded;
+                return block;
+            }
+        }
+        return VirtualAlloc(NULL, *size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    }
+#elif defined(__linux__) && !defined(POOL_NO_HUGE_PAGES)
+    if (*size >= POOL_HUGE_PAGE_SIZE) {
+        size_t rounded = POOL_HUGE_ROUND(*size);
+        void *block = MAP_FAILED;
+#ifdef MAP_HUGETLB
+        // RESERVED HUGE PAGES FIRST, THEN TRANSPARENT ONES
+        block = mmap(NULL, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+        if (block == MAP_FAILED) {
+            block = mmap(NULL, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (block == MAP_FAILED)
+                return NULL;
+#ifdef MADV_HUGEPAGE
+            madvise(block, rounded, MADV_HUGEPAGE);
+#endif
+        }
+        *size = rounded;
+        return block;
+    }
+#endif
+    return malloc(*size);
+}
+
+// Give back a block of memory of the size returned by pool_allocBlock
+static void pool_freeBlock(const tAllocator *allocator, void *block, size_t size) {
+    if (allocator != NULL) {
+        allocator_free(allocator, block);
+        return;
+    }
+
+#if defined(_WIN32) && !defined(POOL_NO_HUGE_PAGES)
+    if (size >= POOL_HUGE_PAGE_SIZE) {
+        VirtualFree(block, 0, MEM_RELEASE);
+        return;
+    }
+#elif defined(__linux__) && !defined(POOL_NO_HUGE_PAGES)
+    if (size >= POOL_HUGE_PAGE_SIZE) {
+        munmap(block, size);
+        return;
+    }
+#endif
+    free(block);
+}
+
+// Initialize a pool of elements of the given size
+void pool_init(tPool *pool, size_t elemSize, const tAllocator *allocator) {
+    // Check preconditions
+    assert(pool != NULL);
+    assert(elemSize > 0);
+
+    // Released elements store the link to the next one
+    if (elemSize < sizeof(tPoolFreeElem))
+        elemSize = sizeof(tPoolFreeElem);
+
+    pool->elemSize = POOL_ROUND(elemSize);
+    pool->slabs = NULL;
+    pool->freeElems = NULL;
+    pool->next = NULL;
+    pool->end = NULL;
+    pool->slabElems = POOL_SLAB_ELEMS;
+    pool->count = 0;
+    pool->allocator = allocator;
+}
+
+// Get memory for one element. NULL if there is no memory available
+void *pool_alloc(tPool *pool) {
+    // Check preconditions
+    assert(pool != NULL);
+
+    void *elem;
+
+    if (pool->freeElems != NULL) {
+        // Reuse a released element
+        elem = pool->freeElems;
+        pool->freeElems = pool->freeElems->next;
+    } else {
+        if (pool->next == pool->end) {
+            // Request a new slab, twice the previous one
+            size_t size = POOL_ROUND(sizeof(tPoolSlab)) + pool->slabElems * pool->elemSize;
+            tPoolSlab *slab = (tPoolSlab *) pool_allocBlock(pool->allocator, &size);
+            if (slab == NULL)
+                return NULL;
+
+            slab->next = pool->slabs;
+            slab->size = size;
+            pool->slabs = slab;
+            pool->next = (char *) slab + POOL_ROUND(sizeof(tPoolSlab));
+            // A rounded up block has room for more elements
+            pool->end = pool->next + (size - POOL_ROUND(sizeof(tPoolSlab))) / pool->elemSize * pool->elemSize;
+            if (2 * pool->slabElems * pool->elemSize <= POOL_MAX_BLOCK_SIZE)
+                pool->slabElems *= 2;
+        }
+        elem = pool->next;
+        pool->next += pool->elemSize;
+    }
+
+    pool->count++;
+
+    return elem;
+}
+
+// Give back one element to the pool
+void pool_release(tPool *pool, void *elem) {
+    // Check preconditions
+    assert(pool != NULL);
+    assert(elem != NULL);
+    assert(pool->count > 0);
+
+    tPoolFreeElem *freeElem = (tPoolFreeElem *) elem;
+    freeElem->next = pool->freeElems;
+    pool->freeElems = freeElem;
+    pool->count--;
+}
+
+// Return the number of elements in use
+int pool_count(tPool pool) {
+    return pool.count;
+}
+
+// Remove all the memory of the pool
+void pool_free(tPool *pool) {
+    // Check preconditions
+    assert(pool != NULL);
+
+    tPoolSlab *slab = pool->slabs, *auxSlab;
+
+    while (slab != NULL) {
+        auxSlab = slab->next;
+        pool_freeBlock(pool->allocator, slab, slab->size);
+        slab = auxSlab;
+    }
+
+    pool_init(pool, pool->elemSize, pool->allocator);
+}
+
+// Initialize a string arena
+void stringArena_init(tStringArena *arena, const tAllocator *allocator) {
+    // Check preconditions
+    assert(arena != NULL);
+
+    arena->chunks = NULL;
+    arena->next = NULL;
+    arena->end = NULL;
+    arena->chunkSize = ARENA_CHUNK_SIZE;
+    arena->used = 0;
+    arena->wasted = 0;
+    arena->allocator = allocator;
+}
+
+// Make room for size bytes of strings in the current chunk
+bool stringArena_reserve(tStringArena *arena, size_t size) {
+    // Check preconditions
+    assert(arena != NULL);
+
+    if ((size_t) (arena->end - arena->next) >= size)
+        return true;
+
+    // Request a new chunk, twice the previous one and big enough for long strings
+    if (size < arena->chunkSize)
+        size = arena->chunkSize;
+    size_t blockSize = POOL_ROUND(sizeof(tArenaChunk)) + size;
+    tArenaChunk *chunk = (tArenaChunk *) pool_allocBlock(arena->allocator, &blockSize);
+    if (chunk == NULL)
+        return false;
+
+    // The space left in the previous chunk is not used anymore
+    arena->wasted += arena->end - arena->next;
+
+    chunk->next = arena->chunks;
+    chunk->size = blockSize;
+    arena->chunks = chunk;
+    arena->next = (char *) chunk + POOL_ROUND(sizeof(tArenaChunk));
+    arena->end = (char *) chunk + blockSize;
+    if (2 * arena->chunkSize <= POOL_MAX_BLOCK_SIZE)
+        arena->chunkSize *= 2;
+
+    return true;
+}
+
+// Copy a string into the arena. NULL if there is no memory available
+char *stringArena_dup(tStringArena *arena, const char *str) {
+    // Check preconditions
+    assert(arena != NULL);
+    assert(str != NULL);
+
+    size_t len = strlen(str) + 1;
+
+    if (!stringArena_reserve(arena, len))
+        return NULL;
+
+    char *copy = arena->next;
+    memcpy(copy, str, len);
+    arena->next += len;
+    arena->used += len;
+
+    return copy;
+}
+
+// Mark a string of the arena as not used
+void stringArena_release(tStringArena *arena, const char *str) {
+    // Check preconditions
+    assert(arena != NULL);
+    assert(str != NULL);
+
+    size_t len = strlen(str) + 1;
+    assert(arena->used >= len);
+
+    arena->used -= len;
+    arena->wasted += len;
+}
+
+// Check if most of the arena memory is used by released strings
+bool stringArena_isFragmented(tStringArena arena) {
+    return arena.wasted > ARENA_CHUNK_SIZE && arena.wasted > arena.used;
+}
+
+// Remove all the strings of the arena
+void stringArena_free(tStringArena *arena) {
+    // Check preconditions
+    assert(arena != NULL);
+
+    tArenaChunk *chunk = arena->chunks, *auxChunk;
+
+    while (chunk != NULL) {
+        auxChunk = chunk->next;
+        pool_freeBlock(arena->allocator, chunk, chunk->size);
+        chunk = auxChunk;
+    }
+
+    stringArena_init(arena, arena->allocator);
+}
+
+// Header stored before each block of a block arena
+typedef struct _tBlockArenaHeader {
+    // Size class of the block, BLOCK_ARENA_CLASSES for big blocks
+    size_t sizeClass;
+} tBlockArenaHeader;
+
+// Bytes before the data of every block, and before the header of big blocks
+#define BLOCK_ARENA_HEADER POOL_ROUND(sizeof(tBlockArenaHeader))
+#define BLOCK_ARENA_BIG_HEADER POOL_ROUND(sizeof(tBlockArenaBig))
+
+// Get the bytes of a size class: multiples of 16 up to 64 bytes, then four classes between powers of two
+static size_t blockArena_classSize(int sizeClass) {
+    if (sizeClass < 3)
+        return (size_t) (sizeClass + 1) * 16;
+
+    int step = sizeClass - 3;
+    return (size_t) (4 + step % 4) << (step / 4 + 4);
+}
+
+// Get the smallest size class with room for size bytes
+static int blockArena_sizeClass(size_t size) {
+    if (size <= 64)
+        return size == 0 ? 0 : (int) ((size - 1) / 16);
+
+    // 2^power < size <= 2^(power + 1)
+    int power = 6;
+    while (((size_t) 1 << (power + 1)) < size)
+        power++;
+    size_t quarter = (size_t) 1 << (power - 2);
+
+    return 3 + (power - 6) * 4 + (int) ((size - ((size_t) 1 << power) + quarter - 1) / quarter);
+}
+
+// Functions of the allocator of a block arena
+static void *blockArena_allocFn(void *context, size_t size) {
+    return blockArena_alloc((tBlockArena *) context, size);
+}
+
+static void *blockArena_reallocFn(void *context, void *ptr, size_t size) {
+    return blockArena_realloc((tBlockArena *) context, ptr, size);
+}
+
+static void blockArena_freeFn(void *context, void *ptr) {
+    blockArena_release((tBlockArena *) context, ptr);
+}
+
+// Initialize a block arena
+void blockArena_init(tBlockArena *arena, const tAllocator *allocator) {
+    // Check preconditions
+    assert(arena != NULL);
+
+    arena->chunks = NULL;
+    arena->next = NULL;
+    arena->end = NULL;
+    arena->chunkSize = ARENA_CHUNK_SIZE;
+    for (int i = 0; i < BLOCK_ARENA_CLASSES; i++) {
+        arena->freeBlocks[i] = NULL;
+    }
+    arena->bigBlocks = NULL;
+    arena->allocator = allocator;
+    arena->blocks.alloc = blockArena_allocFn;
+    arena->blocks.realloc = blockArena_reallocFn;
+    arena->blocks.free = blockArena_freeFn;
+    arena->blocks.context = arena;
+}
+
+// Get a block bigger than BLOCK_ARENA_MAX_SIZE, linked to the other big blocks
+static void *blockArena_allocBig(tBlockArena *arena, size_t size) {
+    if (size > SIZE_MAX - BLOCK_ARENA_BIG_HEADER - BLOCK_ARENA_HEADER)
+        return NULL;
+
+    tBlockArenaBig *big = (tBlockArenaBig *) allocator_alloc(arena->allocator, BLOCK_ARENA_BIG_HEADER + BLOCK_ARENA_HEADER + size);
+    if (big == NULL)
+        return NULL;
+
+    big->prev = NULL;
+    big->next = arena->bigBlocks;
+    big->size = size;
+    if (arena->bigBlocks != NULL)
+        arena->bigBlocks->prev = big;
+    arena->bigBlocks = big;
+
+    tBlockArenaHeader *header = (tBlockArenaHeader *) ((char *) big + BLOCK_ARENA_BIG_HEADER);
+    header->sizeClass = BLOCK_ARENA_CLASSES;
+
+    return (char *) header + BLOCK_ARENA_HEADER;
+}
+
+// Get a block of size bytes. NULL if there is no memory available
+void *blockArena_alloc(tBlockArena *arena, size_t size) {
+    // Check preconditions
+    assert(arena != NULL);
+
+    if (size > BLOCK_ARENA_MAX_SIZE)
+        return blockArena_allocBig(arena, size);
+
+    int sizeClass = blockArena_sizeClass(size);
+    tBlockArenaHeader *header;
+
+    if (arena->freeBlocks[sizeClass] != NULL) {
+        // Reuse a released block of the same class
+        header = (tBlockArenaHeader *) ((char *) arena->freeBlocks[sizeClass] - BLOCK_ARENA_HEADER);
+        arena->freeBlocks[sizeClass] = arena->freeBlocks[sizeClass]->next;
+        return (char *) header + BLOCK_ARENA_HEADER;
+    }
+
+    size_t blockSize = BLOCK_ARENA_HEADER + blockArena_classSize(sizeClass);
+    if ((size_t) (arena->end - arena->next) < blockSize) {
+        // Request a new chunk, twice the previous one. The space left in the previous one is not used anymore
+        size_t chunkSize = POOL_ROUND(sizeof(tArenaChunk)) + (arena->chunkSize > blockSize ? arena->chunkSize : blockSize);
+        tArenaChunk *chunk = (tArenaChunk *) pool_allocBlock(arena->allocator, &chunkSize);
+        if (chunk == NULL)
+            return NULL;
+
+        chunk->next = arena->chunks;
+        chunk->size = chunkSize;
+        arena->chunks = chunk;
+        arena->next = (char *) chunk + POOL_ROUND(sizeof(tArenaChunk));
+        arena->end = (char *) chunk + chunkSize;
+        if (2 * arena->chunkSize <= POOL_MAX_BLOCK_SIZE)
+            arena->chunkSize *= 2;
+    }
+
+    header = (tBlockArenaHeader *) arena->next;
+    header->sizeClass = (size_t) sizeClass;
+    arena->next += blockSize;
+
+    return (char *) header + BLOCK_ARENA_HEADER;
+}
+
+// Resize a block of the arena, keeping its content
+void *blockArena_realloc(tBlockArena *arena, void *block, size_t size) {
+    // Check preconditions
+    assert(arena != NULL);
+
+    if (block == NULL)
+        return blockArena_alloc(arena, size);
+
+    tBlockArenaHeader *header = (tBlockArenaHeader *) ((char *) block - BLOCK_ARENA_HEADER);
+    size_t used;
+
+    if (header->sizeClass == BLOCK_ARENA_CLASSES) {
+        tBlockArenaBig *big = (tBlockArenaBig *) ((char *) header - BLOCK_ARENA_BIG_HEADER);
+        if (size > BLOCK_ARENA_MAX_SIZE) {
+            // Big blocks are resized by the allocator of the arena, then linked again
+            if (size > SIZE_MAX - BLOCK_ARENA_BIG_HEADER - BLOCK_ARENA_HEADER)
+                return NULL;
+            tBlockArenaBig *resized = (tBlockArenaBig *) allocator_realloc(arena->allocator, big, BLOCK_ARENA_BIG_HEADER + BLOCK_ARENA_HEADER + size);
+            if (resized == NULL)
+                return NULL;
+            resized->size = size;
+            if (resized->prev != NULL)
+                resized->prev->next = resized;
+            else
+                arena->bigBlocks = resized;
+            if (resized->next != NULL)
+                resized->next->prev = resized;
+            return (char *) resized + BLOCK_ARENA_BIG_HEADER + BLOCK_ARENA_HEADER;
+        }
+        used = big->size;
+    } else {
+        if (size <= BLOCK_ARENA_MAX_SIZE && blockArena_sizeClass(size) == (int) header->sizeClass)
+            return block;
+        used = blockArena_classSize((int) header->sizeClass);
+    }
+
+    // Move the content to a block of another class
+    void *moved = blockArena_alloc(arena, size);
+    if (moved == NULL)
+        return NULL;
+    memcpy(moved, block, used < size ? used : size);
+    blockArena_release(arena, block);
+
+    return moved;
+}
+
+// Give back a block to the arena
+void blockArena_release(tBlockArena *arena, void *block) {
+    // Check preconditions
+    assert(arena != NULL);
+    assert(block != NULL);
+
+    tBlockArenaHeader *header = (tBlockArenaHeader *) ((char *) block - BLOCK_ARENA_HEADER);
+
+    if (header->sizeClass == BLOCK_ARENA_CLASSES) {
+        tBlockArenaBig *big = (tBlockArenaBig *) ((char *) header - BLOCK_ARENA_BIG_HEADER);
+        if (big->prev != NULL)
+            big->prev->next = big->next;
+        else
+            arena->bigBlocks = big->next;
+        if (big->next != NULL)
+            big->next->prev = big->prev;
+        allocator_free(arena->allocator, big);
+        return;
+    }
+
+    assert(header->sizeClass < BLOCK_ARENA_CLASSES);
+    tPoolFreeElem *freeBlock = (tPoolFreeElem *) block;
+    freeBlock->next = arena->freeBlocks[header->sizeClass];
+    arena->freeBlocks[header->sizeClass] = freeBlock;
+}
+
+// Get an allocator giving the blocks of the arena
+const tAllocator *blockArena_allocator(tBlockArena *arena) {
+    // Check preconditions
+    assert(arena != NULL);
+
+    return &arena->blocks;
+}
+
+// Remove all the blocks of the arena
+void blockArena_free(tBlockArena *arena) {
+    // Check preconditions
+    assert(arena != NULL);
+
+    tArenaChunk *chunk = arena->chunks, *auxChunk;
+    tBlockArenaBig *big = arena->bigBlocks, *auxBig;
+
+    while (chunk != NULL) {
+        auxChunk = chunk->next;
+        pool_freeBlock(arena->allocator, chunk, chunk->size);
+        chunk = auxChunk;
+    }
+    while (big != NULL) {
+        auxBig = big->next;
+        allocator_free(arena->allocator, big);
+        big = auxBig;
+    }
+
+    blockArena_init(arena, arena->allocator);
+}
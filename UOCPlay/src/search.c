@@ -0,0 +1,799 @@
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include "search.h"
+
+// Initial number of slots of a trigram index. Must be a power of 2
+#define TRIGRAM_INDEX_MIN_CAPACITY 1024
+
+// Longest text whose edit distance is computed without heap memory
+#define EDIT_DISTANCE_STACK_LENGTH 128
+
+// Copy src to dst in lower case, without punctuation and with single spaces. dst needs strlen(src) + 1 chars.
+// Return the length of the normalized text
+int text_normalize(const char* src, char* dst) {
+    // Check preconditions
+    assert(src != NULL);
+    assert(dst != NULL);
+
+    int len = 0;
+    bool space = false;
+
+    for (const unsigned char *c = (const unsigned char *) src; *c != '\0'; c++) {
+        if (*c == ' ' || *c == '\t' || *c == '\r' || *c == '\n') {
+            // Collapse the blanks into one space between words
+            space = len > 0;
+        } else if ((*c >= 'a' && *c <= 'z') || (*c >= '0' && *c <= '9') || *c >= 0x80) {
+            if (space)
+                dst[len++] = ' ';
+            dst[len++] = (char) *c;
+            space = false;
+        } else if (*c >= 'A' && *c <= 'Z') {
+            if (space)
+                dst[len++] = ' ';
+            dst[len++] = (char) (*c - 'A' + 'a');
+            space = false;
+        }
+        // Punctuation is dropped
+    }
+    dst[len] = '\0';
+
+    return len;
+}
+
+// Get the key of the trigram starting at text. Never 0
+static unsigned int trigram_key(const char* text) {
+    const unsigned char *c = (const unsigned char *) text;
+    return ((unsigned int) c[0] << 16) | ((unsigned int) c[1] << 8) | (unsigned int) c[2];
+}
+
+// Return the minimum of three values
+static int search_min3(int a, int b, int c) {
+    int min = a < b ? a : b;
+    return min < c ? min : c;
+}
+
+// Return the edit distance between two texts, or maxDistance + 1 if it is greater than maxDistance
+int text_editDistance(const char* a, const char* b, int maxDistance, const tAllocator* allocator) {
+    // Check preconditions
+    assert(a != NULL);
+    assert(b != NULL);
+    assert(maxDistance >= 0);
+
+    int lenA = (int) strlen(a);
+    int lenB = (int) strlen(b);
+    int over = maxDistance + 1;
+
+    if (lenA - lenB > maxDistance || lenB - lenA > maxDistance)
+        return over;
+
+    int stackRows[2 * (EDIT_DISTANCE_STACK_LENGTH + 1)];
+    int *rows = stackRows;
+    if (lenB > EDIT_DISTANCE_STACK_LENGTH) {
+        rows = (int *) allocator_alloc(allocator, 2 * (lenB + 1) * sizeof(int));
+        if (rows == NULL)
+            return over;
+    }
+    int *prev = rows;
+    int *cur = rows + lenB + 1;
+
+    for (int j = 0; j <= lenB; j++)
+        prev[j] = j <= maxDistance ? j : over;
+
+    // Only the cells at most maxDistance away from the diagonal can be within the bound
+    for (int i = 1; i <= lenA; i++) {
+        int low = i - maxDistance > 1 ? i - maxDistance : 1;
+        int high = i + maxDistance < lenB ? i + maxDistance : lenB;
+        int rowMin = over;
+
+        cur[low - 1] = low == 1 && i <= maxDistance ? i : over;
+        if (low == 1)
+            rowMin = cur[0];
+
+        for (int j = low; j <= high; j++) {
+            int cost = a[i - 1] == b[j - 1] ? 0 : 1;
+            int value = search_min3(prev[j - 1] + cost, prev[j] + 1, cur[j - 1] + 1);
+            cur[j] = value < over ? value : over;
+            if (cur[j] < rowMin)
+                rowMin = cur[j];
+        }
+        if (high < lenB)
+            cur[high + 1] = over;
+
+        if (rowMin == over) {
+            // Every path is already too long
+            prev = NULL;
+            break;
+        }
+
+        int *swap = prev;
+        prev = cur;
+        cur = swap;
+    }
+
+    int distance = prev == NULL ? over : prev[lenB];
+
+    if (rows != stackRows)
+        allocator_free(allocator, rows);
+
+    return distance;
+}
+
+// Store the distinct trigrams of a normalized text in keys. Return how many there are
+static int trigram_distinct(const char* text, int len, unsigned int* keys) {
+    int count = 0;
+
+    for (int i = 0; i + TRIGRAM_LENGTH <= len; i++) {
+        unsigned int trigram = trigram_key(&text[i]);
+        int j = 0;
+        while (j < count && keys[j] != trigram)
+            j++;
+        if (j == count)
+            keys[count++] = trigram;
+    }
+
+    return count;
+}
+
+// Return the minimum number of distinct trigrams of a normalized query that a text within maxDistance edits
+// must share with it. 0 or less if any text could be within that distance
+int text_minSharedTrigrams(const char* normalizedQuery, int maxDistance, const tAllocator* allocator) {
+    // Check preconditions
+    assert(normalizedQuery != NULL);
+    assert(maxDistance >= 0);
+
+    int len = (int) strlen(normalizedQuery);
+    if (len < TRIGRAM_LENGTH)
+        return 0;
+
+    unsigned int *keys = (unsigned int *) allocator_alloc(allocator, (len - TRIGRAM_LENGTH + 1) * sizeof(unsigned int));
+    if (keys == NULL)
+        return 0;
+
+    // Each edit changes at most TRIGRAM_LENGTH trigrams
+    int shared = trigram_distinct(normalizedQuery, len, keys) - TRIGRAM_LENGTH * maxDistance;
+    allocator_free(allocator, keys);
+
+    return shared;
+}
+
+// Initialize a posting list
+void postingList_init(tPostingList* list, const tAllocator* allocator) {
+    // Check preconditions
+    assert(list != NULL);
+
+    list->elems = NULL;
+    list->count = 0;
+    list->capacity = 0;
+    list->allocator = allocator;
+}
+
+// Get the position of the first identifier not lower than id, starting at from
+static int postingList_lowerBound(tPostingList list, int from, int id) {
+    int low = from;
+    int high = list.count;
+
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (list.elems[mid] < id)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return low;
+}
+
+// Check if the list contains the identifier
+bool postingList_contains(tPostingList list, int id) {
+    int pos = postingList_lowerBound(list, 0, id);
+    return pos < list.count && list.elems[pos] == id;
+}
+
+// Add an identifier at the end of the list, even if it breaks the order
+static tApiError postingList_append(tPostingList* list, int id) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity == 0 ? 4 : list->capacity * 2;
+        int *elems = (int *) allocator_realloc(list->allocator, list->elems, capacity * sizeof(int));
+        if (elems == NULL)
+            return E_MEMORY_ERROR;
+        list->elems = elems;
+        list->capacity = capacity;
+    }
+    list->elems[list->count++] = id;
+
+    return E_SUCCESS;
+}
+
+// Insert an identifier keeping the list sorted. Nothing is done if it is already there
+static tApiError postingList_add(tPostingList* list, int id) {
+    int pos = postingList_lowerBound(*list, 0, id);
+    if (pos < list->count && list->elems[pos] == id)
+        return E_SUCCESS;
+
+    // Make room at the end and move the tail one place
+    if (postingList_append(list, id) != E_SUCCESS)
+        return E_MEMORY_ERROR;
+    memmove(&list->elems[pos + 1], &list->elems[pos], (list->count - 1 - pos) * sizeof(int));
+    list->elems[pos] = id;
+
+    return E_SUCCESS;
+}
+
+// Remove an identifier from the list, if it is there
+static void postingList_del(tPostingList* list, int id) {
+    int pos = postingList_lowerBound(*list, 0, id);
+    if (pos < list->count && list->elems[pos] == id) {
+        memmove(&list->elems[pos], &list->elems[pos + 1], (list->count - pos - 1) * sizeof(int));
+        list->count--;
+    }
+}
+
+// Remove the data from a posting list
+void postingList_free(tPostingList* list) {
+    // Check preconditions
+    assert(list != NULL);
+
+    allocator_free(list->allocator, list->elems);
+    postingList_init(list, list->allocator);
+}
+
+// Initialize a trigram index
+void trigramIndex_init(tTrigramIndex* index, const tAllocator* allocator, const tAllocator* listAllocator) {
+    // Check preconditions
+    assert(index != NULL);
+
+    index->elems = NULL;
+    index->capacity = 0;
+    index->count = 0;
+    index->allocator = allocator;
+    index->listAllocator = listAllocator;
+}
+
+// Get the slot of a trigram, or the empty slot where it should be placed
+static int trigramIndex_slot(const tTrigramIndex* index, unsigned int trigram) {
+    unsigned int mask = (unsigned int) index->capacity - 1;
+    unsigned int slot = (trigram * 2654435769u) & mask;
+
+    while (index->elems[slot].trigram != 0 && index->elems[slot].trigram != trigram)
+        slot = (slot + 1) & mask;
+
+    return (int) slot;
+}
+
+// Find the posting list of a trigram. NULL if it is not in the index
+static const tPostingList* trigramIndex_find(const tTrigramIndex* index, unsigned int trigram) {
+    if (index->count == 0)
+        return NULL;
+
+    int slot = trigramIndex_slot(index, trigram);
+    return index->elems[slot].trigram == 0 ? NULL : &index->elems[slot].list;
+}
+
+// Double the number of slots of the index
+static tApiError trigramIndex_grow(tTrigramIndex* index) {
+    tTrigramIndex grown;
+
+    grown.capacity = index->capacity == 0 ? TRIGRAM_INDEX_MIN_CAPACITY : index->capacity * 2;
+    grown.count = index->count;
+    grown.allocator = index->allocator;
+    grown.listAllocator = index->listAllocator;
+    grown.elems = (tTrigramIndexEntry *) allocator_calloc(grown.allocator, grown.capacity, sizeof(tTrigramIndexEntry));
+    if (grown.elems == NULL)
+        return E_MEMORY_ERROR;
+
+    // Posting lists are moved, not copied
+    for (int i = 0; i < index->capacity; i++) {
+        if (index->elems[i].trigram != 0)
+            grown.elems[trigramIndex_slot(&grown, index->elems[i].trigram)] = index->elems[i];
+    }
+
+    allocator_free(index->allocator, index->elems);
+    *index = grown;
+
+    return E_SUCCESS;
+}
+
+// Normalize a text into a new buffer. NULL if there is no memory available
+static char* trigram_normalizedCopy(const char* text, int* len, const tAllocator* allocator) {
+    char *normalized = (char *) allocator_alloc(allocator, strlen(text) + 1);
+    if (normalized != NULL)
+        *len = text_normalize(text, normalized);
+    return normalized;
+}
+
+// Add the trigrams of a text with the given identifier
+tApiError trigramIndex_add(tTrigramIndex* index, const char* text, int id) {
+    // Check preconditions
+    assert(index != NULL);
+    assert(text != NULL);
+    assert(id >= 0);
+
+    tApiError error = E_SUCCESS;
+    int len;
+    char *normalized = trigram_normalizedCopy(text, &len, index->allocator);
+    if (normalized == NULL)
+        return E_MEMORY_ERROR;
+
+    for (int i = 0; i + TRIGRAM_LENGTH <= len && error == E_SUCCESS; i++) {
+        // Keep the load factor under 1/2
+        if ((index->count + 1) * 2 > index->capacity) {
+            error = trigramIndex_grow(index);
+            if (error != E_SUCCESS)
+                break;
+        }
+
+        unsigned int trigram = trigram_key(&normalized[i]);
+        int slot = trigramIndex_slot(index, trigram);
+        if (index->elems[slot].trigram == 0) {
+            index->elems[slot].trigram = trigram;
+            postingList_init(&index->elems[slot].list, index->listAllocator);
+            index->count++;
+        }
+        error = postingList_add(&index->elems[slot].list, id);
+    }
+
+    if (error != E_SUCCESS) {
+        // Leave the index as it was
+        for (int j = 0; j + TRIGRAM_LENGTH <= len; j++) {
+            const tPostingList *list = trigramIndex_find(index, trigram_key(&normalized[j]));
+            if (list != NULL)
+                postingList_del((tPostingList *) list, id);
+        }
+    }
+
+    allocator_free(index->allocator, normalized);
+
+    return error;
+}
+
+// Remove the trigrams of a text with the given identifier
+tApiError trigramIndex_del(tTrigramIndex* index, const char* text, int id) {
+    // Check preconditions
+    assert(index != NULL);
+    assert(text != NULL);
+
+    int len;
+    char *normalized = trigram_normalizedCopy(text, &len, index->allocator);
+    if (normalized == NULL)
+        return E_MEMORY_ERROR;
+
+    // Empty lists keep their slot, so probing sequences are never broken
+    for (int i = 0; i + TRIGRAM_LENGTH <= len; i++) {
+        const tPostingList *list = trigramIndex_find(index, trigram_key(&normalized[i]));
+        if (list != NULL)
+            postingList_del((tPostingList *) list, id);
+    }
+
+    allocator_free(index->allocator, normalized);
+
+    return E_SUCCESS;
+}
+
+// Order posting lists from the shortest to the longest
+static int postingList_compareCount(const void* a, const void* b) {
+    const tPostingList *listA = *(const tPostingList * const *) a;
+    const tPostingList *listB = *(const tPostingList * const *) b;
+    return (listA->count > listB->count) - (listA->count < listB->count);
+}
+
+// Get the identifiers of the texts with all the trigrams of a normalized query, sorted.
+// The query must have at least TRIGRAM_LENGTH chars. Result must be freed with postingList_free
+tApiError trigramIndex_match(const tTrigramIndex* index, const char* normalizedQuery, tPostingList* result) {
+    // Check preconditions
+    assert(index != NULL);
+    assert(normalizedQuery != NULL);
+    assert(result != NULL);
+
+    int len = (int) strlen(normalizedQuery);
+    assert(len >= TRIGRAM_LENGTH);
+
+    postingList_init(result, index->allocator);
+
+    int count = len - TRIGRAM_LENGTH + 1;
+    const tPostingList **lists = (const tPostingList **) allocator_alloc(index->allocator, count * sizeof(tPostingList *));
+    if (lists == NULL)
+        return E_MEMORY_ERROR;
+
+    for (int i = 0; i < count; i++) {
+        lists[i] = trigramIndex_find(index, trigram_key(&normalizedQuery[i]));
+        if (lists[i] == NULL || lists[i]->count == 0) {
+            // Some trigram is in no text
+            allocator_free(index->allocator, lists);
+            return E_SUCCESS;
+        }
+    }
+
+    // Intersect starting from the shortest list, so the candidates only shrink
+    qsort(lists, count, sizeof(tPostingList *), postingList_compareCount);
+
+    result->elems = (int *) allocator_alloc(index->allocator, lists[0]->count * sizeof(int));
+    if (result->elems == NULL) {
+        allocator_free(index->allocator, lists);
+        return E_MEMORY_ERROR;
+    }
+    memcpy(result->elems, lists[0]->elems, lists[0]->count * sizeof(int));
+    result->count = lists[0]->count;
+    result->capacity = lists[0]->count;
+
+    for (int i = 1; i < count && result->count > 0; i++) {
+        int kept = 0;
+        int pos = 0;
+        for (int j = 0; j < result->count; j++) {
+            // Both lists are sorted, so the search never goes back
+            pos = postingList_lowerBound(*lists[i], pos, result->elems[j]);
+            if (pos == lists[i]->count)
+                break;
+            if (lists[i]->elems[pos] == result->elems[j])
+                result->elems[kept++] = result->elems[j];
+        }
+        result->count = kept;
+    }
+
+    allocator_free(index->allocator, lists);
+
+    return E_SUCCESS;
+}
+
+// Order identifiers from the lowest to the highest
+static int search_compareId(const void* a, const void* b) {
+    int idA = *(const int *) a;
+    int idB = *(const int *) b;
+    return (idA > idB) - (idA < idB);
+}
+
+// Get the identifiers, lower than idCount, of the texts sharing at least minShared distinct trigrams with a
+// normalized query, sorted. minShared must be positive. Result must be freed with postingList_free
+tApiError trigramIndex_similar(const tTrigramIndex* index, const char* normalizedQuery, int minShared, int idCount, tPostingList* result) {
+    // Check preconditions
+    assert(index != NULL);
+    assert(normalizedQuery != NULL);
+    assert(minShared > 0);
+    assert(result != NULL);
+
+    postingList_init(result, index->allocator);
+
+    int len = (int) strlen(normalizedQuery);
+    if (len < TRIGRAM_LENGTH || idCount <= 0)
+        return E_SUCCESS;
+
+    unsigned int *keys = (unsigned int *) allocator_alloc(index->allocator, (len - TRIGRAM_LENGTH + 1) * sizeof(unsigned int));
+    int *shared = (int *) allocator_calloc(index->allocator, idCount, sizeof(int));
+    if (keys == NULL || shared == NULL) {
+        allocator_free(index->allocator, keys);
+        allocator_free(index->allocator, shared);
+        return E_MEMORY_ERROR;
+    }
+
+    int count = trigram_distinct(normalizedQuery, len, keys);
+    for (int i = 0; i < count; i++) {
+        const tPostingList *list = trigramIndex_find(index, keys[i]);
+        if (list == NULL)
+            continue;
+
+        for (int j = 0; j < list->count && list->elems[j] < idCount; j++) {
+            // Identifiers are stored once, when they reach the minimum
+            if (++shared[list->elems[j]] == minShared) {
+                if (postingList_append(result, list->elems[j]) != E_SUCCESS) {
+                    allocator_free(index->allocator, keys);
+                    allocator_free(index->allocator, shared);
+                    postingList_free(result);
+                    return E_MEMORY_ERROR;
+                }
+            }
+        }
+    }
+
+    allocator_free(index->allocator, keys);
+    allocator_free(index->allocator, shared);
+
+    if (result->count > 1)
+        qsort(result->elems, result->count, sizeof(int), search_compareId);
+
+    return E_SUCCESS;
+}
+
+// Remove the data from a trigram index
+void trigramIndex_free(tTrigramIndex* index) {
+    // Check preconditions
+    assert(index != NULL);
+
+    for (int i = 0; i < index->capacity; i++) {
+        if (index->elems[i].trigram != 0)
+            postingList_free(&index->elems[i].list);
+    }
+    allocator_free(index->allocator, index->elems);
+    trigramIndex_init(index, index->allocator, index->listAllocator);
+}
+
+// Initialize a trie
+void trie_init(tTrie* trie, const tAllocator* allocator) {
+    // Check preconditions
+    assert(trie != NULL);
+
+    trie->nodes = NULL;
+    trie->nodeCount = 0;
+    trie->nodeCapacity = 0;
+    trie->freeNodes = TRIE_NONE;
+    trie->top = NULL;
+    trie->terminals = NULL;
+    trie->terminalCount = 0;
+    trie->terminalCapacity = 0;
+    trie->freeTerminals = TRIE_NONE;
+    trie->scores = NULL;
+    trie->scoreCapacity = 0;
+    trie->allocator = allocator;
+}
+
+// Check if identifier a goes before b: higher score first, lower identifier on ties
+static bool trie_better(const tTrie* trie, int a, int b) {
+    return trie->scores[a] > trie->scores[b] || (trie->scores[a] == trie->scores[b] && a < b);
+}
+
+// Insert an identifier in the cached top of a node, if it is good enough
+static void trie_topInsert(tTrie* trie, int node, int id) {
+    int *top = &trie->top[node * TRIE_TOP_K];
+    int count = trie->nodes[node].topCount;
+
+    if (count == TRIE_TOP_K && !trie_better(trie, id, top[count - 1]))
+        return;
+
+    int pos = count < TRIE_TOP_K ? count : TRIE_TOP_K - 1;
+    while (pos > 0 && trie_better(trie, id, top[pos - 1])) {
+        top[pos] = top[pos - 1];
+        pos--;
+    }
+    top[pos] = id;
+
+    if (count < TRIE_TOP_K)
+        trie->nodes[node].topCount++;
+}
+
+// Rebuild the cached top of a node from its own texts and the tops of its children
+static void trie_topRebuild(tTrie* trie, int node) {
+    trie->nodes[node].topCount = 0;
+
+    for (int t = trie->nodes[node].terminal; t != TRIE_NONE; t = trie->terminals[t].next)
+        trie_topInsert(trie, node, trie->terminals[t].id);
+
+    for (int child = trie->nodes[node].firstChild; child != TRIE_NONE; child = trie->nodes[child].nextSibling) {
+        for (int i = 0; i < trie->nodes[child].topCount; i++)
+            trie_topInsert(trie, node, trie->top[child * TRIE_TOP_K + i]);
+    }
+}
+
+// Check if the cached top of a node contains an identifier
+static bool trie_topContains(const tTrie* trie, int node, int id) {
+    for (int i = 0; i < trie->nodes[node].topCount; i++) {
+        if (trie->top[node * TRIE_TOP_K + i] == id)
+            return true;
+    }
+    return false;
+}
+
+// Find the child of a node with the given label. TRIE_NONE if there is none
+static int trie_child(const tTrie* trie, int node, char label) {
+    int child = trie->nodes[node].firstChild;
+    while (child != TRIE_NONE && trie->nodes[child].label != label)
+        child = trie->nodes[child].nextSibling;
+    return child;
+}
+
+// Make room for nodes new nodes, one terminal and the score of id, so adding a text cannot fail halfway
+static tApiError trie_reserve(tTrie* trie, int nodes, int id) {
+    if (trie->nodeCount + nodes > trie->nodeCapacity) {
+        int capacity = trie->nodeCapacity == 0 ? 256 : trie->nodeCapacity * 2;
+        while (capacity < trie->nodeCount + nodes)
+            capacity *= 2;
+
+        tTrieNode *newNodes = (tTrieNode *) allocator_realloc(trie->allocator, trie->nodes, capacity * sizeof(tTrieNode));
+        if (newNodes == NULL)
+            return E_MEMORY_ERROR;
+        trie->nodes = newNodes;
+
+        int *top = (int *) allocator_realloc(trie->allocator, trie->top, capacity * TRIE_TOP_K * sizeof(int));
+        if (top == NULL)
+            return E_MEMORY_ERROR;
+        trie->top = top;
+        trie->nodeCapacity = capacity;
+    }
+
+    if (trie->freeTerminals == TRIE_NONE && trie->terminalCount == trie->terminalCapacity) {
+        int capacity = trie->terminalCapacity == 0 ? 256 : trie->terminalCapacity * 2;
+        tTrieTerminal *terminals = (tTrieTerminal *) allocator_realloc(trie->allocator, trie->terminals, capacity * sizeof(tTrieTerminal));
+        if (terminals == NULL)
+            return E_MEMORY_ERROR;
+        trie->terminals = terminals;
+        trie->terminalCapacity = capacity;
+    }
+
+    if (id >= trie->scoreCapacity) {
+        int capacity = trie->scoreCapacity == 0 ? 256 : trie->scoreCapacity * 2;
+        while (capacity <= id)
+            capacity *= 2;
+
+        float *scores = (float *) allocator_realloc(trie->allocator, trie->scores, capacity * sizeof(float));
+        if (scores == NULL)
+            return E_MEMORY_ERROR;
+        trie->scores = scores;
+        trie->scoreCapacity = capacity;
+    }
+
+    return E_SUCCESS;
+}
+
+// Get a node with no children, texts nor cached top. There must be room for it
+static int trie_newNode(tTrie* trie, char label) {
+    int node;
+
+    if (trie->freeNodes != TRIE_NONE) {
+        node = trie->freeNodes;
+        trie->freeNodes = trie->nodes[node].nextSibling;
+    } else {
+        node = trie->nodeCount++;
+    }
+
+    trie->nodes[node].firstChild = TRIE_NONE;
+    trie->nodes[node].nextSibling = TRIE_NONE;
+    trie->nodes[node].terminal = TRIE_NONE;
+    trie->nodes[node].count = 0;
+    trie->nodes[node].topCount = 0;
+    trie->nodes[node].label = label;
+
+    return node;
+}
+
+// Add a text with the given identifier and score
+tApiError trie_add(tTrie* trie, const char* text, int id, float score) {
+    // Check preconditions
+    assert(trie != NULL);
+    assert(text != NULL);
+    assert(id >= 0);
+
+    int len;
+    char *normalized = trigram_normalizedCopy(text, &len, trie->allocator);
+    if (normalized == NULL)
+        return E_MEMORY_ERROR;
+
+    // Worst case: the root and one node for each char
+    if (trie_reserve(trie, len + 1, id) != E_SUCCESS) {
+        allocator_free(trie->allocator, normalized);
+        return E_MEMORY_ERROR;
+    }
+
+    if (trie->nodeCount == 0)
+        trie_newNode(trie, '\0');
+    trie->scores[id] = score;
+
+    int node = 0;
+    trie->nodes[node].count++;
+    trie_topInsert(trie, node, id);
+
+    for (int i = 0; i < len; i++) {
+        int child = trie_child(trie, node, normalized[i]);
+        if (child == TRIE_NONE) {
+            child = trie_newNode(trie, normalized[i]);
+            trie->nodes[child].nextSibling = trie->nodes[node].firstChild;
+            trie->nodes[node].firstChild = child;
+        }
+        node = child;
+        trie->nodes[node].count++;
+        trie_topInsert(trie, node, id);
+    }
+
+    int terminal;
+    if (trie->freeTerminals != TRIE_NONE) {
+        terminal = trie->freeTerminals;
+        trie->freeTerminals = trie->terminals[terminal].next;
+    } else {
+        terminal = trie->terminalCount++;
+    }
+    trie->terminals[terminal].id = id;
+    trie->terminals[terminal].next = trie->nodes[node].terminal;
+    trie->nodes[node].terminal = terminal;
+
+    allocator_free(trie->allocator, normalized);
+
+    return E_SUCCESS;
+}
+
+// Remove a text with the given identifier
+tApiError trie_del(tTrie* trie, const char* text, int id) {
+    // Check preconditions
+    assert(trie != NULL);
+    assert(text != NULL);
+
+    if (trie->nodeCount == 0)
+        return E_SUCCESS;
+
+    int len;
+    char *normalized = trigram_normalizedCopy(text, &len, trie->allocator);
+    if (normalized == NULL)
+        return E_MEMORY_ERROR;
+    int *path = (int *) allocator_alloc(trie->allocator, (len + 1) * sizeof(int));
+    if (path == NULL) {
+        allocator_free(trie->allocator, normalized);
+        return E_MEMORY_ERROR;
+    }
+
+    int node = 0;
+    path[0] = node;
+    for (int i = 0; i < len && node != TRIE_NONE; i++) {
+        node = trie_child(trie, node, normalized[i]);
+        path[i + 1] = node;
+    }
+    allocator_free(trie->allocator, normalized);
+
+    // Unlink the terminal of the text, if it is there
+    int *link = node == TRIE_NONE ? NULL : &trie->nodes[node].terminal;
+    while (link != NULL && *link != TRIE_NONE && trie->terminals[*link].id != id)
+        link = &trie->terminals[*link].next;
+
+    if (link == NULL || *link == TRIE_NONE) {
+        allocator_free(trie->allocator, path);
+        return E_SUCCESS;
+    }
+    int terminal = *link;
+    *link = trie->terminals[terminal].next;
+    trie->terminals[terminal].next = trie->freeTerminals;
+    trie->freeTerminals = terminal;
+
+    // Children are fixed before their parents, so rebuilt tops are right
+    for (int i = len; i >= 0; i--) {
+        node = path[i];
+        trie->nodes[node].count--;
+
+        if (trie->nodes[node].count == 0 && i > 0) {
+            // Release the empty node
+            int *sibling = &trie->nodes[path[i - 1]].firstChild;
+            while (*sibling != node)
+                sibling = &trie->nodes[*sibling].nextSibling;
+            *sibling = trie->nodes[node].nextSibling;
+
+            trie->nodes[node].nextSibling = trie->freeNodes;
+            trie->freeNodes = node;
+        } else if (trie_topContains(trie, node, id)) {
+            trie_topRebuild(trie, node);
+        }
+    }
+
+    allocator_free(trie->allocator, path);
+
+    return E_SUCCESS;
+}
+
+// Get up to max (at most TRIE_TOP_K) best scored identifiers of the texts starting with a normalized prefix
+int trie_complete(const tTrie* trie, const char* normalizedPrefix, int max, int* result) {
+    // Check preconditions
+    assert(trie != NULL);
+    assert(normalizedPrefix != NULL);
+    assert(max >= 0);
+    assert(result != NULL || max == 0);
+
+    if (trie->nodeCount == 0)
+        return 0;
+
+    int node = 0;
+    for (const char *c = normalizedPrefix; *c != '\0' && node != TRIE_NONE; c++)
+        node = trie_child(trie, node, *c);
+    if (node == TRIE_NONE)
+        return 0;
+
+    int count = trie->nodes[node].topCount < max ? trie->nodes[node].topCount : max;
+    if (count > 0)
+        memcpy(result, &trie->top[node * TRIE_TOP_K], count * sizeof(int));
+
+    return count;
+}
+
+// Remove the data from a trie
+void trie_free(tTrie* trie) {
+    // Check preconditions
+    assert(trie != NULL);
+
+    allocator_free(trie->allocator, trie->nodes);
+    allocator_free(trie->allocator, trie->top);
+    allocator_free(trie->allocator, trie->terminals);
+    allocator_free(trie->allocator, trie->scores);
+    trie_init(trie, trie->allocator);
+}
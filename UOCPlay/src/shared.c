@@ -0,0 +1,342 @@
+#include "shared.h"
+#include "threadpool.h"
+#include <assert.h>
+
+// Initialize a version with the allocator and thread pool of the shared data
+static void sharedData_initVersion(tSharedData *shared, tApiData *data) {
+    api_initData(data, shared->allocator);
+    api_setThreadPool(data, shared->pool);
+}
+
+// Initialize the shared data with an empty version
+tApiError sharedData_init(tSharedData *shared, const tAllocator *allocator, tThreadPool *pool) {
+    assert(shared != NULL);
+
+    shared->allocator = allocator;
+    shared->pool = pool;
+
+    tApiData *data = (tApiData *) allocator_alloc(allocator, sizeof(tApiData));
+    if (data == NULL) {
+        return E_MEMORY_ERROR;
+    }
+    sharedData_initVersion(shared, data);
+
+    if (mtx_init(&shared->readersLock, mtx_plain) != thrd_success) {
+        api_freeData(data);
+        allocator_free(allocator, data);
+        return E_MEMORY_ERROR;
+    }
+    if (mtx_init(&shared->writerLock, mtx_plain) != thrd_success) {
+        mtx_destroy(&shared->readersLock);
+        api_freeData(data);
+        allocator_free(allocator, data);
+        return E_MEMORY_ERROR;
+    }
+
+    atomic_init(&shared->current, data);
+    // Epoch 0 marks the readers outside a read-side section
+    atomic_init(&shared->epoch, 1);
+    shared->readers = NULL;
+    shared->retired = NULL;
+
+    return E_SUCCESS;
+}
+
+// Register a reader thread
+void sharedData_register(tSharedData *shared, tSharedReader *reader) {
+    assert(shared != NULL);
+    assert(reader != NULL);
+
+    atomic_init(&reader->epoch, 0);
+
+    mtx_lock(&shared->readersLock);
+    reader->prev = NULL;
+    reader->next = shared->readers;
+    if (shared->readers != NULL) {
+        shared->readers->prev = reader;
+    }
+    shared->readers = reader;
+    mtx_unlock(&shared->readersLock);
+}
+
+// Unregister a reader thread
+void sharedData_unregister(tSharedData *shared, tSharedReader *reader) {
+    assert(shared != NULL);
+    assert(reader != NULL);
+    assert(atomic_load(&reader->epoch) == 0);
+
+    mtx_lock(&shared->readersLock);
+    if (reader->prev == NULL) {
+        shared->readers = reader->next;
+    } else {
+        reader->prev->next = reader->next;
+    }
+    if (reader->next != NULL) {
+        reader->next->prev = reader->prev;
+    }
+    mtx_unlock(&shared->readersLock);
+
+    reader->next = NULL;
+    reader->prev = NULL;
+}
+
+// Start a read-side section and return the current version
+const tApiData *sharedData_readLock(tSharedData *shared, tSharedReader *reader) {
+    assert(shared != NULL);
+    assert(reader != NULL);
+    assert(atomic_load_explicit(&reader->epoch, memory_order_relaxed) == 0);
+
+    // Announce the epoch before reading the version. A writer that misses the announcement
+    // has already published its version, so this reader can only get the new one
+    atomic_store(&reader->epoch, atomic_load(&shared->epoch));
+
+    return atomic_load(&shared->current);
+}
+
+// End a read-side section
+void sharedData_readUnlock(tSharedReader *reader) {
+    assert(reader != NULL);
+
+    atomic_store_explicit(&reader->epoch, 0, memory_order_release);
+}
+
+// Return the oldest epoch announced by a reader inside a read-side section, 0 if there is none
+static unsigned long long sharedData_oldestReader(tSharedData *shared) {
+    unsigned long long oldest = 0;
+
+    mtx_lock(&shared->readersLock);
+    for (tSharedReader *reader = shared->readers; reader != NULL; reader = reader->next) {
+        unsigned long long epoch = atomic_load(&reader->epoch);
+        if (epoch != 0 && (oldest == 0 || epoch < oldest)) {
+            oldest = epoch;
+        }
+    }
+    mtx_unlock(&shared->readersLock);
+
+    return oldest;
+}
+
+// Sleep before checking the readers again, doubling the time of the next sleep up to the maximum
+static void sharedData_backoff(long *micros) {
+    struct timespec pause = {*micros / 1000000, (*micros % 1000000) * 1000};
+
+    thrd_sleep(&pause, NULL);
+    *micros = *micros * 2 < SHARED_BACKOFF_MAX_US ? *micros * 2 : SHARED_BACKOFF_MAX_US;
+}
+
+// Free the retired versions no reader can still see. The writer lock must be held
+static int sharedData_reclaimLocked(tSharedData *shared) {
+    unsigned long long oldest = sharedData_oldestReader(shared);
+    tSharedVersion **link = &shared->retired;
+    int count = 0;
+
+    while (*link != NULL) {
+        tSharedVersion *version = *link;
+        if (oldest == 0 || version->epoch <= oldest) {
+            // EVERY READER STARTED AFTER THE VERSION WAS REPLACED
+            *link = version->next;
+            api_freeData(version->data);
+            allocator_free(version->data->allocator, version->data);
+            allocator_free(shared->allocator, version);
+        } else {
+            link = &version->next;
+            count++;
+        }
+    }
+
+    return count;
+}
+
+// Replace the current version and retire the previous one. The writer lock must be held
+static void sharedData_swap(tSharedData *shared, tApiData *data) {
+    tSharedVersion *version = (tSharedVersion *) allocator_alloc(shared->allocator, sizeof(tSharedVersion));
+    tApiData *previous = atomic_exchange(&shared->current, data);
+
+    // Readers announcing this epoch or a later one can only see the new version
+    unsigned long long epoch = atomic_fetch_add(&shared->epoch, 1) + 1;
+
+    if (version == NULL) {
+        // NO MEMORY TO DEFER IT, WAIT HERE FOR THE READERS THAT CAN STILL SEE IT
+        unsigned long long oldest = sharedData_oldestReader(shared);
+        long micros = SHARED_BACKOFF_MIN_US;
+        while (oldest != 0 && oldest < epoch) {
+            sharedData_backoff(&micros);
+            oldest = sharedData_oldestReader(shared);
+        }
+        api_freeData(previous);
+        allocator_free(previous->allocator, previous);
+    } else {
+        version->data = previous;
+        version->epoch = epoch;
+        version->next = shared->retired;
+        shared->retired = version;
+    }
+
+    sharedData_reclaimLocked(shared);
+}
+
+// Start an update, returning in copy a private copy of the current version
+tApiError sharedData_beginWrite(tSharedData *shared, tApiData **copy) {
+    assert(shared != NULL);
+    assert(copy != NULL);
+
+    *copy = (tApiData *) allocator_alloc(shared->allocator, sizeof(tApiData));
+    if (*copy == NULL) {
+        return E_MEMORY_ERROR;
+    }
+
+    mtx_lock(&shared->writerLock);
+    // Only writers replace the current version, so it can be read without a read-side section
+    tApiError error = api_cpyData(*copy, *atomic_load(&shared->current));
+    if (error != E_SUCCESS) {
+        mtx_unlock(&shared->writerLock);
+        allocator_free(shared->allocator, *copy);
+        *copy = NULL;
+    }
+
+    return error;
+}
+
+// Publish the updated copy returned by sharedData_beginWrite
+void sharedData_commit(tSharedData *shared, tApiData *copy) {
+    assert(shared != NULL);
+    assert(copy != NULL);
+
+    sharedData_swap(shared, copy);
+    mtx_unlock(&shared->writerLock);
+}
+
+// Discard the copy returned by sharedData_beginWrite
+void sharedData_abort(tSharedData *shared, tApiData *copy) {
+    assert(shared != NULL);
+    assert(copy != NULL);
+
+    mtx_unlock(&shared->writerLock);
+    api_freeData(copy);
+    allocator_free(copy->allocator, copy);
+}
+
+// Add the entries of a batch to one copy of the current version and publish it
+tApiError sharedData_writeBatch(tSharedData *shared, tCSVData batch) {
+    tApiData *copy;
+
+    assert(shared != NULL);
+
+    tApiError error = sharedData_beginWrite(shared, &copy);
+    if (error != E_SUCCESS) {
+        return error;
+    }
+
+    for (int i = 0; i < batch.count && error == E_SUCCESS; i++) {
+        error = api_addDataEntry(copy, batch.entries[i]);
+    }
+
+    if (error == E_SUCCESS) {
+        sharedData_commit(shared, copy);
+    } else {
+        sharedData_abort(shared, copy);
+    }
+
+    return error;
+}
+
+// Publish a version built by the caller, taking ownership of it
+void sharedData_publish(tSharedData *shared, tApiData *data) {
+    assert(shared != NULL);
+    assert(data != NULL);
+
+    mtx_lock(&shared->writerLock);
+    sharedData_swap(shared, data);
+    mtx_unlock(&shared->writerLock);
+}
+
+// Load a CSV file into a new version and publish it
+tApiError sharedData_reload(tSharedData *shared, const char *filename) {
+    assert(shared != NULL);
+    assert(filename != NULL);
+
+    tApiData *data = (tApiData *) allocator_alloc(shared->allocator, sizeof(tApiData));
+    if (data == NULL) {
+        return E_MEMORY_ERROR;
+    }
+    sharedData_initVersion(shared, data);
+
+    // The current version is served while the new one is built
+    tApiError error;
+    if (shared->pool != NULL) {
+        error = api_loadDataParallel(data, filename, false, threadPool_threads(shared->pool), NULL);
+    } else {
+        error = api_loadData(data, filename, false);
+    }
+    if (error != E_SUCCESS) {
+        api_freeData(data);
+        allocator_free(shared->allocator, data);
+        return error;
+    }
+
+    sharedData_publish(shared, data);
+
+    return E_SUCCESS;
+}
+
+// Publish the data of a background load that ended with success
+static void sharedData_loaded(tApiLoadTask *task, tApiError error, void *context) {
+    tSharedData *shared = (tSharedData *) context;
+
+    if (error == E_SUCCESS) {
+        sharedData_publish(shared, apiLoadTask_takeData(task));
+    }
+}
+
+// Start loading a CSV file in the background into a new version
+tApiError sharedData_reloadAsync(tSharedData *shared, tApiLoadTask **task, const char *filename) {
+    assert(shared != NULL);
+    assert(task != NULL);
+    assert(filename != NULL);
+
+    // The new version starts as a copy of an empty one with the allocator and thread pool
+    tApiData empty;
+    sharedData_initVersion(shared, &empty);
+    tApiError error = api_loadDataAsync(task, &empty, filename, sharedData_loaded, shared);
+    api_freeData(&empty);
+
+    return error;
+}
+
+// Free the retired versions no reader can still see, without waiting
+int sharedData_reclaim(tSharedData *shared) {
+    assert(shared != NULL);
+
+    mtx_lock(&shared->writerLock);
+    int count = sharedData_reclaimLocked(shared);
+    mtx_unlock(&shared->writerLock);
+
+    return count;
+}
+
+// Wait until every retired version is freed
+void sharedData_synchronize(tSharedData *shared) {
+    assert(shared != NULL);
+
+    long micros = SHARED_BACKOFF_MIN_US;
+
+    while (sharedData_reclaim(shared) > 0) {
+        sharedData_backoff(&micros);
+    }
+}
+
+// Remove the shared data
+void sharedData_free(tSharedData *shared) {
+    assert(shared != NULL);
+
+    sharedData_synchronize(shared);
+
+    tApiData *data = atomic_load(&shared->current);
+    api_freeData(data);
+    allocator_free(data->allocator, data);
+    atomic_store(&shared->current, NULL);
+
+    mtx_destroy(&shared->writerLock);
+    mtx_destroy(&shared->readersLock);
+    shared->readers = NULL;
+}
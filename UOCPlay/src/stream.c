@@ -0,0 +1,276 @@
+// poll, read and lseek are POSIX
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include "stream.h"
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <io.h>
+#define stream_read(fd, buffer, size) _read(fd, buffer, (unsigned int) (size))
+#define stream_seek(fd, offset, origin) _lseeki64(fd, offset, origin)
+#else
+#include <poll.h>
+#include <unistd.h>
+#define stream_read(fd, buffer, size) read(fd, buffer, (size_t) (size))
+#define stream_seek(fd, offset, origin) lseek(fd, offset, origin)
+#endif
+
+// Initialize an empty ring
+void streamRing_init(tStreamRing *ring) {
+    assert(ring != NULL);
+
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+}
+
+// Add a batch at the end of the ring
+bool streamRing_push(tStreamRing *ring, tStreamBatch batch) {
+    assert(ring != NULL);
+
+    unsigned int tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    if (tail - atomic_load_explicit(&ring->head, memory_order_acquire) == STREAM_RING_SIZE) {
+        return false;
+    }
+    ring->slots[tail % STREAM_RING_SIZE] = batch;
+    // The slot is written before the consumer can see it
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+
+    return true;
+}
+
+// Take the first batch of the ring
+bool streamRing_pop(tStreamRing *ring, tStreamBatch *batch) {
+    assert(ring != NULL);
+    assert(batch != NULL);
+
+    unsigned int head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    if (head == atomic_load_explicit(&ring->tail, memory_order_acquire)) {
+        return false;
+    }
+    *batch = ring->slots[head % STREAM_RING_SIZE];
+    // The slot is read before the producer can write it again
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+    return true;
+}
+
+// Wake the other thread of the stream, which may be sleeping on a ring that just changed
+static void lineStream_signal(tLineStream *stream) {
+    mtx_lock(&stream->lock);
+    cnd_signal(&stream->changed);
+    mtx_unlock(&stream->lock);
+}
+
+// Add a batch to a ring of the stream, sleeping while it is full
+static void lineStream_push(tLineStream *stream, tStreamRing *ring, tStreamBatch batch) {
+    if (!streamRing_push(ring, batch)) {
+        // The ring is checked again under the lock the other thread signals with, so no wake-up is lost
+        mtx_lock(&stream->lock);
+        while (!streamRing_push(ring, batch)) {
+            cnd_wait(&stream->changed, &stream->lock);
+        }
+        mtx_unlock(&stream->lock);
+    }
+    lineStream_signal(stream);
+}
+
+// Take a batch from a ring of the stream, sleeping while it is empty. Return false if the stream is stopped
+static bool lineStream_pop(tLineStream *stream, tStreamRing *ring, tStreamBatch *batch) {
+    bool found = streamRing_pop(ring, batch);
+
+    if (!found) {
+        mtx_lock(&stream->lock);
+        while (!(found = streamRing_pop(ring, batch)) && !atomic_load(&stream->stop)) {
+            cnd_wait(&stream->changed, &stream->lock);
+        }
+        mtx_unlock(&stream->lock);
+    }
+    if (found) {
+        lineStream_signal(stream);
+    }
+
+    return found;
+}
+
+// Wait until the file descriptor has data, or has ended, checking now and then if the stream was stopped.
+// Return false if it was stopped
+static bool lineStream_readable(tLineStream *stream) {
+#ifdef _WIN32
+    // There is no portable way to wait for a pipe, the read blocks
+    return !atomic_load(&stream->stop);
+#else
+    struct pollfd fd = {stream->fd, POLLIN, 0};
+
+    while (!atomic_load(&stream->stop)) {
+        int ready = poll(&fd, 1, STREAM_POLL_MS);
+        // Errors other than a signal are reported by the read
+        if (ready > 0 || (ready < 0 && errno != EINTR)) {
+            return true;
+        }
+    }
+
+    return false;
+#endif
+}
+
+// Fill the free blocks and pass their complete lines to the parser, until the end of the file
+static int lineStream_read(void *arg) {
+    tLineStream *stream = (tLineStream *) arg;
+    tStreamBatch batch;
+    bool end = false;
+
+    while (!end) {
+        // WAIT FOR THE PARSER TO GIVE BACK A BLOCK
+        if (!lineStream_pop(stream, &stream->free, &batch)) {
+            return 0;
+        }
+        char *block = stream->blocks[batch.block];
+
+        // THE LINE LEFT AT THE END OF THE PREVIOUS BLOCK GOES FIRST
+        memcpy(block, stream->carry, stream->carryLength);
+        int length = stream->carryLength;
+        while (length < STREAM_BLOCK_SIZE && !end) {
+            if (!lineStream_readable(stream)) {
+                return 0;
+            }
+            long count = (long) stream_read(stream->fd, block + length, STREAM_BLOCK_SIZE - length);
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+            if (count < 0) {
+                stream->error = E_FILE_READ_ERROR;
+                end = true;
+            } else if (count == 0) {
+                end = true;
+            } else {
+                length += (int) count;
+                atomic_fetch_add(&stream->bytes, count);
+            }
+        }
+
+        // ONLY COMPLETE LINES ARE PASSED. A LINE LONGER THAN A BLOCK IS SPLIT
+        int complete = length;
+        if (!end) {
+            while (complete > 0 && block[complete - 1] != '\n') {
+                complete--;
+            }
+            if (complete == 0) {
+                complete = length;
+            }
+        }
+        stream->carryLength = length - complete;
+        memcpy(stream->carry, block + complete, stream->carryLength);
+
+        batch.length = complete;
+        batch.last = end;
+        lineStream_push(stream, &stream->full, batch);
+    }
+
+    return 0;
+}
+
+// Get the bytes left to read from a file descriptor
+long long lineStream_size(int fd) {
+    long long position = (long long) stream_seek(fd, 0, SEEK_CUR);
+    if (position < 0) {
+        return -1;
+    }
+    long long end = (long long) stream_seek(fd, 0, SEEK_END);
+    stream_seek(fd, position, SEEK_SET);
+
+    return end < 0 ? -1 : end - position;
+}
+
+// Start reading ahead the lines of a file descriptor
+tApiError lineStream_open(tLineStream *stream, int fd, const tAllocator *allocator) {
+    assert(stream != NULL);
+
+    stream->fd = fd;
+    stream->allocator = allocator;
+    stream->carryLength = 0;
+    stream->error = E_SUCCESS;
+    atomic_init(&stream->stop, false);
+    atomic_init(&stream->bytes, 0);
+    streamRing_init(&stream->full);
+    streamRing_init(&stream->free);
+
+    if (mtx_init(&stream->lock, mtx_plain) != thrd_success) {
+        return E_MEMORY_ERROR;
+    }
+    if (cnd_init(&stream->changed) != thrd_success) {
+        mtx_destroy(&stream->lock);
+        return E_MEMORY_ERROR;
+    }
+
+    stream->carry = (char *) allocator_alloc(allocator, STREAM_BLOCK_SIZE);
+    bool allocated = stream->carry != NULL;
+    for (int i = 0; i < STREAM_BLOCKS; i++) {
+        // One more byte, so the parser can end the last line in place
+        stream->blocks[i] = (char *) allocator_alloc(allocator, STREAM_BLOCK_SIZE + 1);
+        allocated = allocated && stream->blocks[i] != NULL;
+    }
+
+    for (int i = 0; i < STREAM_BLOCKS && allocated; i++) {
+        tStreamBatch batch = {i, 0, false};
+        streamRing_push(&stream->free, batch);
+    }
+
+    if (!allocated || thrd_create(&stream->reader, lineStream_read, stream) != thrd_success) {
+        for (int i = 0; i < STREAM_BLOCKS; i++) {
+            allocator_free(allocator, stream->blocks[i]);
+            stream->blocks[i] = NULL;
+        }
+        allocator_free(allocator, stream->carry);
+        stream->carry = NULL;
+        cnd_destroy(&stream->changed);
+        mtx_destroy(&stream->lock);
+        return E_MEMORY_ERROR;
+    }
+
+    return E_SUCCESS;
+}
+
+// Wait for the next batch of complete lines
+const char *lineStream_next(tLineStream *stream, tStreamBatch *batch) {
+    assert(stream != NULL);
+    assert(batch != NULL);
+
+    // The reader only stops when the stream is closed, after the last batch
+    lineStream_pop(stream, &stream->full, batch);
+
+    return stream->blocks[batch->block];
+}
+
+// Give back the block of a batch to be filled again
+void lineStream_release(tLineStream *stream, tStreamBatch batch) {
+    assert(stream != NULL);
+
+    lineStream_push(stream, &stream->free, batch);
+}
+
+// Stop reading ahead and remove the stream data
+tApiError lineStream_close(tLineStream *stream) {
+    assert(stream != NULL);
+
+    // Wake the reader if it sleeps waiting for a block
+    mtx_lock(&stream->lock);
+    atomic_store(&stream->stop, true);
+    cnd_broadcast(&stream->changed);
+    mtx_unlock(&stream->lock);
+    thrd_join(stream->reader, NULL);
+
+    for (int i = 0; i < STREAM_BLOCKS; i++) {
+        allocator_free(stream->allocator, stream->blocks[i]);
+        stream->blocks[i] = NULL;
+    }
+    allocator_free(stream->allocator, stream->carry);
+    stream->carry = NULL;
+    cnd_destroy(&stream->changed);
+    mtx_destroy(&stream->lock);
+
+    return stream->error;
+}
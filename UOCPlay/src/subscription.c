@@ -80,12 +80,38 @@ void subscription_get(tSubscription data, char* buffer) {
         data.numDevices);
 }
 
+// Write the subscription record into a buffer of the given size
+int subscription_format(tSubscription data, char* buffer, int size) {
+    assert(size == 0 || buffer != NULL);
+
+    if (data.price == (int) data.price) {
+        return snprintf(buffer, size, "%d;%s;%02d/%02d/%04d;%02d/%02d/%04d;%s;%d;%d",
+            data.id,
+            data.document,
+            data.start_date.day, data.start_date.month, data.start_date.year,
+            data.end_date.day, data.end_date.month, data.end_date.year,
+            data.plan,
+            (int) data.price,
+            data.numDevices) + 1;
+    }
+    return snprintf(buffer, size, "%d;%s;%02d/%02d/%04d;%02d/%02d/%04d;%s;%.2f;%d",
+        data.id,
+        data.document,
+        data.start_date.day, data.start_date.month, data.start_date.year,
+        data.end_date.day, data.end_date.month, data.end_date.year,
+        data.plan,
+        data.price,
+        data.numDevices) + 1;
+}
+
 // Initialize subscriptions data
-tApiError subscriptions_init(tSubscriptions* data) {
+tApiError subscriptions_init(tSubscriptions* data, const tAllocator* allocator) {
     // Check input data
     assert(data != NULL);
     data->elems = NULL;
     data->count = 0;
+    data->capacity = 0;
+    data->allocator = allocator;
 	
 	return E_SUCCESS;
 }
@@ -108,13 +134,27 @@ tApiError subscriptions_add(tSubscriptions* data, tPeople people, tSubscription
 	if (people_find(people, subscription.document) < 0)
 		return E_PERSON_NOT_FOUND;
 
-    // Copy the data to the new position
-	if (data->elems == NULL) {
-		data->elems = (tSubscription*) malloc(sizeof(tSubscription));
-	} else {
-		data->elems = (tSubscription*) realloc(data->elems, (data->count + 1) * sizeof(tSubscription));
+	return subscriptions_append(data, subscription);
+}
+
+// Add a subscription known not to exist
+tApiError subscriptions_append(tSubscriptions* data, tSubscription subscription) {
+    tSubscription* elems;
+
+    // Check input data
+    assert(data != NULL);
+
+    // Allocate memory for new elements, doubling it when it is full
+	if (data->count == data->capacity) {
+		int capacity = data->capacity == 0 ? 16 : 2 * data->capacity;
+		elems = (tSubscription*) allocator_realloc(data->allocator, data->elems, capacity * sizeof(tSubscription));
+		if (elems == NULL)
+			return E_MEMORY_ERROR;
+		data->elems = elems;
+		data->capacity = capacity;
 	}
-	assert(data->elems != NULL);
+
+    // Copy the data to the new position
 	subscription_cpy(&(data->elems[data->count]), subscription);
 
 	// Increase the number of elements
@@ -143,11 +183,15 @@ tApiError subscriptions_del(tSubscriptions* data, int id) {
 	// Update the number of elements
 	data->count--;  
 	/////////////////////////////////
-	if (data->count > 0) {
-		data->elems = (tSubscription*) realloc(data->elems, data->count * sizeof(tSubscription));
-		assert(data->elems != NULL);
-	} else {
+	if (data->count == 0) {
 		subscriptions_free(data);
+	} else if (data->count < data->capacity / 4) {
+		// If the memory can not shrink, the bigger block is kept
+		tSubscription* elems = (tSubscription*) allocator_realloc(data->allocator, data->elems, 2 * data->count * sizeof(tSubscription));
+		if (elems != NULL) {
+			data->elems = elems;
+			data->capacity = 2 * data->count;
+		}
 	}
 	
 	return E_SUCCESS;
@@ -187,9 +231,9 @@ void subscriptions_print(tSubscriptions data) {
 tApiError subscriptions_free(tSubscriptions* data) { 
     /////////////////////////////////
     if (data->elems != NULL) {
-        free(data->elems);
+        allocator_free(data->allocator, data->elems);
     }
-    subscriptions_init(data);
+    subscriptions_init(data, data->allocator);
 	
 	return E_SUCCESS;
     /////////////////////////////////    
@@ -0,0 +1,325 @@
+#include "threadpool.h"
+#include <assert.h>
+#include <stdlib.h>
+
+// Worker running on this thread, NULL outside the pools
+static _Thread_local tPoolWorker *threadPool_current = NULL;
+
+// Range split by a parallel for
+typedef struct _tPoolFor {
+    tPoolTaskFn fn;
+    void *arg;
+    int grain;
+    tTaskGroup group;
+} tPoolFor;
+
+// Initialize an empty deque
+static tApiError poolDeque_init(tPoolDeque *deque) {
+    deque->tasks = (tPoolTask *) malloc(POOL_DEQUE_CAPACITY * sizeof(tPoolTask));
+    if (deque->tasks == NULL) {
+        return E_MEMORY_ERROR;
+    }
+    if (mtx_init(&deque->lock, mtx_plain) != thrd_success) {
+        free(deque->tasks);
+        deque->tasks = NULL;
+        return E_MEMORY_ERROR;
+    }
+    deque->capacity = POOL_DEQUE_CAPACITY;
+    deque->top = 0;
+    deque->count = 0;
+
+    return E_SUCCESS;
+}
+
+// Remove the deque data
+static void poolDeque_free(tPoolDeque *deque) {
+    mtx_destroy(&deque->lock);
+    free(deque->tasks);
+    deque->tasks = NULL;
+}
+
+// Add the newest task. Return false if there is no memory available
+static bool poolDeque_push(tPoolDeque *deque, tPoolTask task) {
+    bool pushed = true;
+
+    mtx_lock(&deque->lock);
+    if (deque->count == deque->capacity) {
+        // DOUBLE THE RING, MOVING THE TASKS TO ITS START
+        tPoolTask *tasks = (tPoolTask *) malloc(2 * deque->capacity * sizeof(tPoolTask));
+        if (tasks == NULL) {
+            pushed = false;
+        } else {
+            for (int i = 0; i < deque->count; i++) {
+                tasks[i] = deque->tasks[(deque->top + i) % deque->capacity];
+            }
+            free(deque->tasks);
+            deque->tasks = tasks;
+            deque->capacity *= 2;
+            deque->top = 0;
+        }
+    }
+    if (pushed) {
+        deque->tasks[(deque->top + deque->count) % deque->capacity] = task;
+        deque->count++;
+    }
+    mtx_unlock(&deque->lock);
+
+    return pushed;
+}
+
+// Take the newest task, used by the owner
+static bool poolDeque_pop(tPoolDeque *deque, tPoolTask *task) {
+    bool found = false;
+
+    mtx_lock(&deque->lock);
+    if (deque->count > 0) {
+        deque->count--;
+        *task = deque->tasks[(deque->top + deque->count) % deque->capacity];
+        found = true;
+    }
+    mtx_unlock(&deque->lock);
+
+    return found;
+}
+
+// Take the oldest task, used by the other threads
+static bool poolDeque_steal(tPoolDeque *deque, tPoolTask *task) {
+    bool found = false;
+
+    mtx_lock(&deque->lock);
+    if (deque->count > 0) {
+        *task = deque->tasks[deque->top];
+        deque->top = (deque->top + 1) % deque->capacity;
+        deque->count--;
+        found = true;
+    }
+    mtx_unlock(&deque->lock);
+
+    return found;
+}
+
+// Index of the deque owned by the calling thread: its worker one, or the shared one
+static int threadPool_own(tThreadPool *pool) {
+    if (threadPool_current != NULL && threadPool_current->pool == pool) {
+        return threadPool_current->index;
+    }
+
+    return pool->count;
+}
+
+// Take a task, from the own deque first and then from the others
+static bool threadPool_take(tThreadPool *pool, tPoolTask *task) {
+    int own = threadPool_own(pool);
+    bool found = poolDeque_pop(&pool->deques[own], task);
+
+    for (int i = 1; i <= pool->count && !found; i++) {
+        found = poolDeque_steal(&pool->deques[(own + i) % (pool->count + 1)], task);
+    }
+    if (found) {
+        atomic_fetch_sub(&pool->queued, 1);
+    }
+
+    return found;
+}
+
+// Run a task and mark it as done in its group
+static void threadPool_runTask(tPoolTask task) {
+    task.fn(task.arg, task.begin, task.end);
+    atomic_fetch_sub_explicit(&task.group->pending, 1, memory_order_release);
+}
+
+// Run the pool tasks until the pool is stopped
+static int threadPool_work(void *arg) {
+    tPoolWorker *worker = (tPoolWorker *) arg;
+    tThreadPool *pool = worker->pool;
+    tPoolTask task;
+
+    threadPool_current = worker;
+    while (!atomic_load(&pool->stop)) {
+        // SLEEP UNTIL A TASK IS PUSHED. THE COUNT IS CHECKED UNDER THE LOCK THE PUSHER SIGNALS WITH
+        mtx_lock(&pool->sleepLock);
+        while (atomic_load(&pool->queued) == 0 && !atomic_load(&pool->stop)) {
+            cnd_wait(&pool->wake, &pool->sleepLock);
+        }
+        mtx_unlock(&pool->sleepLock);
+
+        while (threadPool_take(pool, &task)) {
+            threadPool_runTask(task);
+        }
+    }
+    threadPool_current = NULL;
+
+    return 0;
+}
+
+// Start a pool of the given number of threads
+tApiError threadPool_init(tThreadPool *pool, int threads) {
+    assert(pool != NULL);
+    assert(threads > 0);
+
+    // THE THREAD WAITING FOR THE TASKS ALSO RUNS THEM
+    int workers = threads - 1;
+    if (workers > POOL_MAX_WORKERS) {
+        workers = POOL_MAX_WORKERS;
+    }
+
+    pool->count = 0;
+    atomic_init(&pool->queued, 0);
+    atomic_init(&pool->stop, false);
+    if (mtx_init(&pool->sleepLock, mtx_plain) != thrd_success) {
+        return E_MEMORY_ERROR;
+    }
+    if (cnd_init(&pool->wake) != thrd_success) {
+        mtx_destroy(&pool->sleepLock);
+        return E_MEMORY_ERROR;
+    }
+
+    int deques = 0;
+    tApiError error = E_SUCCESS;
+    while (deques <= workers && error == E_SUCCESS) {
+        error = poolDeque_init(&pool->deques[deques]);
+        if (error == E_SUCCESS) {
+            deques++;
+        }
+    }
+    if (error != E_SUCCESS) {
+        for (int i = 0; i < deques; i++) {
+            poolDeque_free(&pool->deques[i]);
+        }
+        cnd_destroy(&pool->wake);
+        mtx_destroy(&pool->sleepLock);
+        return error;
+    }
+
+    // The shared deque follows the worker ones, so it is moved if fewer threads start
+    pool->count = workers;
+    for (int i = 0; i < workers; i++) {
+        pool->workers[i].pool = pool;
+        pool->workers[i].index = i;
+    }
+    int started = 0;
+    while (started < workers
+           && thrd_create(&pool->workers[started].thread, threadPool_work, &pool->workers[started]) == thrd_success) {
+        started++;
+    }
+    if (started < workers) {
+        // NO MORE THREADS AVAILABLE. THE WORKERS DO NOT LOOK AT THE DEQUES UNTIL A TASK IS PUSHED
+        for (int i = started + 1; i <= workers; i++) {
+            poolDeque_free(&pool->deques[i]);
+        }
+        pool->count = started;
+    }
+
+    return E_SUCCESS;
+}
+
+// Return the number of threads running tasks
+int threadPool_threads(tThreadPool *pool) {
+    assert(pool != NULL);
+
+    return pool->count + 1;
+}
+
+// Run a part of a parallel for, giving the upper halves to other threads while it is too big
+static void threadPool_forRange(void *arg, int begin, int end) {
+    tPoolFor *loop = (tPoolFor *) arg;
+
+    while (end - begin > loop->grain) {
+        int middle = begin + (end - begin) / 2;
+        taskGroup_run(&loop->group, threadPool_forRange, loop, middle, end);
+        end = middle;
+    }
+    loop->fn(loop->arg, begin, end);
+}
+
+// Run fn over the range [begin, end) with the pool threads
+void threadPool_parallelFor(tThreadPool *pool, int begin, int end, int grain, tPoolTaskFn fn, void *arg) {
+    assert(fn != NULL);
+
+    if (begin >= end) {
+        return;
+    }
+    if (pool == NULL) {
+        fn(arg, begin, end);
+        return;
+    }
+
+    tPoolFor loop;
+    loop.fn = fn;
+    loop.arg = arg;
+    // SOME PARTS PER THREAD, SO THE ONES ENDING FIRST CAN STEAL THE REST
+    loop.grain = grain > 0 ? grain : (end - begin) / (4 * threadPool_threads(pool));
+    if (loop.grain < 1) {
+        loop.grain = 1;
+    }
+    taskGroup_init(&loop.group, pool);
+
+    threadPool_forRange(&loop, begin, end);
+    taskGroup_wait(&loop.group);
+}
+
+// Stop the pool threads
+void threadPool_free(tThreadPool *pool) {
+    assert(pool != NULL);
+    assert(atomic_load(&pool->queued) == 0);
+
+    mtx_lock(&pool->sleepLock);
+    atomic_store(&pool->stop, true);
+    cnd_broadcast(&pool->wake);
+    mtx_unlock(&pool->sleepLock);
+
+    for (int i = 0; i < pool->count; i++) {
+        thrd_join(pool->workers[i].thread, NULL);
+    }
+    for (int i = 0; i <= pool->count; i++) {
+        poolDeque_free(&pool->deques[i]);
+    }
+    cnd_destroy(&pool->wake);
+    mtx_destroy(&pool->sleepLock);
+    pool->count = 0;
+}
+
+// Initialize a group of tasks of a pool
+void taskGroup_init(tTaskGroup *group, tThreadPool *pool) {
+    assert(group != NULL);
+
+    group->pool = pool;
+    atomic_init(&group->pending, 0);
+}
+
+// Add a task running fn(arg, begin, end) to the group
+void taskGroup_run(tTaskGroup *group, tPoolTaskFn fn, void *arg, int begin, int end) {
+    assert(group != NULL);
+    assert(fn != NULL);
+
+    tThreadPool *pool = group->pool;
+    tPoolTask task = {fn, arg, begin, end, group};
+
+    atomic_fetch_add(&group->pending, 1);
+    if (pool == NULL || !poolDeque_push(&pool->deques[threadPool_own(pool)], task)) {
+        // NO POOL OR NO MEMORY TO QUEUE IT, RUN IT NOW
+        threadPool_runTask(task);
+        return;
+    }
+
+    atomic_fetch_add(&pool->queued, 1);
+    mtx_lock(&pool->sleepLock);
+    cnd_signal(&pool->wake);
+    mtx_unlock(&pool->sleepLock);
+}
+
+// Wait until every task of the group is done
+void taskGroup_wait(tTaskGroup *group) {
+    assert(group != NULL);
+
+    tPoolTask task;
+
+    while (atomic_load_explicit(&group->pending, memory_order_acquire) > 0) {
+        // HELP WITH ANY TASK OF THE POOL INSTEAD OF BLOCKING
+        if (group->pool != NULL && threadPool_take(group->pool, &task)) {
+            threadPool_runTask(task);
+        } else {
+            thrd_yield();
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef __TEST_CATALOG_H__
+#define __TEST_CATALOG_H__
+
+#include <stdbool.h>
+#include "test_suite.h"
+
+// Run all tests for the catalog indexes
+bool run_catalog(tTestSuite* test_suite, const char* input);
+
+// Run tests for the genre index
+bool run_catalog_genre(tTestSection* test_section, const char* input);
+
+// Run tests for the rating index
+bool run_catalog_rating(tTestSection* test_section, const char* input);
+
+// Run tests for the release date index
+bool run_catalog_release(tTestSection* test_section, const char* input);
+
+// Run tests for the title search index
+bool run_catalog_search(tTestSection* test_section, const char* input);
+
+// Run tests for the film filters
+bool run_catalog_filter(tTestSection* test_section, const char* input);
+
+// Run tests for the film queries
+bool run_catalog_query(tTestSection* test_section, const char* input);
+
+// Run tests for the film statistics
+bool run_catalog_stats(tTestSection* test_section, const char* input);
+
+// Run tests for the film list views
+bool run_catalog_view(tTestSection* test_section, const char* input);
+
+// Run tests for the caller-buffer records
+bool run_catalog_record(tTestSection* test_section, const char* input);
+
+// Run tests for the paged film lists
+bool run_catalog_page(tTestSection* test_section, const char* input);
+
+// Run tests for the pools and arenas owned by the data
+bool run_catalog_arena(tTestSection* test_section, const char* input);
+
+// Run tests for the data allocated with a caller allocator
+bool run_catalog_allocator(tTestSection* test_section, const char* input);
+
+#endif // __TEST_CATALOG_H__
@@ -0,0 +1,34 @@
+#ifndef __TEST_SHARED_H__
+#define __TEST_SHARED_H__
+
+#include <stdbool.h>
+#include "test_suite.h"
+
+// Run all tests for the shared data
+bool run_shared(tTestSuite* test_suite, const char* input);
+
+// Run tests for the snapshots of the shared data
+bool run_shared_snapshot(tTestSection* test_section, const char* input);
+
+// Run tests for readers and writers running at the same time
+bool run_shared_threads(tTestSection* test_section, const char* input);
+
+// Run tests for the sharded ingestion from many threads
+bool run_shared_ingest(tTestSection* test_section, const char* input);
+
+// Run tests for the parallel load of a file
+bool run_shared_load(tTestSection* test_section, const char* input);
+
+// Run tests for the load of a file descriptor read ahead by a thread
+bool run_shared_stream(tTestSection* test_section, const char* input);
+
+// Run tests for the loads running in the background
+bool run_shared_async(tTestSection* test_section, const char* input);
+
+// Run tests for the reload of the shared data while it is read
+bool run_shared_reload(tTestSection* test_section, const char* input);
+
+// Run tests for the thread pool
+bool run_shared_pool(tTestSection* test_section, const char* input);
+
+#endif // __TEST_SHARED_H__
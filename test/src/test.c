@@ -3,6 +3,8 @@
 #include "test_data.h"
 #include "test.h"
 #include "test_pr1.h"
+#include "test_catalog.h"
+#include "test_shared.h"
 
 
 // Write data to file
@@ -42,4 +44,10 @@ void testSuite_run(tTestSuite* test_suite, const char* input, const char* readme
     }
     // Run tests
     run_pr1(test_suite, filename);
+
+    // Run tests for the catalog indexes
+    run_catalog(test_suite, filename);
+
+    // Run tests for the shared data
+    run_shared(test_suite, filename);
 }
@@ -0,0 +1,1599 @@
+#include "test_catalog.h"
+#include "api.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Run all tests for the catalog indexes
+bool run_catalog(tTestSuite *test_suite, const char *input) {
+	bool ok = true;
+	tTestSection* section = NULL;
+
+	assert(test_suite != NULL);
+
+	testSuite_addSection(test_suite, "CAT", "Tests for catalog indexes");
+
+	section = testSuite_getSection(test_suite, "CAT");
+	assert(section != NULL);
+
+	ok = run_catalog_genre(section, input);
+	ok = run_catalog_rating(section, input) && ok;
+	ok = run_catalog_release(section, input) && ok;
+	ok = run_catalog_search(section, input) && ok;
+	ok = run_catalog_filter(section, input) && ok;
+	ok = run_catalog_query(section, input) && ok;
+	ok = run_catalog_stats(section, input) && ok;
+	ok = run_catalog_view(section, input) && ok;
+	ok = run_catalog_record(section, input) && ok;
+	ok = run_catalog_page(section, input) && ok;
+	ok = run_catalog_arena(section, input) && ok;
+	ok = run_catalog_allocator(section, input) && ok;
+
+	return ok;
+}
+
+// Run tests for the genre index
+bool run_catalog_genre(tTestSection *test_section, const char *input) {
+	tApiData data;
+	tApiError error;
+	tCSVData report;
+	tCSVData refReport;
+	int genre;
+	bool passed = true;
+	bool failed = false;
+	bool fail_all = false;
+
+	// Initialize the data
+	error = api_initData(&data, NULL);
+	if (error == E_SUCCESS) {
+		error = api_loadData(&data, input, true);
+	}
+	if (error != E_SUCCESS || api_filmsCount(data) != 15) {
+		passed = false;
+		fail_all = true;
+	}
+
+	/////////////////////////////
+	/////  CAT GENRE TEST 1  ////
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_GENRE_1", "Count films of each genre");
+	if (fail_all) {
+		failed = true;
+	} else {
+		for (genre = GENRE_FIRST; genre < GENRE_END; genre++) {
+			if (api_genreFilmsCount(data, genre) != 3) {
+				failed = true;
+				passed = false;
+			}
+		}
+		if (api_genreFilmsCount(data, GENRE_END) != 0) {
+			failed = true;
+			passed = false;
+		}
+	}
+	end_test(test_section, "CAT_GENRE_1", !failed);
+
+	/////////////////////////////
+	/////  CAT GENRE TEST 2  ////
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_GENRE_2", "Remove a film from the genre index");
+	if (fail_all) {
+		failed = true;
+	} else {
+		error = catalog_del(&data.catalog, "Blade Runner 2049");
+		if (error != E_SUCCESS || api_genreFilmsCount(data, GENRE_SCIENCE_FICTION) != 2) {
+			failed = true;
+			passed = false;
+		} else {
+			csv_init(&report);
+			csv_init(&refReport);
+
+			csv_addStrEntry(&refReport, "Interstellar;02:49;4;07/11/2014;4.8;0" ,"FILM");
+			csv_addStrEntry(&refReport, "The Matrix;02:16;4;31/03/1999;4.9;1" ,"FILM");
+
+			error = api_getFilmsByGenre(data, &report, GENRE_SCIENCE_FICTION);
+			if (error != E_SUCCESS || !csv_equals(report, refReport)) {
+				failed = true;
+				passed = false;
+			}
+			csv_free(&report);
+			csv_free(&refReport);
+		}
+	}
+	end_test(test_section, "CAT_GENRE_2", !failed);
+
+	// Release all data
+	api_freeData(&data);
+
+	return passed;
+}
+
+// Run tests for the rating index
+bool run_catalog_rating(tTestSection *test_section, const char *input) {
+	tApiData data;
+	tApiError error;
+	tCSVData report;
+	tCSVData refReport;
+	bool passed = true;
+	bool failed = false;
+	bool fail_all = false;
+
+	// Initialize the data
+	error = api_initData(&data, NULL);
+	if (error == E_SUCCESS) {
+		error = api_loadData(&data, input, true);
+	}
+	if (error != E_SUCCESS || api_filmsCount(data) != 15) {
+		passed = false;
+		fail_all = true;
+	}
+
+	/////////////////////////////
+	/////  CAT RATING TEST 1  ///
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_RATING_1", "Get the best rated free films of a genre");
+	if (fail_all) {
+		failed = true;
+	} else {
+		csv_init(&report);
+		csv_init(&refReport);
+
+		csv_addStrEntry(&refReport, "The Shining;02:26;3;23/05/1980;4.5;1" ,"FILM");
+		csv_addStrEntry(&refReport, "Get Out;01:44;3;24/02/2017;4.3;1" ,"FILM");
+
+		error = api_getTopRatedFilms(data, 2, GENRE_HORROR, true, &report);
+		if (error != E_SUCCESS || !csv_equals(report, refReport)) {
+			failed = true;
+			passed = false;
+		}
+		csv_free(&report);
+		csv_free(&refReport);
+	}
+	end_test(test_section, "CAT_RATING_1", !failed);
+
+	/////////////////////////////
+	/////  CAT RATING TEST 2  ///
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_RATING_2", "Get the best rated films after removing one");
+	if (fail_all) {
+		failed = true;
+	} else {
+		error = catalog_del(&data.catalog, "The Matrix");
+		if (error != E_SUCCESS) {
+			failed = true;
+			passed = false;
+		} else {
+			csv_init(&report);
+			csv_init(&refReport);
+
+			csv_addStrEntry(&refReport, "Forrest Gump;02:22;2;06/07/1994;4.9;0" ,"FILM");
+
+			error = api_getTopRatedFilms(data, 1, FILM_GENRE_ANY, false, &report);
+			if (error != E_SUCCESS || !csv_equals(report, refReport)) {
+				failed = true;
+				passed = false;
+			}
+			csv_free(&report);
+
+			error = api_getTopRatedFilms(data, 100, FILM_GENRE_ANY, false, &report);
+			if (error != E_SUCCESS || csv_numEntries(report) != 14) {
+				failed = true;
+				passed = false;
+			}
+			csv_free(&report);
+			csv_free(&refReport);
+		}
+	}
+	end_test(test_section, "CAT_RATING_2", !failed);
+
+	/////////////////////////////
+	/////  CAT RATING TEST 3  ///
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_RATING_3", "Keep the rating and release order while many films come and go");
+	{
+		const int count = 20 * FILM_INDEX_BLOCK_SIZE;
+		tCatalog catalog;
+		tFilm film;
+		tTime duration = {1, 30};
+		tDate release, from, to;
+		tReleaseCursor cursor;
+		char name[32];
+		int left = 0, found;
+		tFilmHandle *handles = (tFilmHandle *) malloc(count * sizeof(tFilmHandle));
+
+		catalog_init(&catalog, NULL);
+		// Add films of two genres with repeated ratings and dates, so every index has several blocks,
+		// then remove two of every three
+		for (int i = 0; i < count && handles != NULL && !failed; i++) {
+			snprintf(name, sizeof(name), "Film %d", i);
+			date_fromDays(&release, (i * 7919) % 3000);
+			film_init(&film, name, duration, (tFilmGenre) (i % 2), release, (float) ((i * 31) % 51) / 10.0f, (i / 2) % 2 == 0, NULL);
+			if (catalog_add(&catalog, film) != E_SUCCESS) {
+				failed = true;
+			}
+			film_free(&film, NULL);
+		}
+		for (int i = 0; i < count && handles != NULL && !failed; i++) {
+			snprintf(name, sizeof(name), "Film %d", i);
+			if (i % 3 == 0) {
+				left++;
+			} else if (catalog_del(&catalog, name) != E_SUCCESS) {
+				failed = true;
+			}
+		}
+		if (handles == NULL || failed || catalog_topRated(&catalog, count, FILM_GENRE_ANY, false, handles) != left) {
+			failed = true;
+		} else {
+			for (int i = 1; i < left && !failed; i++) {
+				float previous = catalog_film(&catalog, handles[i - 1])->rating;
+				float rating = catalog_film(&catalog, handles[i])->rating;
+				if (rating > previous || (rating == previous && handles[i] < handles[i - 1])) {
+					failed = true;
+				}
+			}
+		}
+		if (!failed) {
+			// One page with the whole range, sorted by release date
+			date_fromDays(&from, 0);
+			date_fromDays(&to, 3000);
+			releaseCursor_init(&cursor);
+			found = catalog_releaseRange(&catalog, from, to, &cursor, count, handles);
+			if (found != left || catalog_releaseCount(&catalog, from, to) != left) {
+				failed = true;
+			}
+			for (int i = 1; i < found && !failed; i++) {
+				if (date_cmp(catalog_film(&catalog, handles[i - 1])->release, catalog_film(&catalog, handles[i])->release) > 0) {
+					failed = true;
+				}
+			}
+		}
+		catalog_free(&catalog);
+		free(handles);
+		passed = passed && !failed;
+	}
+	end_test(test_section, "CAT_RATING_3", !failed);
+
+	// Release all data
+	api_freeData(&data);
+
+	return passed;
+}
+
+// Run tests for the release date index
+bool run_catalog_release(tTestSection *test_section, const char *input) {
+	tApiData data;
+	tApiError error;
+	tCSVData report;
+	tCSVData refReport;
+	tReleaseCursor cursor;
+	tDate from, to;
+	bool passed = true;
+	bool failed = false;
+	bool fail_all = false;
+
+	// Initialize the data
+	error = api_initData(&data, NULL);
+	if (error == E_SUCCESS) {
+		error = api_loadData(&data, input, true);
+	}
+	if (error != E_SUCCESS || api_filmsCount(data) != 15) {
+		passed = false;
+		fail_all = true;
+	}
+
+	// Films released between 1990 and 2009
+	date_parse(&from, "01/01/1990");
+	date_parse(&to, "31/12/2009");
+
+	/////////////////////////////
+	/////  CAT RELEASE TEST 1  //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_RELEASE_1", "Count the films released in a range of dates");
+	if (fail_all) {
+		failed = true;
+	} else {
+		if (api_releasedFilmsCount(data, from, to) != 5 || api_releasedFilmsCount(data, to, from) != 0) {
+			failed = true;
+			passed = false;
+		}
+	}
+	end_test(test_section, "CAT_RELEASE_1", !failed);
+
+	/////////////////////////////
+	/////  CAT RELEASE TEST 2  //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_RELEASE_2", "Get the films released in a range of dates by pages");
+	if (fail_all) {
+		failed = true;
+	} else {
+		releaseCursor_init(&cursor);
+		csv_init(&report);
+		csv_init(&refReport);
+
+		csv_addStrEntry(&refReport, "Forrest Gump;02:22;2;06/07/1994;4.9;0" ,"FILM");
+		csv_addStrEntry(&refReport, "The Matrix;02:16;4;31/03/1999;4.9;1" ,"FILM");
+		csv_addStrEntry(&refReport, "The Green Mile;03:09;2;10/12/1999;4.8;1" ,"FILM");
+
+		error = api_getFilmsByRelease(data, from, to, &cursor, 3, &report);
+		if (error != E_SUCCESS || !csv_equals(report, refReport)) {
+			failed = true;
+			passed = false;
+		}
+		csv_free(&report);
+		csv_free(&refReport);
+
+		if (!failed) {
+			// The next page starts after the last film of the previous one, even if films are removed
+			csv_addStrEntry(&refReport, "Superbad;01:53;1;17/08/2007;4.0;1" ,"FILM");
+
+			catalog_del(&data.catalog, "Forrest Gump");
+			catalog_del(&data.catalog, "The Pursuit of Happyness");
+
+			error = api_getFilmsByRelease(data, from, to, &cursor, 3, &report);
+			if (error != E_SUCCESS || !csv_equals(report, refReport)) {
+				failed = true;
+				passed = false;
+			}
+			csv_free(&report);
+			csv_free(&refReport);
+		}
+	}
+	end_test(test_section, "CAT_RELEASE_2", !failed);
+
+	// Release all data
+	api_freeData(&data);
+
+	return passed;
+}
+
+// Run tests for the title search index
+bool run_catalog_search(tTestSection *test_section, const char *input) {
+	tApiData data;
+	tApiError error;
+	tCSVData report;
+	tCSVData refReport;
+	bool passed = true;
+	bool failed = false;
+	bool fail_all = false;
+
+	// Initialize the data
+	error = api_initData(&data, NULL);
+	if (error == E_SUCCESS) {
+		error = api_loadData(&data, input, true);
+	}
+	if (error != E_SUCCESS || api_filmsCount(data) != 15) {
+		passed = false;
+		fail_all = true;
+	}
+
+	/////////////////////////////
+	/////  CAT SEARCH TEST 1   //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_SEARCH_1", "Search films by a fragment of their name");
+	if (fail_all) {
+		failed = true;
+	} else {
+		csv_init(&refReport);
+		csv_addStrEntry(&refReport, "Mad Max: Fury Road;02:00;0;15/05/2015;4.5;0" ,"FILM");
+
+		// Case, punctuation and blanks are ignored
+		error = api_searchFilms(data, "MAX  fury", &report);
+		if (error != E_SUCCESS || !csv_equals(report, refReport)) {
+			failed = true;
+			passed = false;
+		}
+		csv_free(&report);
+		csv_free(&refReport);
+
+		error = api_searchFilms(data, "the", &report);
+		if (error != E_SUCCESS || csv_numEntries(report) != 6) {
+			failed = true;
+			passed = false;
+		}
+		csv_free(&report);
+
+		error = api_searchFilms(data, "Budapest Hotel Grand", &report);
+		if (error != E_SUCCESS || csv_numEntries(report) != 0) {
+			failed = true;
+			passed = false;
+		}
+		csv_free(&report);
+	}
+	end_test(test_section, "CAT_SEARCH_1", !failed);
+
+	/////////////////////////////
+	/////  CAT SEARCH TEST 2   //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_SEARCH_2", "Search films after removing some of them");
+	if (fail_all) {
+		failed = true;
+	} else {
+		catalog_del(&data.catalog, "The Matrix");
+
+		error = api_searchFilms(data, "the", &report);
+		if (error != E_SUCCESS || csv_numEntries(report) != 5) {
+			failed = true;
+			passed = false;
+		}
+		csv_free(&report);
+
+		// Fragments shorter than a trigram are also found
+		error = api_searchFilms(data, "He", &report);
+		if (error != E_SUCCESS || csv_numEntries(report) != 5) {
+			failed = true;
+			passed = false;
+		}
+		csv_free(&report);
+
+		error = api_searchFilms(data, "matrix", &report);
+		if (error != E_SUCCESS || csv_numEntries(report) != 0) {
+			failed = true;
+			passed = false;
+		}
+		csv_free(&report);
+	}
+	end_test(test_section, "CAT_SEARCH_2", !failed);
+
+	/////////////////////////////
+	/////  CAT SEARCH TEST 3   //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_SEARCH_3", "Search films by a name with typos");
+	if (fail_all) {
+		failed = true;
+	} else {
+		csv_init(&refReport);
+		csv_addStrEntry(&refReport, "Interstellar;02:49;4;07/11/2014;4.8;0" ,"FILM");
+
+		error = api_fuzzySearchFilms(data, "Interstelar", 2, 5, &report);
+		if (error != E_SUCCESS || !csv_equals(report, refReport)) {
+			failed = true;
+			passed = false;
+		}
+		csv_free(&report);
+		csv_free(&refReport);
+
+		// Closest films first, and the best rated ones among those at the same distance
+		csv_addStrEntry(&refReport, "The Green Mile;03:09;2;10/12/1999;4.8;1" ,"FILM");
+		csv_addStrEntry(&refReport, "The Shining;02:26;3;23/05/1980;4.5;1" ,"FILM");
+		csv_addStrEntry(&refReport, "Die Hard;02:12;0;15/07/1988;4.3;1" ,"FILM");
+
+		error = api_fuzzySearchFilms(data, "The Mile", 6, 3, &report);
+		if (error != E_SUCCESS || !csv_equals(report, refReport)) {
+			failed = true;
+			passed = false;
+		}
+		csv_free(&report);
+		csv_free(&refReport);
+	}
+	end_test(test_section, "CAT_SEARCH_3", !failed);
+
+	/////////////////////////////
+	/////  CAT SEARCH TEST 4   //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_SEARCH_4", "Complete the name of films, best rated first");
+	if (fail_all) {
+		failed = true;
+	} else {
+		csv_init(&refReport);
+		csv_addStrEntry(&refReport, "The Green Mile;03:09;2;10/12/1999;4.8;1" ,"FILM");
+		csv_addStrEntry(&refReport, "The Shining;02:26;3;23/05/1980;4.5;1" ,"FILM");
+
+		error = api_autocompleteFilms(data, "THE", 2, &report);
+		if (error != E_SUCCESS || !csv_equals(report, refReport)) {
+			failed = true;
+			passed = false;
+		}
+		csv_free(&report);
+		csv_free(&refReport);
+
+		if (!failed) {
+			// Completions are updated when films are removed
+			csv_addStrEntry(&refReport, "The Shining;02:26;3;23/05/1980;4.5;1" ,"FILM");
+			csv_addStrEntry(&refReport, "The Pursuit of Happyness;01:57;2;15/12/2006;4.4;1" ,"FILM");
+
+			catalog_del(&data.catalog, "The Green Mile");
+
+			error = api_autocompleteFilms(data, "the", 2, &report);
+			if (error != E_SUCCESS || !csv_equals(report, refReport)) {
+				failed = true;
+				passed = false;
+			}
+			csv_free(&report);
+			csv_free(&refReport);
+		}
+
+		error = api_autocompleteFilms(data, "the x", 2, &report);
+		if (error != E_SUCCESS || csv_numEntries(report) != 0) {
+			failed = true;
+			passed = false;
+		}
+		csv_free(&report);
+	}
+	end_test(test_section, "CAT_SEARCH_4", !failed);
+
+	// Release all data
+	api_freeData(&data);
+
+	return passed;
+}
+
+// Run tests for the film filters
+bool run_catalog_filter(tTestSection *test_section, const char *input) {
+	tApiData data;
+	tApiError error;
+	tFilmFilter filter;
+	tFilmHandle handles[4];
+	tBitmap ratingFilms;
+	tBitmap freeHorror;
+	tBitmap result;
+	tCSVData report;
+	tCSVData refReport;
+	tDate date;
+	int count;
+	bool passed = true;
+	bool failed = false;
+	bool fail_all = false;
+
+	// Initialize the data
+	error = api_initData(&data, NULL);
+	if (error == E_SUCCESS) {
+		error = api_loadData(&data, input, true);
+	}
+	if (error != E_SUCCESS || api_filmsCount(data) != 15) {
+		passed = false;
+		fail_all = true;
+	}
+
+	/////////////////////////////
+	/////  CAT FILTER TEST 1   //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_FILTER_1", "Filter films by several fields");
+	if (fail_all) {
+		failed = true;
+	} else {
+		// Free horror films rated 4.2 or more
+		filmFilter_init(&filter);
+		filter.genres = 1u << GENRE_HORROR;
+		filter.minRating = 4.2f;
+		filter.isFree = true;
+		if (catalog_filterCount(&data.catalog, &filter) != 2) {
+			failed = true;
+			passed = false;
+		}
+
+		// Action and science fiction films up to 2:30, two at a time
+		filmFilter_init(&filter);
+		filter.genres = (1u << GENRE_ACTION) | (1u << GENRE_SCIENCE_FICTION);
+		filter.maxDuration = 150;
+		count = catalog_filter(&data.catalog, &filter, 0, 2, handles);
+		if (count != 2) {
+			failed = true;
+			passed = false;
+		} else {
+			count = catalog_filter(&data.catalog, &filter, handles[1] + 1, 4, &handles[2]);
+			if (count != 2 || catalog_filterCount(&data.catalog, &filter) != 4) {
+				failed = true;
+				passed = false;
+			}
+		}
+	}
+	end_test(test_section, "CAT_FILTER_1", !failed);
+
+	/////////////////////////////
+	/////  CAT FILTER TEST 2   //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_FILTER_2", "Filter films after removing some of them");
+	if (fail_all) {
+		failed = true;
+	} else {
+		catalog_del(&data.catalog, "Get Out");
+
+		filmFilter_init(&filter);
+		filter.genres = 1u << GENRE_HORROR;
+		filter.minRating = 4.2f;
+		filter.isFree = true;
+		count = catalog_filter(&data.catalog, &filter, 0, 4, handles);
+		if (count != 1 || strcmp(catalog_film(&data.catalog, handles[0])->name, "The Shining") != 0) {
+			failed = true;
+			passed = false;
+		}
+
+		// Films released in the 1980s
+		filmFilter_init(&filter);
+		date_parse(&date, "01/01/1980");
+		filter.minRelease = date_toDays(date);
+		date_parse(&date, "31/12/1989");
+		filter.maxRelease = date_toDays(date);
+		if (catalog_filterCount(&data.catalog, &filter) != 3) {
+			failed = true;
+			passed = false;
+		}
+	}
+	end_test(test_section, "CAT_FILTER_2", !failed);
+
+	/////////////////////////////
+	/////  CAT FILTER TEST 3   //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_FILTER_3", "Combine the bitmaps of several conditions");
+	if (fail_all) {
+		failed = true;
+	} else {
+		bitmap_init(&ratingFilms, NULL);
+		bitmap_init(&freeHorror, NULL);
+		bitmap_init(&result, NULL);
+		csv_init(&refReport);
+
+		// Free AND horror AND rating >= 4.2
+		csv_addStrEntry(&refReport, "The Shining;02:26;3;23/05/1980;4.5;1" ,"FILM");
+		error = catalog_ratingBitmap(&data.catalog, 4.2f, RATING_MAX, &ratingFilms);
+		if (error == E_SUCCESS) {
+			error = bitmap_and(catalog_freeBitmap(&data.catalog), catalog_genreBitmap(&data.catalog, GENRE_HORROR), &freeHorror);
+		}
+		if (error == E_SUCCESS) {
+			error = bitmap_and(&freeHorror, &ratingFilms, &result);
+		}
+		if (error == E_SUCCESS) {
+			error = api_getBitmapFilms(data, &result, &report);
+		}
+		if (error != E_SUCCESS || !csv_equals(report, refReport)) {
+			failed = true;
+			passed = false;
+		}
+		csv_free(&report);
+		csv_free(&refReport);
+
+		// Comedy AND NOT free
+		error = bitmap_andNot(catalog_genreBitmap(&data.catalog, GENRE_COMEDY), catalog_freeBitmap(&data.catalog), &result);
+		if (error != E_SUCCESS || bitmap_count(&result) != 1) {
+			failed = true;
+			passed = false;
+		}
+
+		// Horror OR comedy
+		error = bitmap_or(catalog_genreBitmap(&data.catalog, GENRE_HORROR), catalog_genreBitmap(&data.catalog, GENRE_COMEDY), &result);
+		if (error != E_SUCCESS || bitmap_count(&result) != 5) {
+			failed = true;
+			passed = false;
+		}
+
+		bitmap_free(&ratingFilms);
+		bitmap_free(&freeHorror);
+		bitmap_free(&result);
+	}
+	end_test(test_section, "CAT_FILTER_3", !failed);
+
+	// Release all data
+	api_freeData(&data);
+
+	return passed;
+}
+
+// Run tests for the film queries
+bool run_catalog_query(tTestSection *test_section, const char *input) {
+	tApiData data;
+	tApiError error;
+	tFilmQuery query;
+	tFilmQueryCursor cursor;
+	tCSVData report;
+	tCSVData refReport;
+	bool passed = true;
+	bool failed = false;
+	bool fail_all = false;
+
+	// Initialize the data
+	error = api_initData(&data, NULL);
+	if (error == E_SUCCESS) {
+		error = api_loadData(&data, input, true);
+	}
+	if (error != E_SUCCESS || api_filmsCount(data) != 15) {
+		passed = false;
+		fail_all = true;
+	}
+
+	/////////////////////////////
+	/////  CAT QUERY TEST 1    //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_QUERY_1", "Query free action and science fiction films by rating, by pages");
+	if (fail_all) {
+		failed = true;
+	} else {
+		filmQuery_init(&query);
+		query.filter.genres = (1u << GENRE_ACTION) | (1u << GENRE_SCIENCE_FICTION);
+		query.filter.isFree = true;
+		query.order = FILM_ORDER_RATING;
+		query.limit = 2;
+		filmQueryCursor_init(&cursor);
+
+		csv_init(&refReport);
+		csv_addStrEntry(&refReport, "The Matrix;02:16;4;31/03/1999;4.9;1" ,"FILM");
+		csv_addStrEntry(&refReport, "Inception;02:28;0;16/07/2010;4.7;1" ,"FILM");
+		error = api_queryFilms(data, &query, &cursor, &report);
+		if (error != E_SUCCESS || !csv_equals(report, refReport)) {
+			failed = true;
+			passed = false;
+		}
+		csv_free(&report);
+		csv_free(&refReport);
+
+		csv_addStrEntry(&refReport, "Blade Runner 2049;02:44;4;06/10/2017;4.6;1" ,"FILM");
+		csv_addStrEntry(&refReport, "Die Hard;02:12;0;15/07/1988;4.3;1" ,"FILM");
+		error = api_queryFilms(data, &query, &cursor, &report);
+		if (error != E_SUCCESS || !csv_equals(report, refReport)) {
+			failed = true;
+			passed = false;
+		}
+		csv_free(&report);
+		csv_free(&refReport);
+
+		error = api_queryFilms(data, &query, &cursor, &report);
+		if (error != E_SUCCESS || csv_numEntries(report) != 0) {
+			failed = true;
+			passed = false;
+		}
+		csv_free(&report);
+	}
+	end_test(test_section, "CAT_QUERY_1", !failed);
+
+	/////////////////////////////
+	/////  CAT QUERY TEST 2    //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_QUERY_2", "Query films by the start of their name");
+	if (fail_all) {
+		failed = true;
+	} else {
+		filmQuery_init(&query);
+		query.namePrefix = "THE";
+		query.order = FILM_ORDER_RELEASE;
+		query.limit = 3;
+		filmQueryCursor_init(&cursor);
+
+		csv_init(&refReport);
+		csv_addStrEntry(&refReport, "The Shining;02:26;3;23/05/1980;4.5;1" ,"FILM");
+		csv_addStrEntry(&refReport, "The Matrix;02:16;4;31/03/1999;4.9;1" ,"FILM");
+		csv_addStrEntry(&refReport, "The Green Mile;03:09;2;10/12/1999;4.8;1" ,"FILM");
+		error = api_queryFilms(data, &query, &cursor, &report);
+		if (error != E_SUCCESS || !csv_equals(report, refReport)) {
+			failed = true;
+			passed = false;
+		}
+		csv_free(&report);
+		csv_free(&refReport);
+
+		error = api_queryFilms(data, &query, &cursor, &report);
+		if (error != E_SUCCESS || csv_numEntries(report) != 2) {
+			failed = true;
+			passed = false;
+		}
+		csv_free(&report);
+
+		// In handle order, rated 4.5 or more
+		filmQuery_init(&query);
+		query.namePrefix = "the";
+		query.filter.minRating = 4.5f;
+		filmQueryCursor_init(&cursor);
+		error = api_queryFilms(data, &query, &cursor, &report);
+		if (error != E_SUCCESS || csv_numEntries(report) != 3) {
+			failed = true;
+			passed = false;
+		}
+		csv_free(&report);
+	}
+	end_test(test_section, "CAT_QUERY_2", !failed);
+
+	// Release all data
+	api_freeData(&data);
+
+	return passed;
+}
+
+// Run tests for the film statistics
+bool run_catalog_stats(tTestSection *test_section, const char *input) {
+	tApiData data;
+	tApiError error;
+	tFilmStats stats;
+	bool passed = true;
+	bool failed = false;
+	bool fail_all = false;
+
+	// Initialize the data
+	error = api_initData(&data, NULL);
+	if (error == E_SUCCESS) {
+		error = api_loadData(&data, input, true);
+	}
+	if (error != E_SUCCESS || api_filmsCount(data) != 15) {
+		passed = false;
+		fail_all = true;
+	}
+
+	/////////////////////////////
+	/////  CAT STATS TEST 1    //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_STATS_1", "Group the films by genre, decade and isFree");
+	if (fail_all) {
+		failed = true;
+	} else {
+		error = api_getFilmStats(data, &stats);
+		if (error != E_SUCCESS) {
+			failed = true;
+			passed = false;
+		} else {
+			// Horror: The Shining, A Nightmare on Elm Street and Get Out
+			if (stats.genre[GENRE_HORROR].count != 3 || stats.genre[GENRE_HORROR].totalDuration != 341
+				|| stats.genre[GENRE_HORROR].averageRating < 4.29f || stats.genre[GENRE_HORROR].averageRating > 4.31f) {
+				failed = true;
+				passed = false;
+			}
+			if (stats.isFree[false].count != 4 || stats.isFree[true].count != 11) {
+				failed = true;
+				passed = false;
+			}
+			// From the 1970s to the 2010s
+			if (stats.decadeCount != 5 || stats.decade[0].key != 1970 || stats.decade[1].count != 3
+				|| stats.decade[4].key != 2010 || stats.decade[4].count != 6) {
+				failed = true;
+				passed = false;
+			}
+			filmStats_free(&stats);
+		}
+	}
+	end_test(test_section, "CAT_STATS_1", !failed);
+
+	// Release all data
+	api_freeData(&data);
+
+	return passed;
+}
+
+// Run tests for the film list views
+bool run_catalog_view(tTestSection *test_section, const char *input) {
+	tApiData data;
+	tApiError error;
+	const tFilm *films[15];
+	tFreeFilmListNode *node;
+	int count;
+	int genre;
+	int i;
+	bool passed = true;
+	bool failed = false;
+	bool fail_all = false;
+
+	// Initialize the data
+	error = api_initData(&data, NULL);
+	if (error == E_SUCCESS) {
+		error = api_loadData(&data, input, true);
+	}
+	if (error != E_SUCCESS || api_filmsCount(data) != 15) {
+		passed = false;
+		fail_all = true;
+	}
+
+	/////////////////////////////
+	/////  CAT VIEW TEST 1     //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_VIEW_1", "View the free films without copying them");
+	if (fail_all) {
+		failed = true;
+	} else {
+		count = api_getFreeFilmsView(data, films, 15);
+		if (count != api_freeFilmsCount(data)) {
+			failed = true;
+			passed = false;
+		} else {
+			node = data.catalog.freeFilmList.first;
+			for (i = 0; i < count && node != NULL; i++, node = node->next) {
+				if (films[i] != node->elem) {
+					failed = true;
+					passed = false;
+				}
+			}
+		}
+		if (api_getFreeFilmsView(data, films, 2) != 2 || films[0] != data.catalog.freeFilmList.first->elem) {
+			failed = true;
+			passed = false;
+		}
+	}
+	end_test(test_section, "CAT_VIEW_1", !failed);
+
+	/////////////////////////////
+	/////  CAT VIEW TEST 2     //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_VIEW_2", "View the films of each genre without copying them");
+	if (fail_all) {
+		failed = true;
+	} else {
+		for (genre = GENRE_FIRST; genre < GENRE_END; genre++) {
+			count = api_getFilmsByGenreView(data, genre, films, 15);
+			if (count != 3) {
+				failed = true;
+				passed = false;
+			}
+			for (i = 0; i < count; i++) {
+				if ((int) films[i]->genre != genre || catalog_film(&data.catalog, catalog_find(&data.catalog, films[i]->name)) != films[i]) {
+					failed = true;
+					passed = false;
+				}
+			}
+		}
+		if (api_getFilmsByGenreView(data, GENRE_END, films, 15) != 0) {
+			failed = true;
+			passed = false;
+		}
+	}
+	end_test(test_section, "CAT_VIEW_2", !failed);
+
+	// Release all data
+	api_freeData(&data);
+
+	return passed;
+}
+
+// Run tests for the caller-buffer records
+bool run_catalog_record(tTestSection *test_section, const char *input) {
+	tApiData data;
+	tApiError error;
+	tCSVEntry refEntry;
+	tCSVFixedEntry entry;
+	char buffer[64];
+	int needed;
+	bool passed = true;
+	bool failed = false;
+	bool fail_all = false;
+
+	// Initialize the data
+	error = api_initData(&data, NULL);
+	if (error == E_SUCCESS) {
+		error = api_loadData(&data, input, true);
+	}
+	if (error != E_SUCCESS || api_filmsCount(data) != 15) {
+		passed = false;
+		fail_all = true;
+	}
+
+	/////////////////////////////
+	/////  CAT RECORD TEST 1   //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_RECORD_1", "Write records into a caller buffer");
+	if (fail_all) {
+		failed = true;
+	} else {
+		error = api_getFilmRecord(data, "The Pursuit of Happyness", buffer, sizeof(buffer), &needed);
+		if (error != E_SUCCESS || strcmp(buffer, "The Pursuit of Happyness;01:57;2;15/12/2006;4.4;1") != 0
+			|| needed != (int) strlen(buffer) + 1) {
+			failed = true;
+			passed = false;
+		}
+		// The needed size is returned when the buffer is too small
+		error = api_getFilmRecord(data, "The Pursuit of Happyness", buffer, 10, &needed);
+		if (error != E_BUFFER_TOO_SMALL || needed != 50 || strlen(buffer) != 9) {
+			failed = true;
+			passed = false;
+		}
+		error = api_getSubscriptionRecord(data, 5, NULL, 0, &needed);
+		if (error != E_BUFFER_TOO_SMALL || needed != 50) {
+			failed = true;
+			passed = false;
+		}
+		error = api_getSubscriptionRecord(data, 5, buffer, needed, &needed);
+		if (error != E_SUCCESS || strcmp(buffer, "5;47051307Z;01/01/2023;31/12/2028;Premium;29.95;3") != 0) {
+			failed = true;
+			passed = false;
+		}
+		if (api_getFilmRecord(data, "Unknown", buffer, sizeof(buffer), &needed) != E_FILM_NOT_FOUND
+			|| api_getSubscriptionRecord(data, 999, buffer, sizeof(buffer), &needed) != E_SUBSCRIPTION_NOT_FOUND) {
+			failed = true;
+			passed = false;
+		}
+	}
+	end_test(test_section, "CAT_RECORD_1", !failed);
+
+	/////////////////////////////
+	/////  CAT RECORD TEST 2   //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_RECORD_2", "Fill caller-owned fixed capacity entries");
+	if (fail_all) {
+		failed = true;
+	} else {
+		csv_initEntry(&refEntry);
+		csv_parseEntry(&refEntry, "The Pursuit of Happyness;01:57;2;15/12/2006;4.4;1", "FILM");
+		error = api_getFilmFixedEntry(data, "The Pursuit of Happyness", &entry);
+		if (error != E_SUCCESS || !csv_equalsEntry(entry.entry, refEntry)) {
+			failed = true;
+			passed = false;
+		}
+		csv_freeEntry(&refEntry);
+
+		csv_initEntry(&refEntry);
+		csv_parseEntry(&refEntry, "5;47051307Z;01/01/2023;31/12/2028;Premium;29.95;3", "SUBSCRIPTION");
+		error = api_getSubscriptionFixedEntry(data, 5, &entry);
+		if (error != E_SUCCESS || !csv_equalsEntry(entry.entry, refEntry) || csv_getAsInteger(entry.entry, 6) != 3) {
+			failed = true;
+			passed = false;
+		}
+		csv_freeEntry(&refEntry);
+
+		error = api_getSubscriptionFixedEntry(data, 999, &entry);
+		if (error != E_SUBSCRIPTION_NOT_FOUND || csv_numFields(entry.entry) != 0) {
+			failed = true;
+			passed = false;
+		}
+	}
+	end_test(test_section, "CAT_RECORD_2", !failed);
+
+	// Release all data
+	api_freeData(&data);
+
+	return passed;
+}
+
+// Run tests for the paged film lists
+bool run_catalog_page(tTestSection *test_section, const char *input) {
+	tApiData data;
+	tApiError error;
+	tCSVData report;
+	tCSVData refReport;
+	tFilmListCursor cursor;
+	int count;
+	int total;
+	int pages;
+	bool passed = true;
+	bool failed = false;
+	bool fail_all = false;
+
+	// Initialize the data
+	error = api_initData(&data, NULL);
+	if (error == E_SUCCESS) {
+		error = api_loadData(&data, input, true);
+	}
+	if (error != E_SUCCESS || api_filmsCount(data) != 15) {
+		passed = false;
+		fail_all = true;
+	}
+
+	/////////////////////////////
+	/////  CAT PAGE TEST 1     //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_PAGE_1", "Page through the free films");
+	if (fail_all) {
+		failed = true;
+	} else {
+		api_getFreeFilms(data, &refReport);
+		filmListCursor_init(&cursor);
+		total = 0;
+		pages = 0;
+		do {
+			error = api_getFreeFilmsPage(data, &cursor, 4, &report);
+			count = report.count;
+			if (error != E_SUCCESS || count > 4) {
+				failed = true;
+				passed = false;
+			}
+			// Each page continues where the previous one stopped
+			for (int i = 0; i < count && total + i < refReport.count; i++) {
+				if (!csv_equalsEntry(report.entries[i], refReport.entries[total + i])) {
+					failed = true;
+					passed = false;
+				}
+			}
+			total += count;
+			pages++;
+			csv_free(&report);
+		} while (!failed && pages <= 4 && count > 0);
+		if (total != 11 || pages != 4) {
+			failed = true;
+			passed = false;
+		}
+		csv_free(&refReport);
+	}
+	end_test(test_section, "CAT_PAGE_1", !failed);
+
+	/////////////////////////////
+	/////  CAT PAGE TEST 2     //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_PAGE_2", "Page through a genre and expire the cursor");
+	if (fail_all) {
+		failed = true;
+	} else {
+		csv_init(&refReport);
+		csv_addStrEntry(&refReport, "The Shining;02:26;3;23/05/1980;4.5;1", "FILM");
+		csv_addStrEntry(&refReport, "A Nightmare on Elm Street;01:31;3;09/11/1984;4.1;1", "FILM");
+		filmListCursor_init(&cursor);
+		error = api_getFilmsByGenrePage(data, GENRE_HORROR, &cursor, 2, &report);
+		if (error != E_SUCCESS || !csv_equals(report, refReport)) {
+			failed = true;
+			passed = false;
+		}
+		csv_free(&report);
+		csv_free(&refReport);
+
+		csv_init(&refReport);
+		csv_addStrEntry(&refReport, "Get Out;01:44;3;24/02/2017;4.3;1", "FILM");
+		error = api_getFilmsByGenrePage(data, GENRE_HORROR, &cursor, 2, &report);
+		if (error != E_SUCCESS || !csv_equals(report, refReport)) {
+			failed = true;
+			passed = false;
+		}
+		csv_free(&report);
+		csv_free(&refReport);
+
+		// A cursor of another list or of an older catalog version is rejected
+		if (api_getFilmsByGenrePage(data, GENRE_DRAMA, &cursor, 2, &report) != E_CURSOR_EXPIRED) {
+			failed = true;
+			passed = false;
+		}
+		csv_free(&report);
+		catalog_del(&data.catalog, "Inception");
+		if (api_getFilmsByGenrePage(data, GENRE_HORROR, &cursor, 2, &report) != E_CURSOR_EXPIRED) {
+			failed = true;
+			passed = false;
+		}
+		csv_free(&report);
+	}
+	end_test(test_section, "CAT_PAGE_2", !failed);
+
+	/////////////////////////////
+	/////  CAT PAGE TEST 3     //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_PAGE_3", "Expire the cursor on a copy or a reload of the data");
+	{
+		tApiData other;
+		tApiData copy;
+		bool ready;
+
+		// Fresh data with the same films as the copy, so only the catalog version tells them apart
+		ready = api_initData(&other, NULL) == E_SUCCESS;
+		filmListCursor_init(&cursor);
+		csv_init(&report);
+		if (!ready || api_loadData(&other, input, true) != E_SUCCESS
+			|| api_getFreeFilmsPage(other, &cursor, 4, &report) != E_SUCCESS) {
+			failed = true;
+		}
+		csv_free(&report);
+		if (!failed) {
+			if (api_cpyData(&copy, other) != E_SUCCESS) {
+				failed = true;
+			} else {
+				if (api_getFreeFilmsPage(copy, &cursor, 4, &report) != E_CURSOR_EXPIRED) {
+					failed = true;
+				}
+				csv_free(&report);
+				api_freeData(&copy);
+			}
+		}
+		if (!failed) {
+			if (api_loadData(&other, input, true) != E_SUCCESS
+				|| api_getFreeFilmsPage(other, &cursor, 4, &report) != E_CURSOR_EXPIRED) {
+				failed = true;
+			}
+			csv_free(&report);
+		}
+		if (ready) {
+			api_freeData(&other);
+		}
+		passed = passed && !failed;
+	}
+	end_test(test_section, "CAT_PAGE_3", !failed);
+
+	// Release all data
+	api_freeData(&data);
+
+	return passed;
+}
+
+// Run tests for the pools and arenas owned by the data
+bool run_catalog_arena(tTestSection *test_section, const char *input) {
+	tApiData data;
+	tApiError error;
+	tPool pool;
+	tStringArena arena;
+	tBlockArena blocks;
+	bool passed = true;
+	bool failed = false;
+	bool fail_all = false;
+
+	// Initialize the data
+	error = api_initData(&data, NULL);
+	if (error == E_SUCCESS) {
+		error = api_loadData(&data, input, true);
+	}
+	if (error != E_SUCCESS || api_peopleCount(data) != 5) {
+		passed = false;
+		fail_all = true;
+	}
+
+	/////////////////////////////
+	/////  CAT ARENA TEST 1    //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_ARENA_1", "Growing pools and arenas keep their elements");
+	{
+		const int count = 100000;
+		int **elems = (int **) malloc(count * sizeof(int *));
+		char *text = (char *) malloc(3 * ARENA_CHUNK_SIZE);
+		const char *copy = NULL;
+
+		pool_init(&pool, sizeof(int), NULL);
+		stringArena_init(&arena, NULL);
+		if (elems == NULL || text == NULL) {
+			failed = true;
+		} else {
+			for (int i = 0; i < count && !failed; i++) {
+				elems[i] = (int *) pool_alloc(&pool);
+				if (elems[i] == NULL) {
+					failed = true;
+				} else {
+					*elems[i] = i;
+				}
+			}
+			for (int i = 0; i < count && !failed; i++) {
+				if (*elems[i] != i) {
+					failed = true;
+				}
+			}
+			// A string longer than a chunk gets a chunk of its own
+			memset(text, 'x', 3 * ARENA_CHUNK_SIZE - 1);
+			text[3 * ARENA_CHUNK_SIZE - 1] = '\0';
+			copy = stringArena_dup(&arena, text);
+			if (failed || pool_count(pool) != count || copy == NULL || strcmp(copy, text) != 0
+				|| strcmp(stringArena_dup(&arena, "short"), "short") != 0) {
+				failed = true;
+			}
+		}
+		// Blocks resized through every size class up to big blocks, and back, keep their content
+		blockArena_init(&blocks, NULL);
+		int *grown = NULL;
+		int filled = 0;
+		for (int size = 1; size <= 40000 && !failed; size = size * 2 + 1) {
+			int *resized = (int *) allocator_realloc(blockArena_allocator(&blocks), grown, size * sizeof(int));
+			if (resized == NULL) {
+				failed = true;
+			} else {
+				grown = resized;
+				for (; filled < size; filled++) {
+					grown[filled] = filled;
+				}
+				for (int i = 0; i < size; i++) {
+					failed = failed || grown[i] != i;
+				}
+			}
+		}
+		grown = failed ? grown : (int *) allocator_realloc(blockArena_allocator(&blocks), grown, 10 * sizeof(int));
+		if (grown == NULL || grown[9] != 9) {
+			failed = true;
+		}
+		// A released block is reused by the next one of its size
+		void *released = blockArena_alloc(&blocks, 100);
+		blockArena_release(&blocks, released);
+		if (released == NULL || blockArena_alloc(&blocks, 100) != released) {
+			failed = true;
+		}
+		pool_free(&pool);
+		stringArena_free(&arena);
+		blockArena_free(&blocks);
+		free(elems);
+		free(text);
+		passed = passed && !failed;
+	}
+	end_test(test_section, "CAT_ARENA_1", !failed);
+
+	/////////////////////////////
+	/////  CAT ARENA TEST 2    //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_ARENA_2", "People keep their fields after others are removed");
+	if (fail_all) {
+		failed = true;
+	} else {
+		tPerson person = data.people.elems[0];
+		char document[MAX_DOCUMENT + 1];
+		strcpy(document, person.document);
+		if (people_del(&data.people, data.people.elems[1].document) != E_SUCCESS
+			|| api_peopleCount(data) != 4 || strcmp(data.people.elems[0].document, document) != 0) {
+			failed = true;
+		}
+		// The people keep their own copy of the fields of the person added
+		if (people_del(&data.people, document) != E_SUCCESS) {
+			failed = true;
+		}
+		person.document = document;
+		if (people_add(&data.people, person) != E_SUCCESS || data.people.elems[3].document == document
+			|| strcmp(data.people.elems[3].document, document) != 0 || api_peopleCount(data) != 4) {
+			failed = true;
+		}
+		passed = passed && !failed;
+	}
+	end_test(test_section, "CAT_ARENA_2", !failed);
+
+	/////////////////////////////
+	/////  CAT ARENA TEST 3    //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_ARENA_3", "Fields of removed people are recovered");
+	if (fail_all) {
+		failed = true;
+	} else {
+		tPerson person;
+		tPerson churn;
+		char document[MAX_DOCUMENT + 1];
+		char address[256];
+		size_t chunkBytes = 0;
+		strcpy(document, data.people.elems[0].document);
+		memset(address, 'a', sizeof(address) - 1);
+		address[sizeof(address) - 1] = '\0';
+		// The fields in the data move when its arena is packed, so the person added has its own copy
+		person_cpy(&person, data.people.elems[0], NULL);
+		churn = person;
+		churn.document = "99999999Z";
+		churn.address = address;
+		// Some megabytes of fields added and removed
+		for (int i = 0; i < 20000 && !failed; i++) {
+			if (people_add(&data.people, churn) != E_SUCCESS || people_del(&data.people, churn.document) != E_SUCCESS) {
+				failed = true;
+			}
+		}
+		person_free(&person, NULL);
+		for (tArenaChunk *chunk = data.people.strings.chunks; chunk != NULL; chunk = chunk->next) {
+			chunkBytes += chunk->size;
+		}
+		if (chunkBytes > 4 * ARENA_CHUNK_SIZE || api_peopleCount(data) != 4
+			|| strcmp(data.people.elems[0].document, document) != 0) {
+			failed = true;
+		}
+		passed = passed && !failed;
+	}
+	end_test(test_section, "CAT_ARENA_3", !failed);
+
+	// Release all data
+	api_freeData(&data);
+
+	return passed;
+}
+
+// Blocks given by the counting allocator and not freed yet, calls made to it and blocks freed
+typedef struct _tCountingHeap {
+	atomic_int live;
+	atomic_int calls;
+	atomic_int frees;
+	// While set, every allocation fails
+	atomic_bool failing;
+} tCountingHeap;
+
+// Allocate a block, counting it
+static void *countingHeap_alloc(void *context, size_t size) {
+	tCountingHeap *heap = (tCountingHeap *) context;
+	void *ptr = atomic_load(&heap->failing) ? NULL : malloc(size);
+
+	atomic_fetch_add(&heap->calls, 1);
+	if (ptr != NULL) {
+		atomic_fetch_add(&heap->live, 1);
+	}
+	return ptr;
+}
+
+// Resize a block, which is still the same one
+static void *countingHeap_realloc(void *context, void *ptr, size_t size) {
+	tCountingHeap *heap = (tCountingHeap *) context;
+
+	atomic_fetch_add(&heap->calls, 1);
+	return atomic_load(&heap->failing) ? NULL : realloc(ptr, size);
+}
+
+// Free a block, counting it
+static void countingHeap_free(void *context, void *ptr) {
+	tCountingHeap *heap = (tCountingHeap *) context;
+
+	atomic_fetch_sub(&heap->live, 1);
+	atomic_fetch_add(&heap->frees, 1);
+	free(ptr);
+}
+
+// Run tests for the data allocated with a caller allocator
+bool run_catalog_allocator(tTestSection *test_section, const char *input) {
+	tApiData reference;
+	tApiData data;
+	tApiData copy;
+	tApiError error;
+	tCSVData films;
+	tCountingHeap heap;
+	tAllocator allocator = {countingHeap_alloc, countingHeap_realloc, countingHeap_free, &heap};
+	bool passed = true;
+	bool failed = false;
+	bool fail_all = false;
+
+	atomic_init(&heap.live, 0);
+	atomic_init(&heap.calls, 0);
+	atomic_init(&heap.frees, 0);
+	atomic_init(&heap.failing, false);
+
+	// Initialize the data
+	error = api_initData(&reference, NULL);
+	if (error == E_SUCCESS) {
+		error = api_loadData(&reference, input, true);
+	}
+	if (error != E_SUCCESS) {
+		passed = false;
+		fail_all = true;
+	}
+
+	/////////////////////////////
+	/////  CAT ALLOC TEST 1    //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_ALLOC_1", "Data loaded with a caller allocator frees all its blocks");
+	if (fail_all) {
+		failed = true;
+	} else {
+		error = api_initData(&data, &allocator);
+		if (error == E_SUCCESS) {
+			error = api_loadData(&data, input, true);
+		}
+		if (error != E_SUCCESS || atomic_load(&heap.calls) == 0
+			|| api_peopleCount(data) != api_peopleCount(reference)
+			|| api_subscriptionsCount(data) != api_subscriptionsCount(reference)
+			|| api_filmsCount(data) != api_filmsCount(reference)) {
+			failed = true;
+		}
+		// The entries returned use the allocator of the data
+		if (api_getFreeFilms(data, &films) != E_SUCCESS || csv_numEntries(films) != api_freeFilmsCount(reference)
+			|| films.allocator != &allocator) {
+			failed = true;
+		}
+		csv_free(&films);
+		api_freeData(&data);
+		if (atomic_load(&heap.live) != 0) {
+			failed = true;
+		}
+		passed = passed && !failed;
+	}
+	end_test(test_section, "CAT_ALLOC_1", !failed);
+
+	/////////////////////////////
+	/////  CAT ALLOC TEST 2    //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_ALLOC_2", "Parallel loads and copies keep the caller allocator");
+	if (fail_all) {
+		failed = true;
+	} else {
+		error = api_initData(&data, &allocator);
+		if (error == E_SUCCESS) {
+			error = api_loadDataParallel(&data, input, true, 4, NULL);
+		}
+		if (error != E_SUCCESS || api_filmsCount(data) != api_filmsCount(reference)
+			|| api_subscriptionsCount(data) != api_subscriptionsCount(reference)) {
+			failed = true;
+		}
+		if (error == E_SUCCESS) {
+			int live = atomic_load(&heap.live);
+			if (api_cpyData(&copy, data) != E_SUCCESS) {
+				failed = true;
+			} else {
+				if (copy.allocator != &allocator || atomic_load(&heap.live) <= live
+					|| api_peopleCount(copy) != api_peopleCount(reference)) {
+					failed = true;
+				}
+				api_freeData(&copy);
+			}
+		}
+		api_freeData(&data);
+		if (atomic_load(&heap.live) != 0) {
+			failed = true;
+		}
+		passed = passed && !failed;
+	}
+	end_test(test_section, "CAT_ALLOC_2", !failed);
+
+	/////////////////////////////
+	/////  CAT ALLOC TEST 3    //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_ALLOC_3", "Subscriptions report a failing allocator");
+	if (fail_all) {
+		failed = true;
+	} else {
+		tSubscriptions subscriptions;
+		tSubscription subscription = reference.subscriptions.elems[0];
+
+		subscriptions_init(&subscriptions, &allocator);
+		atomic_store(&heap.failing, true);
+		if (subscriptions_add(&subscriptions, reference.people, subscription) != E_MEMORY_ERROR
+			|| subscriptions_len(subscriptions) != 0) {
+			failed = true;
+		}
+		atomic_store(&heap.failing, false);
+		for (int i = 0; i < 20 && !failed; i++) {
+			subscription.id = 1000 + i;
+			if (subscriptions_add(&subscriptions, reference.people, subscription) != E_SUCCESS) {
+				failed = true;
+			}
+		}
+		// The block can not shrink, so the bigger one is kept
+		atomic_store(&heap.failing, true);
+		for (int i = 0; i < 15 && !failed; i++) {
+			if (subscriptions_del(&subscriptions, 1000 + i) != E_SUCCESS) {
+				failed = true;
+			}
+		}
+		atomic_store(&heap.failing, false);
+		if (subscriptions_len(subscriptions) != 5 || subscriptions_find(subscriptions, 1019) != 4) {
+			failed = true;
+		}
+		subscriptions_free(&subscriptions);
+		if (atomic_load(&heap.live) != 0) {
+			failed = true;
+		}
+		passed = passed && !failed;
+	}
+	end_test(test_section, "CAT_ALLOC_3", !failed);
+
+	/////////////////////////////
+	/////  CAT ALLOC TEST 4    //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "CAT_ALLOC_4", "Removing a big catalog frees its blocks, not its films");
+	{
+		const int count = 20000;
+		tCatalog catalog;
+		tFilm film;
+		tTime duration = {1, 30};
+		tDate release;
+		char name[32];
+		int frees;
+
+		catalog_init(&catalog, &allocator);
+		for (int i = 0; i < count && !failed; i++) {
+			snprintf(name, sizeof(name), "Film %d", i);
+			date_fromDays(&release, (i * 7919) % 3000);
+			film_init(&film, name, duration, (tFilmGenre) (i % GENRE_END), release, (float) ((i * 31) % 51) / 10.0f, i % 2 == 0, NULL);
+			if (catalog_add(&catalog, film) != E_SUCCESS) {
+				failed = true;
+			}
+			film_free(&film, NULL);
+		}
+		for (int i = 0; i < count && !failed; i += 3) {
+			snprintf(name, sizeof(name), "Film %d", i);
+			if (catalog_del(&catalog, name) != E_SUCCESS) {
+				failed = true;
+			}
+		}
+		// Posting lists, bitmap containers and index blocks go with the arenas that hold them
+		frees = atomic_load(&heap.frees);
+		catalog_free(&catalog);
+		frees = atomic_load(&heap.frees) - frees;
+		if (frees > 100 || atomic_load(&heap.live) != 0) {
+			failed = true;
+		}
+		passed = passed && !failed;
+	}
+	end_test(test_section, "CAT_ALLOC_4", !failed);
+
+	// Release all data
+	api_freeData(&reference);
+
+	return passed;
+}
@@ -63,7 +63,7 @@ bool run_pr1_ex2(tTestSection *test_section, const char *input) {
 	release.day = 7;
 	release.month = 11;
 	release.year = 2014;
-	film_init(&film1, "Interstellar", duration, 4, release, 4.8f, false);
+	film_init(&film1, "Interstellar", duration, 4, release, 4.8f, false, NULL);
 
 	// film2
 	duration.hour = 2;
@@ -71,7 +71,7 @@ bool run_pr1_ex2(tTestSection *test_section, const char *input) {
 	release.day = 15;
 	release.month = 5;
 	release.year = 2015;
-	film_init(&film2, "Mad Max: Fury Road", duration, 0, release, 4.5f, false);
+	film_init(&film2, "Mad Max: Fury Road", duration, 0, release, 4.5f, false, NULL);
 
 	// film3
 	duration.hour = 3;
@@ -79,7 +79,7 @@ bool run_pr1_ex2(tTestSection *test_section, const char *input) {
 	release.day = 10;
 	release.month = 12;
 	release.year = 1999;
-	film_init(&film3, "The Green Mile", duration, 2, release, 4.8f, true);
+	film_init(&film3, "The Green Mile", duration, 2, release, 4.8f, true, NULL);
 
 	// film4
 	duration.hour = 1;
@@ -87,7 +87,7 @@ bool run_pr1_ex2(tTestSection *test_section, const char *input) {
 	release.day = 15;
 	release.month = 12;
 	release.year = 2006;
-	film_init(&film4, "The Pursuit of Happyness", duration, 2, release, 4.4f, true);
+	film_init(&film4, "The Pursuit of Happyness", duration, 2, release, 4.4f, true, NULL);
 	
 	/////////////////////////////
 	/////  PR1 EX2 TEST 1  //////
@@ -95,7 +95,7 @@ bool run_pr1_ex2(tTestSection *test_section, const char *input) {
 	failed = false;
 	start_test(test_section, "PR1_EX2_1", "Initialize the catalog data structure");
 	// Initialize the catalog
-	error = catalog_init(&catalog);
+	error = catalog_init(&catalog, NULL);
 	if (error != E_SUCCESS) {
 		failed = true;
 		passed = false;
@@ -400,10 +400,10 @@ bool run_pr1_ex2(tTestSection *test_section, const char *input) {
 	
 	// Release all data
 	catalog_free(&catalog);
-	film_free(&film1);
-	film_free(&film2);
-	film_free(&film3);
-	film_free(&film4);
+	film_free(&film1, NULL);
+	film_free(&film2, NULL);
+	film_free(&film3, NULL);
+	film_free(&film4, NULL);
 	
 	return passed;
 }
@@ -428,7 +428,7 @@ bool run_pr1_ex3(tTestSection *test_section, const char *input) {
 	failed = false;
 	start_test(test_section, "PR1_EX3_1", "Initialize the API data structure");
 	// Initialize the data
-	error = api_initData(&data);
+	error = api_initData(&data, NULL);
 	if (error != E_SUCCESS) {
 		failed = true;
 		passed = false;
@@ -937,7 +937,7 @@ bool run_pr1_ex4(tTestSection *test_section, const char *input) {
 	bool fail_all = false;
 
 	// Initialize the data
-	error = api_initData(&data);
+	error = api_initData(&data, NULL);
 	if (error != E_SUCCESS) {
 		passed = false;
 		fail_all = true;
@@ -0,0 +1,1185 @@
+// fileno and pipe are POSIX
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include "test_shared.h"
+#include "api.h"
+#include "ingest.h"
+#include "shared.h"
+#include "stream.h"
+#include "threadpool.h"
+#include "test.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#define test_fileno(file) _fileno(file)
+#else
+#include <unistd.h>
+#define test_fileno(file) fileno(file)
+#endif
+
+// Number of reader threads of the concurrent tests
+#define TEST_SHARED_READERS 4
+
+// Number of versions published by the writer of the concurrent tests
+#define TEST_SHARED_WRITES 50
+
+// Shared data and result of a reader thread
+typedef struct _tTestSharedReader {
+	tSharedData *shared;
+	atomic_bool *done;
+	bool failed;
+} tTestSharedReader;
+
+// Maximum number of rows of the ingestion tests
+#define TEST_SHARED_ROWS 64
+
+// Rows added by an ingestion thread and its duplicated rows
+typedef struct _tTestSharedIngest {
+	tIngest *ingest;
+	tCSVEntry *entries;
+	int count;
+	int duplicated;
+	bool failed;
+} tTestSharedIngest;
+
+// Add every row, as one of many threads doing the same
+static int test_shared_ingest(void *arg) {
+	tTestSharedIngest *test = (tTestSharedIngest *) arg;
+	tApiError error;
+
+	for (int row = 0; row < test->count; row++) {
+		error = ingest_addEntry(test->ingest, row, test->entries[row]);
+		if (error == E_PERSON_DUPLICATED || error == E_SUBSCRIPTION_DUPLICATED || error == E_FILM_DUPLICATED) {
+			test->duplicated++;
+		} else if (error != E_SUCCESS) {
+			test->failed = true;
+		}
+	}
+
+	return 0;
+}
+
+// Read the rows of a file as csv entries. Return the number of rows
+static int test_shared_readRows(const char *input, tCSVEntry *entries) {
+	char buffer[FILE_READ_BUFFER_SIZE];
+	int count = 0;
+	FILE *fin = fopen(input, "r");
+
+	if (fin == NULL) {
+		return 0;
+	}
+	while (count < TEST_SHARED_ROWS && fgets(buffer, FILE_READ_BUFFER_SIZE, fin)) {
+		buffer[strcspn(buffer, "\n\r")] = '\0';
+		csv_initEntry(&entries[count]);
+		csv_parseEntry(&entries[count], buffer, NULL);
+		count++;
+	}
+	fclose(fin);
+
+	return count;
+}
+
+// Heap allocator counting its calls, from any thread
+static void *test_shared_alloc(void *context, size_t size) {
+	atomic_fetch_add((atomic_int *) context, 1);
+	return malloc(size);
+}
+
+static void *test_shared_realloc(void *context, void *ptr, size_t size) {
+	atomic_fetch_add((atomic_int *) context, 1);
+	return realloc(ptr, size);
+}
+
+static void test_shared_free(void *context, void *ptr) {
+	atomic_fetch_add((atomic_int *) context, 1);
+	free(ptr);
+}
+
+// Allocator counting the blocks not freed yet
+static void *test_shared_liveAlloc(void *context, size_t size) {
+	void *ptr = malloc(size);
+	if (ptr != NULL) {
+		atomic_fetch_add((atomic_int *) context, 1);
+	}
+	return ptr;
+}
+
+static void *test_shared_liveRealloc(void *context, void *ptr, size_t size) {
+	(void) context;
+	return realloc(ptr, size);
+}
+
+static void test_shared_liveFree(void *context, void *ptr) {
+	atomic_fetch_sub((atomic_int *) context, 1);
+	free(ptr);
+}
+
+// Add a new film to a version of the data
+static tApiError test_shared_addFilm(tApiData *data, int number) {
+	tCSVEntry entry;
+	tApiError error;
+	char buffer[FILE_READ_BUFFER_SIZE];
+
+	snprintf(buffer, sizeof(buffer), "Shared film %d;01:30;%d;01/01/2020;4.0;1", number, number % GENRE_END);
+	csv_initEntry(&entry);
+	csv_parseEntry(&entry, buffer, "FILM");
+	error = api_addFilm(data, entry);
+	csv_freeEntry(&entry);
+
+	return error;
+}
+
+// Check that a snapshot is consistent: its last added film is there and the lists agree with the counters
+static bool test_shared_check(const tApiData *data) {
+	char name[FILE_READ_BUFFER_SIZE];
+	int count = 0;
+	int added = api_filmsCount(*data) - 15;
+
+	for (tFilmListNode *node = data->catalog.filmList.first; node != NULL; node = node->next) {
+		count++;
+	}
+	if (count != api_filmsCount(*data) || added < 0) {
+		return false;
+	}
+	if (added > 0) {
+		snprintf(name, sizeof(name), "Shared film %d", added - 1);
+		if (catalog_find(&data->catalog, name) == FILM_HANDLE_NONE) {
+			return false;
+		}
+	}
+
+	return api_peopleCount(*data) == 5 && api_subscriptionsCount(*data) == 5;
+}
+
+// Read snapshots until the writer is done
+static int test_shared_read(void *arg) {
+	tTestSharedReader *test = (tTestSharedReader *) arg;
+	tSharedReader reader;
+	const tApiData *data;
+	int last = 0;
+
+	sharedData_register(test->shared, &reader);
+	while (!atomic_load(test->done)) {
+		data = sharedData_readLock(test->shared, &reader);
+		// Versions are never seen going backwards
+		if (!test_shared_check(data) || api_filmsCount(*data) < last) {
+			test->failed = true;
+		}
+		last = api_filmsCount(*data);
+		sharedData_readUnlock(&reader);
+	}
+	sharedData_unregister(test->shared, &reader);
+
+	return 0;
+}
+
+// Result received by the callback of a background load
+typedef struct _tTestSharedAsync {
+	int calls;
+	tApiError error;
+} tTestSharedAsync;
+
+// Store the result of a background load
+static void test_shared_loaded(tApiLoadTask *task, tApiError error, void *context) {
+	tTestSharedAsync *result = (tTestSharedAsync *) context;
+
+	(void) task;
+	result->calls++;
+	result->error = error;
+}
+
+// Number of indexes of the parallel for tests
+#define TEST_SHARED_INDEXES 100000
+
+// Count each visit of the indexes in the range
+static void test_shared_visit(void *arg, int begin, int end) {
+	atomic_int *visits = (atomic_int *) arg;
+
+	for (int i = begin; i < end; i++) {
+		atomic_fetch_add(&visits[i], 1);
+	}
+}
+
+// Sum of the numbers of a range, computed by nested task groups
+typedef struct _tTestSharedSum {
+	tThreadPool *pool;
+	long long sum;
+} tTestSharedSum;
+
+// Add the numbers of the range, splitting it into two tasks while it is big
+static void test_shared_sum(void *arg, int begin, int end) {
+	tTestSharedSum *result = (tTestSharedSum *) arg;
+	tTestSharedSum halves[2] = {{result->pool, 0}, {result->pool, 0}};
+	tTaskGroup group;
+
+	if (end - begin <= 64) {
+		for (int i = begin; i < end; i++) {
+			result->sum += i;
+		}
+		return;
+	}
+	taskGroup_init(&group, result->pool);
+	taskGroup_run(&group, test_shared_sum, &halves[0], begin, begin + (end - begin) / 2);
+	taskGroup_run(&group, test_shared_sum, &halves[1], begin + (end - begin) / 2, end);
+	taskGroup_wait(&group);
+	result->sum += halves[0].sum + halves[1].sum;
+}
+
+// Run all tests for the shared data
+bool run_shared(tTestSuite *test_suite, const char *input) {
+	bool ok = true;
+	tTestSection* section = NULL;
+
+	assert(test_suite != NULL);
+
+	testSuite_addSection(test_suite, "SHR", "Tests for shared data");
+
+	section = testSuite_getSection(test_suite, "SHR");
+	assert(section != NULL);
+
+	ok = run_shared_snapshot(section, input);
+	ok = run_shared_threads(section, input) && ok;
+	ok = run_shared_ingest(section, input) && ok;
+	ok = run_shared_load(section, input) && ok;
+	ok = run_shared_stream(section, input) && ok;
+	ok = run_shared_async(section, input) && ok;
+	ok = run_shared_reload(section, input) && ok;
+	ok = run_shared_pool(section, input) && ok;
+
+	return ok;
+}
+
+// Run tests for the snapshots of the shared data
+bool run_shared_snapshot(tTestSection *test_section, const char *input) {
+	tSharedData shared;
+	tSharedReader reader;
+	tApiData *copy;
+	const tApiData *snapshot;
+	tApiError error;
+	bool passed = true;
+	bool failed = false;
+	bool fail_all = false;
+	bool ready;
+
+	// Initialize the data
+	error = sharedData_init(&shared, NULL, NULL);
+	ready = error == E_SUCCESS;
+	if (error == E_SUCCESS) {
+		error = sharedData_beginWrite(&shared, &copy);
+		if (error == E_SUCCESS) {
+			error = api_loadData(copy, input, true);
+			sharedData_commit(&shared, copy);
+		}
+	}
+	if (error != E_SUCCESS) {
+		passed = false;
+		fail_all = true;
+	}
+
+	/////////////////////////////
+	/////  SHR SNAPSHOT TEST 1 //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "SHR_SNAPSHOT_1", "Readers keep their snapshot while a writer publishes");
+	if (fail_all) {
+		failed = true;
+	} else {
+		sharedData_register(&shared, &reader);
+		snapshot = sharedData_readLock(&shared, &reader);
+
+		error = sharedData_beginWrite(&shared, &copy);
+		if (error != E_SUCCESS || test_shared_addFilm(copy, 0) != E_SUCCESS) {
+			failed = true;
+		} else {
+			sharedData_commit(&shared, copy);
+		}
+		// The old version is still readable and retired until the reader leaves
+		if (failed || api_filmsCount(*snapshot) != 15 || !test_shared_check(snapshot)
+			|| sharedData_reclaim(&shared) != 1) {
+			failed = true;
+		}
+		sharedData_readUnlock(&reader);
+		if (sharedData_reclaim(&shared) != 0) {
+			failed = true;
+		}
+
+		snapshot = sharedData_readLock(&shared, &reader);
+		if (api_filmsCount(*snapshot) != 16 || !test_shared_check(snapshot)) {
+			failed = true;
+		}
+		sharedData_readUnlock(&reader);
+		sharedData_unregister(&shared, &reader);
+		passed = passed && !failed;
+	}
+	end_test(test_section, "SHR_SNAPSHOT_1", !failed);
+
+	/////////////////////////////
+	/////  SHR SNAPSHOT TEST 2 //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "SHR_SNAPSHOT_2", "Aborted writes do not publish a version");
+	if (fail_all) {
+		failed = true;
+	} else {
+		error = sharedData_beginWrite(&shared, &copy);
+		if (error != E_SUCCESS || test_shared_addFilm(copy, 1) != E_SUCCESS) {
+			failed = true;
+		}
+		if (error == E_SUCCESS) {
+			sharedData_abort(&shared, copy);
+		}
+		sharedData_register(&shared, &reader);
+		snapshot = sharedData_readLock(&shared, &reader);
+		if (api_filmsCount(*snapshot) != 16) {
+			failed = true;
+		}
+		sharedData_readUnlock(&reader);
+		sharedData_unregister(&shared, &reader);
+		passed = passed && !failed;
+	}
+	end_test(test_section, "SHR_SNAPSHOT_2", !failed);
+
+	/////////////////////////////
+	/////  SHR SNAPSHOT TEST 3 //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "SHR_SNAPSHOT_3", "A batch of rows is published as one version");
+	if (fail_all) {
+		failed = true;
+	} else {
+		tCSVData batch;
+		char buffer[FILE_READ_BUFFER_SIZE];
+
+		csv_init(&batch);
+		for (int i = 1; i <= 3; i++) {
+			snprintf(buffer, sizeof(buffer), "Shared film %d;01:30;%d;01/01/2020;4.0;1", i, i % GENRE_END);
+			csv_addStrEntry(&batch, buffer, "FILM");
+		}
+		sharedData_register(&shared, &reader);
+		snapshot = sharedData_readLock(&shared, &reader);
+		if (sharedData_writeBatch(&shared, batch) != E_SUCCESS || sharedData_reclaim(&shared) != 1
+			|| api_filmsCount(*snapshot) != 16) {
+			failed = true;
+		}
+		sharedData_readUnlock(&reader);
+
+		snapshot = sharedData_readLock(&shared, &reader);
+		if (api_filmsCount(*snapshot) != 19 || !test_shared_check(snapshot)) {
+			failed = true;
+		}
+		sharedData_readUnlock(&reader);
+		sharedData_unregister(&shared, &reader);
+		csv_free(&batch);
+		passed = passed && !failed;
+	}
+	end_test(test_section, "SHR_SNAPSHOT_3", !failed);
+
+	// Release all data, even if the load failed
+	if (ready) {
+		sharedData_free(&shared);
+	}
+
+	return passed;
+}
+
+// Run tests for readers and writers running at the same time
+bool run_shared_threads(tTestSection *test_section, const char *input) {
+	tSharedData shared;
+	tTestSharedReader readers[TEST_SHARED_READERS];
+	thrd_t threads[TEST_SHARED_READERS];
+	atomic_bool done;
+	tApiData *copy;
+	tApiError error;
+	int started = 0;
+	bool passed = true;
+	bool failed = false;
+	bool fail_all = false;
+	bool ready;
+
+	// Initialize the data
+	error = sharedData_init(&shared, NULL, NULL);
+	ready = error == E_SUCCESS;
+	if (error == E_SUCCESS) {
+		error = sharedData_beginWrite(&shared, &copy);
+		if (error == E_SUCCESS) {
+			error = api_loadData(copy, input, true);
+			sharedData_commit(&shared, copy);
+		}
+	}
+	if (error != E_SUCCESS) {
+		passed = false;
+		fail_all = true;
+	}
+
+	/////////////////////////////
+	/////  SHR THREADS TEST 1  //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "SHR_THREADS_1", "Readers see consistent versions while a writer publishes");
+	if (fail_all) {
+		failed = true;
+	} else {
+		atomic_init(&done, false);
+		for (int i = 0; i < TEST_SHARED_READERS; i++) {
+			readers[i].shared = &shared;
+			readers[i].done = &done;
+			readers[i].failed = false;
+			if (thrd_create(&threads[i], test_shared_read, &readers[i]) == thrd_success) {
+				started++;
+			}
+		}
+		for (int i = 0; i < TEST_SHARED_WRITES && !failed; i++) {
+			error = sharedData_beginWrite(&shared, &copy);
+			if (error != E_SUCCESS || test_shared_addFilm(copy, i) != E_SUCCESS) {
+				failed = true;
+			}
+			if (error == E_SUCCESS) {
+				sharedData_commit(&shared, copy);
+			}
+		}
+		atomic_store(&done, true);
+		for (int i = 0; i < started; i++) {
+			thrd_join(threads[i], NULL);
+			if (readers[i].failed) {
+				failed = true;
+			}
+		}
+		// Every retired version can be reclaimed once the readers are gone
+		if (started != TEST_SHARED_READERS || sharedData_reclaim(&shared) != 0) {
+			failed = true;
+		}
+		passed = passed && !failed;
+	}
+	end_test(test_section, "SHR_THREADS_1", !failed);
+
+	// Release all data, even if the load failed
+	if (ready) {
+		sharedData_free(&shared);
+	}
+
+	return passed;
+}
+
+// Run tests for the sharded ingestion from many threads
+bool run_shared_ingest(tTestSection *test_section, const char *input) {
+	tApiData data;
+	tApiData refData;
+	tIngest ingest;
+	tCSVEntry entries[TEST_SHARED_ROWS];
+	tTestSharedIngest threadsData[TEST_SHARED_READERS];
+	thrd_t threads[TEST_SHARED_READERS];
+	tCSVData report;
+	tCSVData refReport;
+	tApiError error;
+	int count;
+	int started = 0;
+	int duplicated = 0;
+	bool passed = true;
+	bool failed = false;
+	bool fail_all = false;
+
+	// Initialize the data
+	count = test_shared_readRows(input, entries);
+	error = api_initData(&data, NULL);
+	if (error == E_SUCCESS) {
+		error = api_initData(&refData, NULL);
+	}
+	if (error == E_SUCCESS) {
+		error = api_loadData(&refData, input, true);
+	}
+	if (error != E_SUCCESS || count != 25) {
+		passed = false;
+		fail_all = true;
+	}
+
+	/////////////////////////////
+	/////  SHR INGEST TEST 1   //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "SHR_INGEST_1", "Add the same rows from many threads");
+	if (fail_all) {
+		failed = true;
+	} else {
+		error = ingest_init(&ingest, &data);
+		for (int i = 0; i < TEST_SHARED_READERS && error == E_SUCCESS; i++) {
+			threadsData[i].ingest = &ingest;
+			threadsData[i].entries = entries;
+			threadsData[i].count = count;
+			threadsData[i].duplicated = 0;
+			threadsData[i].failed = false;
+			if (thrd_create(&threads[i], test_shared_ingest, &threadsData[i]) == thrd_success) {
+				started++;
+			}
+		}
+		for (int i = 0; i < started; i++) {
+			thrd_join(threads[i], NULL);
+			duplicated += threadsData[i].duplicated;
+			if (threadsData[i].failed) {
+				failed = true;
+			}
+		}
+		// Each row is added once and found duplicated by every other thread
+		if (error != E_SUCCESS || started != TEST_SHARED_READERS || duplicated != (TEST_SHARED_READERS - 1) * count) {
+			failed = true;
+		}
+		if (error == E_SUCCESS && ingest_finish(&ingest) != E_SUCCESS) {
+			failed = true;
+		}
+		if (api_peopleCount(data) != 5 || api_subscriptionsCount(data) != 5 || api_filmsCount(data) != 15) {
+			failed = true;
+		}
+		// Records keep the order of the rows
+		api_getFreeFilms(data, &report);
+		api_getFreeFilms(refData, &refReport);
+		if (!csv_equals(report, refReport)) {
+			failed = true;
+		}
+		csv_free(&report);
+		csv_free(&refReport);
+		for (int i = 0; i < 5 && !failed; i++) {
+			if (strcmp(data.people.elems[i].document, refData.people.elems[i].document) != 0
+				|| data.subscriptions.elems[i].id != refData.subscriptions.elems[i].id) {
+				failed = true;
+			}
+		}
+		passed = passed && !failed;
+	}
+	end_test(test_section, "SHR_INGEST_1", !failed);
+
+	/////////////////////////////
+	/////  SHR INGEST TEST 2   //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "SHR_INGEST_2", "Rows already in the data are duplicated");
+	if (fail_all) {
+		failed = true;
+	} else {
+		error = ingest_init(&ingest, &data);
+		for (int row = 0; row < count && error == E_SUCCESS; row++) {
+			tApiError rowError = ingest_addEntry(&ingest, row, entries[row]);
+			if (rowError != E_PERSON_DUPLICATED && rowError != E_SUBSCRIPTION_DUPLICATED && rowError != E_FILM_DUPLICATED) {
+				failed = true;
+			}
+		}
+		if (error != E_SUCCESS || ingest_finish(&ingest) != E_SUCCESS
+			|| api_peopleCount(data) != 5 || api_subscriptionsCount(data) != 5 || api_filmsCount(data) != 15) {
+			failed = true;
+		}
+		passed = passed && !failed;
+	}
+	end_test(test_section, "SHR_INGEST_2", !failed);
+
+	// Release all data
+	for (int i = 0; i < count; i++) {
+		csv_freeEntry(&entries[i]);
+	}
+	api_freeData(&data);
+	api_freeData(&refData);
+
+	return passed;
+}
+
+// Run tests for the parallel load of a file
+bool run_shared_load(tTestSection *test_section, const char *input) {
+	const char *filename = "test_data_shared_load.csv";
+	tApiData data;
+	tApiData refData;
+	tApiLoadReport report;
+	tCSVData films;
+	tCSVData refFilms;
+	tApiError error;
+	bool passed = true;
+	bool failed = false;
+	bool fail_all = false;
+
+	// Initialize the data
+	error = api_initData(&data, NULL);
+	if (error == E_SUCCESS) {
+		error = api_initData(&refData, NULL);
+	}
+	if (error == E_SUCCESS) {
+		error = api_loadData(&refData, input, true);
+	}
+	if (error != E_SUCCESS) {
+		passed = false;
+		fail_all = true;
+	}
+
+	/////////////////////////////
+	/////  SHR LOAD TEST 1     //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "SHR_LOAD_1", "Load a file with many threads");
+	if (fail_all) {
+		failed = true;
+	} else {
+		apiLoadReport_init(&report, data.allocator);
+		error = api_loadDataParallel(&data, input, true, 4, &report);
+		if (error != E_SUCCESS || report.count != 0 || api_peopleCount(data) != 5
+			|| api_subscriptionsCount(data) != 5 || api_filmsCount(data) != 15) {
+			failed = true;
+		} else {
+			api_getFreeFilms(data, &films);
+			api_getFreeFilms(refData, &refFilms);
+			if (!csv_equals(films, refFilms)) {
+				failed = true;
+			}
+			csv_free(&films);
+			csv_free(&refFilms);
+		}
+		apiLoadReport_free(&report);
+		passed = passed && !failed;
+	}
+	end_test(test_section, "SHR_LOAD_1", !failed);
+
+	/////////////////////////////
+	/////  SHR LOAD TEST 2     //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "SHR_LOAD_2", "Rejected rows are reported in row order");
+	if (fail_all) {
+		failed = true;
+	} else {
+		save_data(filename, "SUBSCRIPTION;6;11111111A;01/01/2025;31/12/2025;Free;0;1\n"
+			"PERSON;11111111A;Ada;Lovelace;600600600;ada@example.com;Street, 1;08001;10/12/1815\n"
+			"PERSON;11111111A;Ada;Byron;600600600;ada@example.com;Street, 1;08001;10/12/1815\n"
+			"SUBSCRIPTION;6;11111111A;01/01/2025;31/12/2025;Standard;29.95;3\n"
+			"FILM;Interstellar;02:49;4;07/11/2014;4.8;0\n"
+			"FILM;Metropolis;02:33;4;10/01/1927;4.6;1\n"
+			"SUBSCRIPTION;6;11111111A;01/01/2025;31/12/2025;Premium;29.95;3\n"
+			"FILM;Metropolis;02:33;4;10/01/1927;4.6;1\n");
+		apiLoadReport_init(&report, data.allocator);
+		// Added to the data of the previous test
+		error = api_loadDataParallel(&data, filename, false, 3, &report);
+		if (error != E_SUCCESS || report.count != 5
+			|| report.errors[0].row != 0 || report.errors[0].error != E_PERSON_NOT_FOUND
+			|| report.errors[1].row != 2 || report.errors[1].error != E_PERSON_DUPLICATED
+			|| report.errors[2].row != 4 || report.errors[2].error != E_FILM_DUPLICATED
+			|| report.errors[3].row != 6 || report.errors[3].error != E_SUBSCRIPTION_DUPLICATED
+			|| report.errors[4].row != 7 || report.errors[4].error != E_FILM_DUPLICATED) {
+			failed = true;
+		}
+		// The first of the duplicated rows is kept
+		if (api_peopleCount(data) != 6 || strcmp(data.people.elems[5].surname, "Lovelace") != 0
+			|| api_subscriptionsCount(data) != 6 || strcmp(data.subscriptions.elems[5].plan, "Standard") != 0
+			|| api_filmsCount(data) != 16) {
+			failed = true;
+		}
+		apiLoadReport_free(&report);
+		passed = passed && !failed;
+	}
+	end_test(test_section, "SHR_LOAD_2", !failed);
+
+	// Release all data
+	api_freeData(&data);
+	api_freeData(&refData);
+
+	return passed;
+}
+
+// Run tests for the load of a file descriptor read ahead by a thread
+bool run_shared_stream(tTestSection *test_section, const char *input) {
+	const char *filename = "test_data_shared_stream.csv";
+	tApiData data;
+	tApiData refData;
+	tCSVData films;
+	tCSVData refFilms;
+	tApiError error;
+	FILE *fin;
+	bool passed = true;
+	bool failed = false;
+	bool fail_all = false;
+
+	// Initialize the data
+	error = api_initData(&data, NULL);
+	if (error == E_SUCCESS) {
+		error = api_initData(&refData, NULL);
+	}
+	if (error == E_SUCCESS) {
+		error = api_loadData(&refData, input, true);
+	}
+	if (error != E_SUCCESS) {
+		passed = false;
+		fail_all = true;
+	}
+
+	/////////////////////////////
+	/////  SHR STREAM TEST 1   //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "SHR_STREAM_1", "Load a file descriptor");
+	fin = fopen(input, "r");
+	if (fail_all || fin == NULL) {
+		failed = true;
+	} else {
+		error = api_loadStream(&data, test_fileno(fin), true);
+		fclose(fin);
+		if (error != E_SUCCESS || api_peopleCount(data) != 5
+			|| api_subscriptionsCount(data) != 5 || api_filmsCount(data) != 15) {
+			failed = true;
+		} else {
+			api_getFreeFilms(data, &films);
+			api_getFreeFilms(refData, &refFilms);
+			if (!csv_equals(films, refFilms)) {
+				failed = true;
+			}
+			csv_free(&films);
+			csv_free(&refFilms);
+		}
+		passed = passed && !failed;
+	}
+	end_test(test_section, "SHR_STREAM_1", !failed);
+
+	/////////////////////////////
+	/////  SHR STREAM TEST 2   //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "SHR_STREAM_2", "Carriage returns, empty lines and no final new line");
+	save_data(filename, "PERSON;22222222B;Alan;Turing;600600601;alan@example.com;Street, 2;08002;23/06/1912\r\n"
+		"\r\n"
+		"\n"
+		"FILM;Metropolis;02:33;4;10/01/1927;4.6;1\r\n"
+		"SUBSCRIPTION;7;22222222B;01/01/2025;31/12/2025;Free;0;1");
+	fin = fopen(filename, "rb");
+	if (fail_all || fin == NULL) {
+		failed = true;
+	} else {
+		// Added to the data of the previous test
+		error = api_loadStream(&data, test_fileno(fin), false);
+		fclose(fin);
+		if (error != E_SUCCESS || api_peopleCount(data) != 6 || strcmp(data.people.elems[5].email, "alan@example.com") != 0
+			|| api_subscriptionsCount(data) != 6 || data.subscriptions.elems[5].numDevices != 1
+			|| api_filmsCount(data) != 16) {
+			failed = true;
+		}
+		passed = passed && !failed;
+	}
+	end_test(test_section, "SHR_STREAM_2", !failed);
+
+#ifndef _WIN32
+	/////////////////////////////
+	/////  SHR STREAM TEST 3   //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "SHR_STREAM_3", "Close a stream whose pipe writer sends nothing");
+	{
+		tLineStream stream;
+		int fds[2];
+		if (pipe(fds) != 0) {
+			failed = true;
+		} else {
+			// The writer end stays open, so the reader would block forever in a read
+			if (lineStream_open(&stream, fds[0], NULL) != E_SUCCESS || lineStream_close(&stream) != E_SUCCESS) {
+				failed = true;
+			}
+			close(fds[0]);
+			close(fds[1]);
+		}
+		passed = passed && !failed;
+	}
+	end_test(test_section, "SHR_STREAM_3", !failed);
+#endif
+
+	// Release all data
+	api_freeData(&data);
+	api_freeData(&refData);
+
+	return passed;
+}
+
+// Run tests for the loads running in the background
+bool run_shared_async(tTestSection *test_section, const char *input) {
+	tApiData refData;
+	tApiData *loaded = NULL;
+	tApiLoadTask *task = NULL;
+	tApiLoadProgress progress;
+	tTestSharedAsync result;
+	tCSVData films;
+	tCSVData refFilms;
+	tApiError error;
+	bool passed = true;
+	bool failed = false;
+	bool fail_all = false;
+
+	// Initialize the data
+	error = api_initData(&refData, NULL);
+	if (error == E_SUCCESS) {
+		error = api_loadData(&refData, input, true);
+	}
+	if (error != E_SUCCESS) {
+		passed = false;
+		fail_all = true;
+	}
+
+	/////////////////////////////
+	/////  SHR ASYNC TEST 1    //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "SHR_ASYNC_1", "Load a file in the background");
+	if (fail_all) {
+		failed = true;
+	} else {
+		result.calls = 0;
+		result.error = E_NOT_IMPLEMENTED;
+		error = api_loadDataAsync(&task, NULL, input, test_shared_loaded, &result);
+		if (error != E_SUCCESS) {
+			failed = true;
+		} else {
+			error = apiLoadTask_wait(task, &loaded);
+			apiLoadTask_progress(task, &progress);
+			if (error != E_SUCCESS || result.calls != 1 || result.error != E_SUCCESS || !apiLoadTask_done(task)
+				|| progress.rowsApplied != 25 || progress.rowsRejected != 0
+				|| progress.bytesRead != progress.totalBytes || progress.eta != 0) {
+				failed = true;
+			}
+			if (loaded == NULL || api_peopleCount(*loaded) != 5
+				|| api_subscriptionsCount(*loaded) != 5 || api_filmsCount(*loaded) != 15) {
+				failed = true;
+			} else {
+				api_getFreeFilms(*loaded, &films);
+				api_getFreeFilms(refData, &refFilms);
+				if (!csv_equals(films, refFilms)) {
+					failed = true;
+				}
+				csv_free(&films);
+				csv_free(&refFilms);
+			}
+			apiLoadTask_free(task);
+		}
+		passed = passed && !failed;
+	}
+	end_test(test_section, "SHR_ASYNC_1", !failed);
+
+	/////////////////////////////
+	/////  SHR ASYNC TEST 2    //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "SHR_ASYNC_2", "Rows of the base data are rejected and the base is not changed");
+	if (fail_all || loaded == NULL) {
+		failed = true;
+	} else {
+		tApiData *extended = NULL;
+		error = api_loadDataAsync(&task, loaded, input, NULL, NULL);
+		if (error != E_SUCCESS) {
+			failed = true;
+		} else {
+			// The base can still be read while the load runs
+			if (api_filmsCount(*loaded) != 15) {
+				failed = true;
+			}
+			error = apiLoadTask_wait(task, &extended);
+			apiLoadTask_progress(task, &progress);
+			if (error != E_SUCCESS || extended == NULL || extended == loaded
+				|| progress.rowsApplied != 0 || progress.rowsRejected != 25
+				|| api_peopleCount(*extended) != 5 || api_filmsCount(*extended) != 15) {
+				failed = true;
+			}
+			apiLoadTask_free(task);
+		}
+		if (extended != NULL) {
+			api_freeData(extended);
+			allocator_free(extended->allocator, extended);
+		}
+		passed = passed && !failed;
+	}
+	end_test(test_section, "SHR_ASYNC_2", !failed);
+
+	/////////////////////////////
+	/////  SHR ASYNC TEST 3    //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "SHR_ASYNC_3", "A background load takes its memory from the allocator of the base");
+	if (fail_all) {
+		failed = true;
+	} else {
+		atomic_int live;
+		tAllocator allocator = {test_shared_liveAlloc, test_shared_liveRealloc, test_shared_liveFree, &live};
+		tApiData base;
+		tApiData *counted = NULL;
+
+		atomic_init(&live, 0);
+		api_initData(&base, &allocator);
+		error = api_loadDataAsync(&task, &base, input, NULL, NULL);
+		if (error != E_SUCCESS) {
+			failed = true;
+		} else {
+			error = apiLoadTask_wait(task, &counted);
+			if (error != E_SUCCESS || counted == NULL || counted->allocator != &allocator
+				|| api_filmsCount(*counted) != 15) {
+				failed = true;
+			}
+			apiLoadTask_free(task);
+		}
+		if (counted != NULL) {
+			api_freeData(counted);
+			allocator_free(counted->allocator, counted);
+		}
+		api_freeData(&base);
+		// The task, the data and the read blocks were given back to the same allocator
+		if (atomic_load(&live) != 0) {
+			failed = true;
+		}
+		passed = passed && !failed;
+	}
+	end_test(test_section, "SHR_ASYNC_3", !failed);
+
+	// Release all data
+	if (loaded != NULL) {
+		api_freeData(loaded);
+		allocator_free(loaded->allocator, loaded);
+	}
+	api_freeData(&refData);
+
+	return passed;
+}
+
+// Run tests for the reload of the shared data while it is read
+bool run_shared_reload(tTestSection *test_section, const char *input) {
+	tSharedData shared;
+	tSharedReader reader;
+	tTestSharedReader readers[TEST_SHARED_READERS];
+	thrd_t threads[TEST_SHARED_READERS];
+	atomic_bool done;
+	tApiLoadTask *task = NULL;
+	tThreadPool pool;
+	atomic_int calls;
+	tAllocator allocator = {test_shared_alloc, test_shared_realloc, test_shared_free, &calls};
+	const tApiData *data;
+	tApiError error;
+	int started = 0;
+	bool passed = true;
+	bool failed = false;
+	bool fail_all = false;
+	bool ready = false;
+	bool poolStarted;
+
+	// Initialize the data, whose versions use a thread pool and an allocator
+	atomic_init(&calls, 0);
+	error = threadPool_init(&pool, 4);
+	poolStarted = error == E_SUCCESS;
+	if (error == E_SUCCESS) {
+		error = sharedData_init(&shared, &allocator, &pool);
+		ready = error == E_SUCCESS;
+	}
+	if (error == E_SUCCESS) {
+		error = sharedData_reload(&shared, input);
+	}
+	if (error != E_SUCCESS) {
+		passed = false;
+		fail_all = true;
+	}
+
+	/////////////////////////////
+	/////  SHR RELOAD TEST 1   //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "SHR_RELOAD_1", "Readers see a whole version while the data is reloaded");
+	if (fail_all) {
+		failed = true;
+	} else {
+		atomic_init(&done, false);
+		for (int i = 0; i < TEST_SHARED_READERS; i++) {
+			readers[i].shared = &shared;
+			readers[i].done = &done;
+			readers[i].failed = false;
+			if (thrd_create(&threads[i], test_shared_read, &readers[i]) == thrd_success) {
+				started++;
+			}
+		}
+		sharedData_register(&shared, &reader);
+		data = sharedData_readLock(&shared, &reader);
+		error = sharedData_reloadAsync(&shared, &task, input);
+		// The previous version is still served until the reader is done
+		if (error != E_SUCCESS || api_filmsCount(*data) != 15) {
+			failed = true;
+		}
+		sharedData_readUnlock(&reader);
+		if (error == E_SUCCESS && apiLoadTask_wait(task, NULL) != E_SUCCESS) {
+			failed = true;
+		}
+		apiLoadTask_free(task);
+		atomic_store(&done, true);
+		for (int i = 0; i < started; i++) {
+			thrd_join(threads[i], NULL);
+			if (readers[i].failed) {
+				failed = true;
+			}
+		}
+		data = sharedData_readLock(&shared, &reader);
+		if (started != TEST_SHARED_READERS || data == NULL || !test_shared_check(data) || api_filmsCount(*data) != 15) {
+			failed = true;
+		}
+		sharedData_readUnlock(&reader);
+		sharedData_unregister(&shared, &reader);
+		// The previous version is freed by the first reclaim after its readers are done
+		if (sharedData_reclaim(&shared) != 0) {
+			failed = true;
+		}
+		passed = passed && !failed;
+	}
+	end_test(test_section, "SHR_RELOAD_1", !failed);
+
+	/////////////////////////////
+	/////  SHR RELOAD TEST 2   //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "SHR_RELOAD_2", "A failed reload keeps the current version");
+	if (fail_all) {
+		failed = true;
+	} else {
+		const tApiData *previous = atomic_load(&shared.current);
+		if (sharedData_reload(&shared, "missing_file.csv") != E_FILE_NOT_FOUND
+			|| sharedData_reloadAsync(&shared, &task, "missing_file.csv") != E_FILE_NOT_FOUND
+			|| atomic_load(&shared.current) != previous) {
+			failed = true;
+		}
+		passed = passed && !failed;
+	}
+	end_test(test_section, "SHR_RELOAD_2", !failed);
+
+	/////////////////////////////
+	/////  SHR RELOAD TEST 3   //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "SHR_RELOAD_3", "Reloaded versions keep the allocator and thread pool");
+	if (fail_all) {
+		failed = true;
+	} else {
+		// The current version comes from the background load of the first test
+		sharedData_register(&shared, &reader);
+		data = sharedData_readLock(&shared, &reader);
+		if (data->allocator != &allocator || data->pool != &pool) {
+			failed = true;
+		}
+		sharedData_readUnlock(&reader);
+
+		atomic_store(&calls, 0);
+		if (sharedData_reload(&shared, input) != E_SUCCESS || atomic_load(&calls) == 0) {
+			failed = true;
+		}
+		data = sharedData_readLock(&shared, &reader);
+		if (data->allocator != &allocator || data->pool != &pool || !test_shared_check(data)
+			|| api_filmsCount(*data) != 15) {
+			failed = true;
+		}
+		sharedData_readUnlock(&reader);
+		sharedData_unregister(&shared, &reader);
+		passed = passed && !failed;
+	}
+	end_test(test_section, "SHR_RELOAD_3", !failed);
+
+	// Release all data, even if the load failed
+	if (ready) {
+		sharedData_free(&shared);
+	}
+	if (poolStarted) {
+		threadPool_free(&pool);
+	}
+
+	return passed;
+}
+
+// Run tests for the thread pool
+bool run_shared_pool(tTestSection *test_section, const char *input) {
+	tThreadPool pool;
+	tApiData data;
+	tApiData refData;
+	tCSVData films;
+	tCSVData refFilms;
+	tApiError error;
+	bool passed = true;
+	bool failed = false;
+	bool fail_all = false;
+	bool poolStarted = false;
+
+	// Initialize the data
+	error = api_initData(&data, NULL);
+	if (error == E_SUCCESS) {
+		error = api_initData(&refData, NULL);
+	}
+	if (error == E_SUCCESS) {
+		error = threadPool_init(&pool, 4);
+		poolStarted = error == E_SUCCESS;
+	}
+	if (error == E_SUCCESS) {
+		error = api_loadData(&refData, input, true);
+	}
+	if (error != E_SUCCESS) {
+		passed = false;
+		fail_all = true;
+	}
+
+	/////////////////////////////
+	/////  SHR POOL TEST 1     //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "SHR_POOL_1", "Run a parallel for and nested task groups");
+	atomic_int *visits = (atomic_int *) malloc(TEST_SHARED_INDEXES * sizeof(atomic_int));
+	if (fail_all || visits == NULL) {
+		failed = true;
+	} else {
+		for (int i = 0; i < TEST_SHARED_INDEXES; i++) {
+			atomic_init(&visits[i], 0);
+		}
+		threadPool_parallelFor(&pool, 0, TEST_SHARED_INDEXES, 0, test_shared_visit, visits);
+		// Every index is visited exactly once
+		for (int i = 0; i < TEST_SHARED_INDEXES; i++) {
+			if (atomic_load(&visits[i]) != 1) {
+				failed = true;
+			}
+		}
+		tTestSharedSum result = {&pool, 0};
+		test_shared_sum(&result, 0, TEST_SHARED_INDEXES);
+		if (threadPool_threads(&pool) < 1 || result.sum != (long long) TEST_SHARED_INDEXES * (TEST_SHARED_INDEXES - 1) / 2) {
+			failed = true;
+		}
+		passed = passed && !failed;
+	}
+	free(visits);
+	end_test(test_section, "SHR_POOL_1", !failed);
+
+	/////////////////////////////
+	/////  SHR POOL TEST 2     //
+	/////////////////////////////
+	failed = false;
+	start_test(test_section, "SHR_POOL_2", "API functions use the thread pool of the data");
+	if (fail_all) {
+		failed = true;
+	} else {
+		api_setThreadPool(&data, &pool);
+		error = api_loadDataParallel(&data, input, true, 4, NULL);
+		// The pool is kept after a reset
+		if (error != E_SUCCESS || data.pool != &pool || api_filmsCount(data) != 15) {
+			failed = true;
+		} else {
+			api_getFreeFilms(data, &films);
+			api_getFreeFilms(refData, &refFilms);
+			if (!csv_equals(films, refFilms)) {
+				failed = true;
+			}
+			csv_free(&films);
+			csv_free(&refFilms);
+			api_getFilmsByGenre(data, &films, 1);
+			api_getFilmsByGenre(refData, &refFilms, 1);
+			if (!csv_equals(films, refFilms)) {
+				failed = true;
+			}
+			csv_free(&films);
+			csv_free(&refFilms);
+		}
+		passed = passed && !failed;
+	}
+	end_test(test_section, "SHR_POOL_2", !failed);
+
+	// Release all data, even if the load failed
+	api_freeData(&data);
+	api_freeData(&refData);
+	if (poolStarted) {
+		threadPool_free(&pool);
+	}
+
+	return passed;
+}